@@ -0,0 +1,288 @@
+/*
+  ==============================================================================
+
+    AudioInstrumentation.cpp
+    Created: 17 Oct 2026 10:37:52pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "AudioInstrumentation.h"
+
+namespace
+{
+    float ticksToMs(juce::int64 ticks)
+    {
+        return (float) (juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0);
+    }
+}
+
+const char* AudioInstrumentation::getStageName(Stage stage)
+{
+    switch (stage)
+    {
+        case sync:      return "sync";
+        case resample:  return "resample";
+        case eq:        return "eq";
+        case mix:       return "mix";
+        case numStages: break;
+    }
+
+    return "";
+}
+
+AudioInstrumentation::Stage AudioInstrumentation::Record::getSlowestStage() const
+{
+    int slowest = 0;
+
+    for (int i = 1; i < numStages; ++i)
+        if (stageMs[(size_t) i] > stageMs[(size_t) slowest])
+            slowest = i;
+
+    return (Stage) slowest;
+}
+
+AudioInstrumentation::AudioInstrumentation()
+{
+    history.reserve(historySize);
+    startTimerHz(10);
+}
+
+AudioInstrumentation::~AudioInstrumentation()
+{
+    stopTimer();
+}
+
+//==============================================================================
+void AudioInstrumentation::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    prepareTicks = juce::Time::getHighResolutionTicks();
+    lastStartTicks = 0;
+}
+
+void AudioInstrumentation::callbackStarted()
+{
+    startTicks = juce::Time::getHighResolutionTicks();
+
+    current = {};
+    current.startSeconds = juce::Time::highResolutionTicksToSeconds(startTicks - prepareTicks);
+    current.intervalMs = lastStartTicks != 0 ? ticksToMs(startTicks - lastStartTicks) : 0.0f;
+
+    lastStartTicks = startTicks;
+}
+
+void AudioInstrumentation::addStageTime(Stage stage, double seconds)
+{
+    current.stageMs[(size_t) stage] += (float) (seconds * 1000.0);
+}
+
+void AudioInstrumentation::callbackFinished(int numSamples)
+{
+    current.durationMs = ticksToMs(juce::Time::getHighResolutionTicks() - startTicks);
+    current.numSamples = numSamples;
+    current.budgetMs = (float) (numSamples * 1000.0 / sampleRate);
+
+    const auto scope = fifo.write(1);
+
+    if (scope.blockSize1 > 0)
+        fifoRecords[(size_t) scope.startIndex1] = current;
+    else
+        numDropped.fetch_add(1); // nobody's draining, better to lose a record than wait
+}
+
+//==============================================================================
+void AudioInstrumentation::timerCallback()
+{
+    const auto scope = fifo.read(fifo.getNumReady());
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        addToHistory(fifoRecords[(size_t) (scope.startIndex1 + i)]);
+
+    for (int i = 0; i < scope.blockSize2; ++i)
+        addToHistory(fifoRecords[(size_t) (scope.startIndex2 + i)]);
+}
+
+void AudioInstrumentation::addToHistory(const Record& record)
+{
+    if ((int) history.size() < historySize)
+    {
+        history.push_back(record);
+    }
+    else
+    {
+        history[(size_t) historyStart] = record;
+        historyStart = (historyStart + 1) % historySize;
+    }
+
+    ++summary.numCallbacks;
+    summary.lastLoad = record.getLoad();
+    summary.peakLoad = juce::jmax(summary.peakLoad, record.getLoad());
+    summary.maxDurationMs = juce::jmax(summary.maxDurationMs, record.durationMs);
+
+    XrunEvent event{ record, record.isOverrun(), false };
+
+    // the first callback after prepare has no interval to judge
+    if (record.intervalMs > 0.0f)
+    {
+        const float jitter = record.intervalMs - record.budgetMs;
+        const int bin = 1 + (int) std::floor((jitter + jitterRangeMs) / jitterBinMs);
+        ++jitterHistogram[(size_t) juce::jlimit(0, numJitterBins - 1, bin)];
+
+        event.late = record.isLate(record.budgetMs);
+    }
+
+    summary.numOverruns += event.overrun ? 1 : 0;
+    summary.numLate += event.late ? 1 : 0;
+
+    if (event.overrun || event.late)
+    {
+        if ((int) xrunLog.size() >= maxXrunEvents)
+            xrunLog.erase(xrunLog.begin());
+
+        xrunLog.push_back(event);
+    }
+}
+
+AudioInstrumentation::Summary AudioInstrumentation::getSummary() const
+{
+    auto result = summary;
+    result.numDropped = numDropped.load();
+
+    // average over the last second of callbacks
+    const auto recent = getHistory();
+    double totalLoad = 0.0;
+    int count = 0;
+
+    for (auto it = recent.rbegin(); it != recent.rend() && it->startSeconds > recent.back().startSeconds - 1.0; ++it)
+    {
+        totalLoad += it->getLoad();
+        ++count;
+    }
+
+    result.averageLoad = count > 0 ? (float) (totalLoad / count) : 0.0f;
+    return result;
+}
+
+const std::array<juce::int64, AudioInstrumentation::numJitterBins>& AudioInstrumentation::getJitterHistogram() const
+{
+    return jitterHistogram;
+}
+
+const std::vector<AudioInstrumentation::XrunEvent>& AudioInstrumentation::getXrunLog() const
+{
+    return xrunLog;
+}
+
+std::vector<AudioInstrumentation::Record> AudioInstrumentation::getHistory() const
+{
+    std::vector<Record> result;
+    result.reserve(history.size());
+
+    for (size_t i = 0; i < history.size(); ++i)
+        result.push_back(history[(historyStart + i) % history.size()]);
+
+    return result;
+}
+
+void AudioInstrumentation::reset()
+{
+    history.clear();
+    historyStart = 0;
+    summary = {};
+    jitterHistogram.fill(0);
+    xrunLog.clear();
+    numDropped.store(0);
+}
+
+//==============================================================================
+bool AudioInstrumentation::writeCsv(const juce::File& file) const
+{
+    juce::String csv = "start_s,interval_ms,duration_ms,budget_ms,load,samples";
+
+    for (int stage = 0; stage < numStages; ++stage)
+        csv << "," << getStageName((Stage) stage) << "_ms";
+
+    csv << ",overrun\n";
+
+    for (const auto& record : getHistory())
+    {
+        csv << juce::String(record.startSeconds, 6) << ","
+            << juce::String(record.intervalMs, 4) << ","
+            << juce::String(record.durationMs, 4) << ","
+            << juce::String(record.budgetMs, 4) << ","
+            << juce::String(record.getLoad(), 4) << ","
+            << record.numSamples;
+
+        for (auto stageMs : record.stageMs)
+            csv << "," << juce::String(stageMs, 4);
+
+        csv << "," << (record.isOverrun() ? 1 : 0) << "\n";
+    }
+
+    return file.replaceWithText(csv);
+}
+
+bool AudioInstrumentation::writeJson(const juce::File& file) const
+{
+    auto toVar = [](const Record& record)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("start_s", record.startSeconds);
+        object->setProperty("interval_ms", record.intervalMs);
+        object->setProperty("duration_ms", record.durationMs);
+        object->setProperty("budget_ms", record.budgetMs);
+        object->setProperty("load", record.getLoad());
+        object->setProperty("samples", record.numSamples);
+
+        auto* stages = new juce::DynamicObject();
+
+        for (int stage = 0; stage < numStages; ++stage)
+            stages->setProperty(getStageName((Stage) stage), record.stageMs[(size_t) stage]);
+
+        object->setProperty("stages_ms", juce::var(stages));
+        return juce::var(object);
+    };
+
+    const auto snapshot = getSummary();
+    auto* summaryObject = new juce::DynamicObject();
+    summaryObject->setProperty("callbacks", snapshot.numCallbacks);
+    summaryObject->setProperty("overruns", snapshot.numOverruns);
+    summaryObject->setProperty("late", snapshot.numLate);
+    summaryObject->setProperty("dropped", snapshot.numDropped);
+    summaryObject->setProperty("average_load", snapshot.averageLoad);
+    summaryObject->setProperty("peak_load", snapshot.peakLoad);
+    summaryObject->setProperty("max_duration_ms", snapshot.maxDurationMs);
+
+    juce::Array<juce::var> histogram;
+
+    for (auto count : jitterHistogram)
+        histogram.add(count);
+
+    juce::Array<juce::var> xruns;
+
+    for (const auto& event : xrunLog)
+    {
+        auto xrun = toVar(event.record);
+        xrun.getDynamicObject()->setProperty("overrun", event.overrun);
+        xrun.getDynamicObject()->setProperty("late", event.late);
+        xrun.getDynamicObject()->setProperty("slowest_stage", getStageName(event.record.getSlowestStage()));
+        xruns.add(xrun);
+    }
+
+    juce::Array<juce::var> records;
+
+    for (const auto& record : getHistory())
+        records.add(toVar(record));
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("summary", juce::var(summaryObject));
+    root->setProperty("jitter_bin_ms", jitterBinMs);
+    root->setProperty("jitter_range_ms", jitterRangeMs);
+    root->setProperty("jitter_histogram", histogram);
+    root->setProperty("xruns", xruns);
+    root->setProperty("records", records);
+
+    return file.replaceWithText(juce::JSON::toString(juce::var(root)));
+}
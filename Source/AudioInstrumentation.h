@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    AudioInstrumentation.h
+    Created: 17 Oct 2026 10:37:52pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+/*
+    Records how long every audio callback takes, and where the time goes, so
+    dropouts can be traced to a stage in a release build where DBG is gone.
+
+    The audio thread fills in one Record per callback: when it started, the
+    gap since the last one, its duration against the block's real-time
+    budget, and the time spent in each stage. Records go into a wait-free
+    single-producer FIFO; if nothing is draining it they're dropped and
+    counted, never waited for.
+
+    On the message thread a timer drains the FIFO into a rolling history, a
+    histogram of callback jitter and a log of overruns and late callbacks,
+    which the overlay draws and the CSV/JSON dumps write out.
+
+    Stage times are CPU time summed across the decks, so with the decks
+    rendering in parallel they can add up to more than the callback took.
+*/
+class AudioInstrumentation : private juce::Timer
+{
+public:
+    enum Stage { sync = 0, resample, eq, mix, numStages };
+    static const char* getStageName(Stage stage);
+
+    struct Record
+    {
+        double startSeconds = 0.0;      // since prepare
+        float intervalMs = 0.0f;        // since the previous callback started
+        float durationMs = 0.0f;
+        float budgetMs = 0.0f;          // how much audio the block holds
+        int numSamples = 0;
+        std::array<float, numStages> stageMs{};
+
+        float getLoad() const { return budgetMs > 0 ? durationMs / budgetMs : 0.0f; }
+        bool isOverrun() const { return durationMs > budgetMs; }
+
+        /** a callback that came much later than the last block's length means the device starved */
+        bool isLate(float expectedIntervalMs) const { return intervalMs > 1.5f * expectedIntervalMs; }
+        Stage getSlowestStage() const;
+    };
+
+    struct XrunEvent
+    {
+        Record record;
+        bool overrun = false;
+        bool late = false;
+    };
+
+    struct Summary
+    {
+        juce::int64 numCallbacks = 0;
+        juce::int64 numOverruns = 0;
+        juce::int64 numLate = 0;
+        juce::int64 numDropped = 0;     // records lost because the FIFO was full
+        float lastLoad = 0.0f;
+        float averageLoad = 0.0f;       // over the last second
+        float peakLoad = 0.0f;
+        float maxDurationMs = 0.0f;
+    };
+
+    // jitter is the callback interval minus the block length, in 0.25 ms bins from -4 to +4 ms
+    static constexpr int numJitterBins = 34;
+    static constexpr float jitterBinMs = 0.25f;
+    static constexpr float jitterRangeMs = 4.0f;
+
+    static constexpr int fifoSize = 2048;
+    static constexpr int historySize = 8192;
+    static constexpr int maxXrunEvents = 256;
+
+    AudioInstrumentation();
+    ~AudioInstrumentation() override;
+
+    //==============================================================================
+    // audio thread
+
+    void prepare(double sampleRate);
+
+    /** call at the very start of the callback */
+    void callbackStarted();
+
+    /** adds to a stage's time for the current callback */
+    void addStageTime(Stage stage, double seconds);
+
+    /** call at the very end of the callback */
+    void callbackFinished(int numSamples);
+
+    //==============================================================================
+    // message thread
+
+    Summary getSummary() const;
+    const std::array<juce::int64, numJitterBins>& getJitterHistogram() const;
+    const std::vector<XrunEvent>& getXrunLog() const;
+
+    /** the most recent records, oldest first */
+    std::vector<Record> getHistory() const;
+
+    void reset();
+
+    /** one row per record in the history */
+    bool writeCsv(const juce::File& file) const;
+
+    /** the summary, histogram, xrun log and history */
+    bool writeJson(const juce::File& file) const;
+
+private:
+    void timerCallback() override;
+    void addToHistory(const Record& record);
+
+    // audio thread
+    double sampleRate = 48000.0;
+    juce::int64 prepareTicks = 0;
+    juce::int64 startTicks = 0;
+    juce::int64 lastStartTicks = 0;
+    Record current;
+
+    juce::AbstractFifo fifo{ fifoSize };
+    std::array<Record, fifoSize> fifoRecords;
+    std::atomic<juce::int64> numDropped{ 0 };
+
+    // message thread
+    std::vector<Record> history;
+    int historyStart = 0;
+    Summary summary;
+    std::array<juce::int64, numJitterBins> jitterHistogram{};
+    std::vector<XrunEvent> xrunLog;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioInstrumentation)
+};
@@ -0,0 +1,508 @@
+/*
+  ==============================================================================
+
+    BeatAnalyser.cpp
+    Created: 17 Oct 2026 7:58:26pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "BeatAnalyser.h"
+
+namespace
+{
+    constexpr int fftOrder = 10;
+    constexpr int fftSize = 1 << fftOrder;
+    constexpr double envelopeRate = 200.0;     // onset envelope frames per second
+    constexpr double minBpm = 70.0, maxBpm = 180.0;
+    constexpr double lowBandHz = 150.0;         // kicks and bass, for finding downbeats
+    constexpr double minTrackSeconds = 10.0;
+
+    /** envelope value at a fractional frame, linearly interpolated */
+    float interpolate(const std::vector<float>& envelope, double frame)
+    {
+        const int index = (int) frame;
+
+        if (index < 0 || index + 1 >= (int) envelope.size())
+            return 0.0f;
+
+        const float alpha = (float) (frame - index);
+        return envelope[(size_t) index] + alpha * (envelope[(size_t) index + 1] - envelope[(size_t) index]);
+    }
+
+    /** how much onset energy lands on a grid of beats */
+    float combScore(const std::vector<float>& envelope, double period, double phase, int step = 1, int offset = 0)
+    {
+        float score = 0.0f;
+
+        for (double frame = phase + offset * period; frame < (double) envelope.size(); frame += period * step)
+            score += interpolate(envelope, frame);
+
+        return score;
+    }
+
+    /** removes the slowly moving part of the envelope and keeps only the rises */
+    std::vector<float> normalise(const std::vector<float>& flux, int radius)
+    {
+        const int n = (int) flux.size();
+        std::vector<double> prefix((size_t) n + 1, 0.0);
+
+        for (int i = 0; i < n; ++i)
+            prefix[(size_t) i + 1] = prefix[(size_t) i] + flux[(size_t) i];
+
+        std::vector<float> result((size_t) n);
+
+        for (int i = 0; i < n; ++i)
+        {
+            const int lo = juce::jmax(0, i - radius), hi = juce::jmin(n, i + radius + 1);
+            const double mean = (prefix[(size_t) hi] - prefix[(size_t) lo]) / (hi - lo);
+            result[(size_t) i] = juce::jmax(0.0f, flux[(size_t) i] - (float) mean);
+        }
+
+        return result;
+    }
+}
+
+//==============================================================================
+/** a queued analysis, which knows its file so cancel() can find it */
+class BeatAnalyser::Job : public juce::ThreadPoolJob
+{
+public:
+    Job(const juce::String& _path, std::function<void()> _work)
+        : juce::ThreadPoolJob("Beat analysis"),
+          path(_path),
+          work(std::move(_work))
+    {}
+
+    JobStatus runJob() override
+    {
+        work();
+        return jobHasFinished;
+    }
+
+    const juce::String path;
+
+private:
+    std::function<void()> work;
+};
+
+//==============================================================================
+BeatAnalyser::BeatAnalyser(juce::AudioFormatManager& _formatManager,
+                           juce::File _analysisFile,
+                           int numThreads)
+                           : formatManager(_formatManager),
+                             analysisFile(_analysisFile),
+                             workers(juce::jmax(1, numThreads), 0, juce::Thread::Priority::low)
+{
+    load();
+}
+
+BeatAnalyser::~BeatAnalyser()
+{
+    workers.removeAllJobs(true, -1); // analysis checks shouldExit as it goes, so this is quick
+
+    if (needsSaving)
+        save();
+}
+
+void BeatAnalyser::addListener(Listener* listener)
+{
+    listeners.add(listener);
+}
+
+void BeatAnalyser::removeListener(Listener* listener)
+{
+    listeners.remove(listener);
+}
+
+bool BeatAnalyser::getBeatGrid(const juce::File& file, BeatGrid& result) const
+{
+    auto it = entries.find(file.getFullPathName());
+
+    if (it == entries.end() || ! isUpToDate(it->second, file) || ! it->second.grid.isValid())
+        return false;
+
+    result = it->second.grid;
+    return true;
+}
+
+void BeatAnalyser::analyse(const juce::File& file, bool cancellable)
+{
+    const auto path = file.getFullPathName();
+
+    if (auto it = pending.find(path); it != pending.end())
+    {
+        it->second = it->second && cancellable;
+        return;
+    }
+
+    // checked against the file on the worker, so this doesn't touch the disk
+    std::optional<Entry> stored;
+
+    if (auto it = entries.find(path); it != entries.end())
+        stored = it->second;
+
+    pending[path] = cancellable;
+    juce::WeakReference<BeatAnalyser> weakThis(this);
+
+    // the job only reads formatManager, declared before workers, and the destructor waits for it
+    // without a time limit. Results go back through weakThis on the message thread
+    workers.addJob(new Job(path, [this, weakThis, file, path, stored]
+    {
+        const bool exists = file.existsAsFile();
+        const bool upToDate = exists && stored.has_value() && isUpToDate(*stored, file);
+        const auto fileSize = file.getSize();
+        const auto modificationTime = file.getLastModificationTime().toMilliseconds();
+        BeatGrid grid;
+
+        if (upToDate)
+        {
+            grid = stored->grid;
+        }
+        else if (exists)
+        {
+            const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+            grid = analyseFile(formatManager, file, []
+            {
+                auto* job = juce::ThreadPoolJob::getCurrentThreadPoolJob();
+                return job != nullptr && job->shouldExit();
+            });
+
+            DBG("BeatAnalyser: " << file.getFileName() << " - " << grid.bpm << " BPM, first beat at "
+                << grid.firstBeatSeconds << "s, in " << juce::Time::getMillisecondCounterHiRes() - startTime << " ms");
+        }
+
+        juce::MessageManager::callAsync([weakThis, file, path, fileSize, modificationTime, grid, exists, upToDate]
+        {
+            if (weakThis == nullptr)
+                return;
+
+            weakThis->pending.erase(path);
+
+            if (! exists)
+                return;
+
+            if (! upToDate)
+            {
+                // stored even if there's no clear beat, so the file isn't analysed again
+                weakThis->entries[path] = { fileSize, modificationTime, grid };
+                weakThis->needsSaving = true;
+                weakThis->startTimer(2000); // a folder's worth of results gets written in one go
+            }
+
+            weakThis->listeners.call([&](Listener& l) { l.trackAnalysed(file, grid); });
+        });
+    }), true);
+}
+
+bool BeatAnalyser::cancel(const juce::File& file)
+{
+    const auto path = file.getFullPathName();
+    const auto it = pending.find(path);
+
+    if (it == pending.end())
+        return true;
+
+    if (! it->second)
+        return false;
+
+    // picked under the pool's lock, so a job can't start between being chosen and being removed
+    struct QueuedJobForFile : public juce::ThreadPool::JobSelector
+    {
+        explicit QueuedJobForFile(const juce::String& _path) : path(_path) {}
+
+        bool isJobSuitable(juce::ThreadPoolJob* job) override
+        {
+            auto* analysis = dynamic_cast<Job*>(job);
+
+            if (analysis == nullptr || analysis->path != path || analysis->isRunning())
+                return false;
+
+            found = true;
+            return true;
+        }
+
+        const juce::String& path;
+        bool found = false;
+    };
+
+    QueuedJobForFile selector(path);
+    workers.removeAllJobs(false, 0, &selector);
+
+    if (! selector.found)
+        return false;
+
+    pending.erase(it);
+    return true;
+}
+
+int BeatAnalyser::analyseFolder(const juce::File& folder)
+{
+    const auto numPendingBefore = pending.size();
+
+    for (const auto& entry : juce::RangedDirectoryIterator(folder, true, formatManager.getWildcardForAllFormats()))
+        analyse(entry.getFile());
+
+    return (int) (pending.size() - numPendingBefore);
+}
+
+int BeatAnalyser::getNumPending() const
+{
+    return (int) pending.size();
+}
+
+bool BeatAnalyser::isUpToDate(const Entry& entry, const juce::File& file)
+{
+    return entry.fileSize == file.getSize()
+        && entry.modificationTime == file.getLastModificationTime().toMilliseconds();
+}
+
+void BeatAnalyser::timerCallback()
+{
+    stopTimer();
+
+    if (needsSaving)
+        save();
+}
+
+// one line per track: size,modified,bpm,firstBeat,firstDownbeat,path - the path goes last as it may contain commas
+void BeatAnalyser::load()
+{
+    if (! analysisFile.existsAsFile())
+        return;
+
+    juce::StringArray lines;
+    analysisFile.readLines(lines);
+
+    for (int i = 1; i < lines.size(); ++i) // skip the header
+    {
+        juce::StringArray fields;
+        auto rest = lines[i];
+
+        for (int field = 0; field < 5 && rest.contains(","); ++field)
+        {
+            fields.add(rest.upToFirstOccurrenceOf(",", false, false));
+            rest = rest.fromFirstOccurrenceOf(",", false, false);
+        }
+
+        if (fields.size() != 5 || rest.isEmpty())
+            continue;
+
+        Entry entry;
+        entry.fileSize = fields[0].getLargeIntValue();
+        entry.modificationTime = fields[1].getLargeIntValue();
+        entry.grid.bpm = fields[2].getDoubleValue();
+        entry.grid.firstBeatSeconds = fields[3].getDoubleValue();
+        entry.grid.firstDownbeat = fields[4].getIntValue();
+        entries[rest] = entry;
+    }
+}
+
+void BeatAnalyser::save()
+{
+    juce::TemporaryFile temp(analysisFile);
+
+    {
+        juce::FileOutputStream out(temp.getFile());
+
+        if (! out.openedOk())
+        {
+            DBG("BeatAnalyser: couldn't write " << analysisFile.getFullPathName());
+            return;
+        }
+
+        out << "size,modified,bpm,firstBeat,firstDownbeat,path\n";
+
+        for (const auto& [path, entry] : entries)
+            out << entry.fileSize << "," << entry.modificationTime << ","
+                << juce::String(entry.grid.bpm, 4) << "," << juce::String(entry.grid.firstBeatSeconds, 5) << ","
+                << entry.grid.firstDownbeat << "," << path << "\n";
+    }
+
+    if (temp.overwriteTargetFileWithTemporary())
+        needsSaving = false;
+}
+
+BeatGrid BeatAnalyser::analyseFile(juce::AudioFormatManager& formatManager,
+                                   const juce::File& file,
+                                   std::function<bool()> shouldAbort)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr || reader->sampleRate <= 0 || reader->lengthInSamples < reader->sampleRate * minTrackSeconds)
+        return {};
+
+    const double sampleRate = reader->sampleRate;
+    const int hop = juce::jmax(1, juce::roundToInt(sampleRate / envelopeRate));
+    const double framesPerSecond = sampleRate / hop;
+    const int numBins = fftSize / 2;
+    const int lowBins = juce::jlimit(2, numBins, (int) (lowBandHz * fftSize / sampleRate) + 1);
+
+    juce::dsp::FFT fft(fftOrder);
+    std::vector<float> window((size_t) fftSize);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t) fftSize,
+                                                             juce::dsp::WindowingFunction<float>::hann, false);
+
+    std::vector<float> fftData((size_t) fftSize * 2);
+    std::vector<float> previous((size_t) numBins + 1, 0.0f);
+    std::vector<float> flux, lowFlux;
+    flux.reserve((size_t) (reader->lengthInSamples / hop) + 1);
+    lowFlux.reserve(flux.capacity());
+
+    // spectral flux: how much the log spectrum rises from one frame to the next
+    const int chunkSize = 1 << 15;
+    juce::AudioBuffer<float> chunk((int) juce::jmin(2u, reader->numChannels), chunkSize);
+    std::vector<float> mono;
+    size_t frameStart = 0;
+
+    for (juce::int64 pos = 0; pos < reader->lengthInSamples; pos += chunkSize)
+    {
+        if (shouldAbort != nullptr && shouldAbort())
+            return {};
+
+        const int numToRead = (int) juce::jmin((juce::int64) chunkSize, reader->lengthInSamples - pos);
+        reader->read(&chunk, 0, numToRead, pos, true, true);
+
+        const auto oldSize = mono.size();
+        mono.resize(oldSize + (size_t) numToRead);
+        juce::FloatVectorOperations::copy(mono.data() + oldSize, chunk.getReadPointer(0), numToRead);
+
+        if (chunk.getNumChannels() > 1)
+            juce::FloatVectorOperations::add(mono.data() + oldSize, chunk.getReadPointer(1), numToRead);
+
+        for (; frameStart + (size_t) fftSize <= mono.size(); frameStart += (size_t) hop)
+        {
+            juce::FloatVectorOperations::multiply(fftData.data(), mono.data() + frameStart, window.data(), fftSize);
+            std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+            fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+            float total = 0.0f, low = 0.0f;
+
+            for (int bin = 1; bin <= numBins; ++bin)
+            {
+                const float magnitude = std::log1p(100.0f * fftData[(size_t) bin]);
+                const float rise = magnitude - previous[(size_t) bin];
+                previous[(size_t) bin] = magnitude;
+
+                if (rise > 0.0f)
+                {
+                    total += rise;
+
+                    if (bin < lowBins)
+                        low += rise;
+                }
+            }
+
+            flux.push_back(total);
+            lowFlux.push_back(low);
+        }
+
+        // drop what every remaining frame has moved past
+        mono.erase(mono.begin(), mono.begin() + (std::ptrdiff_t) frameStart);
+        frameStart = 0;
+    }
+
+    const auto onsets = normalise(flux, (int) (framesPerSecond / 4));
+    const auto lowOnsets = normalise(lowFlux, (int) (framesPerSecond / 4));
+
+    // tempo: the autocorrelation peak, weighted towards 120 BPM to avoid picking half or double
+    const int minLag = (int) std::floor(framesPerSecond * 60.0 / (maxBpm * 2.0));
+    const int maxLag = (int) std::ceil(framesPerSecond * 60.0 / (minBpm / 2.0));
+    const int numFrames = (int) onsets.size();
+
+    if (numFrames <= maxLag + 2)
+        return {};
+
+    std::vector<float> correlation((size_t) maxLag + 2, 0.0f);
+
+    for (int lag = minLag - 1; lag <= maxLag + 1; ++lag)
+    {
+        double sum = 0.0;
+
+        for (int i = 0; i + lag < numFrames; ++i)
+            sum += onsets[(size_t) i] * onsets[(size_t) (i + lag)];
+
+        correlation[(size_t) lag] = (float) (sum / (numFrames - lag));
+    }
+
+    int bestLag = 0;
+    float bestScore = 0.0f;
+
+    for (int lag = minLag; lag <= maxLag; ++lag)
+    {
+        const double bpm = 60.0 * framesPerSecond / lag;
+        const double octaves = std::log2(bpm / 120.0);
+        const float score = correlation[(size_t) lag] * (float) std::exp(-0.5 * octaves * octaves);
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+
+    if (bestLag == 0)
+        return {};
+
+    // sub-frame peak position
+    double period = bestLag;
+    {
+        const float a = correlation[(size_t) bestLag - 1], b = correlation[(size_t) bestLag], c = correlation[(size_t) bestLag + 1];
+        const float denominator = a - 2.0f * b + c;
+
+        if (denominator < 0.0f)
+            period += 0.5 * (a - c) / denominator;
+    }
+
+    while (60.0 * framesPerSecond / period < minBpm)  period /= 2.0;
+    while (60.0 * framesPerSecond / period >= maxBpm) period *= 2.0;
+
+    // exact period and phase: the grid that catches the most onset energy over the whole track
+    double bestPeriod = period, bestPhase = 0.0;
+    bestScore = -1.0f;
+
+    for (double candidate = period * 0.99; candidate <= period * 1.01; candidate += period * 0.0005)
+    {
+        if (shouldAbort != nullptr && shouldAbort())
+            return {};
+
+        for (double phase = 0.0; phase < candidate; phase += 0.5)
+        {
+            const float score = combScore(onsets, candidate, phase);
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestPeriod = candidate;
+                bestPhase = phase;
+            }
+        }
+    }
+
+    // hi-hats and snares can pull the grid on to the off-beats, but the kicks say which half is the beat
+    if (combScore(lowOnsets, bestPeriod, bestPhase + bestPeriod / 2) > combScore(lowOnsets, bestPeriod, bestPhase))
+        bestPhase = std::fmod(bestPhase + bestPeriod / 2, bestPeriod);
+
+    // downbeat: whichever beat of the bar has the most low end on it
+    int firstDownbeat = 0;
+    float bestBarScore = -1.0f;
+
+    for (int beat = 0; beat < BeatGrid::beatsPerBar; ++beat)
+    {
+        const float score = combScore(lowOnsets, bestPeriod, bestPhase, BeatGrid::beatsPerBar, beat);
+
+        if (score > bestBarScore)
+        {
+            bestBarScore = score;
+            firstDownbeat = beat;
+        }
+    }
+
+    BeatGrid grid;
+    grid.bpm = 60.0 * framesPerSecond / bestPeriod;
+    grid.firstBeatSeconds = (bestPhase * hop + fftSize / 2) / sampleRate; // frames are stamped at their centre
+    grid.firstDownbeat = firstDownbeat;
+    return grid;
+}
@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    BeatAnalyser.h
+    Created: 17 Oct 2026 7:58:26pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <map>
+#include <optional>
+
+//==============================================================================
+/** A constant-tempo beat grid: where the beats of a track fall and which of
+    them start a bar.
+*/
+struct BeatGrid
+{
+    static constexpr int beatsPerBar = 4;
+
+    double bpm = 0.0;
+    double firstBeatSeconds = 0.0;  // time of the first beat in the track
+    int firstDownbeat = 0;          // which of the first four beats starts a bar
+
+    bool isValid() const { return bpm > 0.0; }
+    double getBeatLengthSeconds() const { return 60.0 / bpm; }
+
+    /** beats since the first beat at a time in the track, fractional part being the phase */
+    double getBeatPosition(double seconds) const { return (seconds - firstBeatSeconds) / getBeatLengthSeconds(); }
+    double getBeatTime(double beat) const { return firstBeatSeconds + beat * getBeatLengthSeconds(); }
+    bool isDownbeat(int beat) const { return ((beat - firstDownbeat) % beatsPerBar + beatsPerBar) % beatsPerBar == 0; }
+};
+
+//==============================================================================
+/*
+    Works out the tempo, beat grid and downbeats of tracks on a couple of
+    low-priority background threads, so a long queue never competes with the
+    decks' read-ahead and render threads, and remembers them in analysis.csv
+    next to the playlist so each track is only ever analysed once.
+
+    The analysis is onset based: a spectral flux envelope from short FFT
+    frames, its autocorrelation for the tempo, a comb over the whole track to
+    pin down the exact period and phase, and the low end of the spectrum to
+    find which beat of the bar the kick lands heaviest on.
+
+    Apart from analyseFile, everything here is for the message thread.
+*/
+class BeatAnalyser : private juce::Timer
+{
+public:
+    BeatAnalyser(juce::AudioFormatManager& formatManager,
+                 juce::File analysisFile = juce::File::getCurrentWorkingDirectory().getChildFile("analysis.csv"),
+                 int numThreads = 2);
+    ~BeatAnalyser() override;
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** called on the message thread when a track has been analysed, or when analyse()
+            finds it was analysed before. The grid is invalid if there was no clear beat */
+        virtual void trackAnalysed(const juce::File& file, const BeatGrid& grid) = 0;
+    };
+
+    void addListener(Listener* listener);
+    void removeListener(Listener* listener);
+
+    /** fills in the stored grid for a file, returning false if it hasn't been analysed since it last changed */
+    bool getBeatGrid(const juce::File& file, BeatGrid& result) const;
+
+    /** queues a file for analysis, unless it's already queued. The file is only looked at on the
+        workers, and one analysed since it last changed isn't read again - its stored grid goes
+        straight to the listeners. Only a file every caller queued as cancellable can be cancelled */
+    void analyse(const juce::File& file, bool cancellable = false);
+
+    /** takes a file queued as cancellable back off the queue if it's still waiting there. Returns
+        false if it's already being analysed or someone needs it, in which case its result still arrives */
+    bool cancel(const juce::File& file);
+
+    /** queues every audio file under a folder, returning how many were queued */
+    int analyseFolder(const juce::File& folder);
+
+    /** number of files queued or being analysed */
+    int getNumPending() const;
+
+    /** analyses a file on the calling thread. Returns an invalid grid if it can't be
+        read or has no clear beat. shouldAbort is polled between chunks */
+    static BeatGrid analyseFile(juce::AudioFormatManager& formatManager,
+                                const juce::File& file,
+                                std::function<bool()> shouldAbort = nullptr);
+
+private:
+    class Job;
+
+    struct Entry
+    {
+        juce::int64 fileSize = 0;
+        juce::int64 modificationTime = 0;
+        BeatGrid grid;
+    };
+
+    static bool isUpToDate(const Entry& entry, const juce::File& file);
+    void load();
+    void save();
+    void timerCallback() override;
+
+    juce::AudioFormatManager& formatManager;
+    const juce::File analysisFile;
+    juce::ThreadPool workers;
+
+    std::map<juce::String, Entry> entries;
+    std::map<juce::String, bool> pending; // path -> whether cancel() may drop it
+    bool needsSaving = false;
+
+    juce::ListenerList<Listener> listeners;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (BeatAnalyser)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BeatAnalyser)
+};
@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    CachedTrackSource.cpp
+    Created: 17 Oct 2026 1:48:51pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "CachedTrackSource.h"
+
+CachedTrackSource::CachedTrackSource(std::shared_ptr<const TrackCache::Entry> _entry)
+                                     : entry(std::move(_entry))
+{
+    jassert(entry != nullptr);
+}
+
+CachedTrackSource::~CachedTrackSource()
+{}
+
+void CachedTrackSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{}
+
+void CachedTrackSource::releaseResources()
+{}
+
+void CachedTrackSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    auto pos = nextReadPos.load();
+    entry->read(*bufferToFill.buffer, bufferToFill.startSample, pos, bufferToFill.numSamples);
+
+    // only advance if nobody seeked while we were reading
+    nextReadPos.compare_exchange_strong(pos, pos + bufferToFill.numSamples);
+}
+
+void CachedTrackSource::setNextReadPosition(juce::int64 newPosition)
+{
+    nextReadPos.store(newPosition);
+}
+
+juce::int64 CachedTrackSource::getNextReadPosition() const
+{
+    return nextReadPos.load();
+}
+
+juce::int64 CachedTrackSource::getTotalLength() const
+{
+    return entry->lengthInSamples;
+}
+
+bool CachedTrackSource::isLooping() const
+{
+    return false;
+}
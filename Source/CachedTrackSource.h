@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    CachedTrackSource.h
+    Created: 17 Oct 2026 1:48:51pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include "TrackCache.h"
+
+//==============================================================================
+/*
+    Plays a track straight out of the TrackCache. Everything is already decoded
+    in memory, so there's nothing to read ahead and seeking anywhere is free.
+*/
+class CachedTrackSource : public juce::PositionableAudioSource
+{
+public:
+    explicit CachedTrackSource(std::shared_ptr<const TrackCache::Entry> entry);
+    ~CachedTrackSource() override;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    void setNextReadPosition(juce::int64 newPosition) override;
+    juce::int64 getNextReadPosition() const override;
+    juce::int64 getTotalLength() const override;
+    bool isLooping() const override;
+
+private:
+    std::shared_ptr<const TrackCache::Entry> entry;
+    std::atomic<juce::int64> nextReadPos{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedTrackSource)
+};
@@ -10,33 +10,149 @@
 
 #include "DJAudioPlayer.h"
 
-DJAudioPlayer::DJAudioPlayer(juce::AudioFormatManager& _formatManager)
-                            : formatManager(_formatManager)
-{}
+DJAudioPlayer::DJAudioPlayer(TrackLoader& _trackLoader)
+                            : trackLoader(_trackLoader)
+{
+    // positions are in the track's own samples, the resampler below does the rate conversion
+    transportSource.setSource(&deckSource);
+    hotCues.fill(-1);
+}
 
 DJAudioPlayer::~DJAudioPlayer() 
-{}
+{
+    transportSource.setSource(nullptr);
+}
 
 void DJAudioPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
 {
     lastSampleRate = sampleRate;
+
+    smoothedSpeed.reset(sampleRate, 0.1);
+    smoothedSpeed.setCurrentAndTargetValue(speedRatio.load());
+    smoothedGain.reset(sampleRate, 0.02);
+    smoothedGain.setCurrentAndTargetValue(targetGain.load());
    
     transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
     resampleSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    eq.prepare(sampleRate);
 }
 
 void DJAudioPlayer::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
 {
-    resampleSource.getNextAudioBlock(bufferToFill);
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    const auto update = deckSource.updateFromAudioThread(transportSource.isPlaying());
+
+    if (update.trackChanged || update.seeked) // start again from the new position
+    {
+        resampleSource.flushBuffers();
+        timeStretchSource.reset();
+        playhead = (double) deckSource.getNextReadPosition();
+        deckSource.takeJumpDistance(); // already counted in the new position
+    }
+
+    publishedBeatGrid.tryRead(audioBeatGrid); // keeps the last copy if a new grid is half written
+
+    // key-lock settings are picked up here, so the stretcher is only ever touched from this thread
+    const bool keyLock = keyLockEnabled.load();
+    const auto quality = (TimeStretchSource::Quality) keyLockQuality.load();
+
+    if (keyLock != timeStretchSource.isEnabled() || quality != timeStretchSource.getQuality())
+    {
+        timeStretchSource.setQuality(quality);
+        timeStretchSource.setEnabled(keyLock);
+        resampleSource.flushBuffers();
+    }
+
+    const double trackRate = deckSource.getCurrentSampleRate();
+    const double rateRatio = trackRate > 0 ? trackRate / lastSampleRate : 1.0;
+    smoothedSpeed.setTargetValue(speedRatio.load());
 
-    std::array<float*, 2> channels = { bufferToFill.buffer->getWritePointer(0), bufferToFill.buffer->getWritePointer(1) };
-    auto totalNumSamples = bufferToFill.buffer->getNumSamples();
-    for (int i = 0; i < 2; ++i)
+    if (syncSpeed > 0)
     {
-        highGainControl[i].processSamples(channels[i], totalNumSamples);
-        midGainControl[i].processSamples(channels[i], totalNumSamples);
-        lowGainControl[i].processSamples(channels[i], totalNumSamples);
+        // sync sets the speed block by block, and the tempo setting glides back in from there when it lets go
+        smoothedSpeed.setCurrentAndTargetValue(syncSpeed);
+        smoothedSpeed.setTargetValue(speedRatio.load());
+        renderSection(bufferToFill, syncSpeed, rateRatio);
     }
+    else if (! smoothedSpeed.isSmoothing())
+    {
+        renderSection(bufferToFill, smoothedSpeed.getCurrentValue(), rateRatio);
+    }
+    else
+    {
+        // the resampler only takes one ratio per call, so ramp it a sub-block at a time
+        for (int start = 0; start < bufferToFill.numSamples; start += speedSubBlockSize)
+        {
+            const int numThisTime = juce::jmin(speedSubBlockSize, bufferToFill.numSamples - start);
+            renderSection(juce::AudioSourceChannelInfo(bufferToFill.buffer, bufferToFill.startSample + start, numThisTime),
+                          smoothedSpeed.skip(numThisTime), rateRatio);
+        }
+    }
+
+    const auto renderedTicks = juce::Time::getHighResolutionTicks();
+
+    auto* buffer = bufferToFill.buffer;
+    float* left = buffer->getWritePointer(0, bufferToFill.startSample);
+    float* right = buffer->getNumChannels() > 1 ? buffer->getWritePointer(1, bufferToFill.startSample) : left;
+    eq.process(left, right, bufferToFill.numSamples);
+
+    smoothedGain.setTargetValue(targetGain.load());
+
+    if (smoothedGain.isSmoothing())
+    {
+        const float startGain = smoothedGain.getCurrentValue();
+        buffer->applyGainRamp(bufferToFill.startSample, bufferToFill.numSamples, startGain, smoothedGain.skip(bufferToFill.numSamples));
+    }
+    else if (smoothedGain.getCurrentValue() != 1.0f)
+    {
+        buffer->applyGain(bufferToFill.startSample, bufferToFill.numSamples, smoothedGain.getCurrentValue());
+    }
+
+    const auto endTicks = juce::Time::getHighResolutionTicks();
+    lastStageTimes.resampleSeconds = juce::Time::highResolutionTicksToSeconds(renderedTicks - startTicks);
+    lastStageTimes.eqSeconds = juce::Time::highResolutionTicksToSeconds(endTicks - renderedTicks);
+
+    // share of the real time this block represents that we spent rendering it
+    const double elapsed = juce::Time::highResolutionTicksToSeconds(endTicks - startTicks);
+    const double blockSeconds = bufferToFill.numSamples / (double) lastSampleRate;
+
+    if (blockSeconds > 0)
+        cpuLoad.store(0.9f * cpuLoad.load() + 0.1f * (float) (elapsed / blockSeconds));
+
+    PlaybackState state;
+    state.positionInSamples = playhead;
+    state.trackSampleRate = trackRate;
+    state.lengthInSamples = deckSource.getTotalLength();
+    state.speed = renderedSpeed;
+    state.timeMs = juce::Time::getMillisecondCounterHiRes();
+    state.isPlaying = transportSource.isPlaying();
+    publishedState.write(state);
+}
+
+void DJAudioPlayer::renderSection(const juce::AudioSourceChannelInfo& section, double speed, double rateRatio)
+{
+    if (timeStretchSource.isEnabled())
+    {
+        // key-lock: the stretcher changes the tempo, the resampler only converts the sample rate
+        timeStretchSource.setSpeed(speed);
+        resampleSource.setResamplingRatio(rateRatio);
+    }
+    else
+    {
+        resampleSource.setResamplingRatio(speed * rateRatio);
+    }
+
+    resampleSource.getNextAudioBlock(section);
+
+    // the resampler and stretcher both take exactly speed * rateRatio track samples per output sample on average
+    renderedSpeed = speed;
+
+    if (transportSource.isPlaying())
+        playhead += speed * rateRatio * section.numSamples;
+
+    // loops and hot cues move the read position under the resampler without flushing it
+    playhead += (double) deckSource.takeJumpDistance();
 }
 
 void DJAudioPlayer::releaseResources()
@@ -45,23 +161,85 @@ void DJAudioPlayer::releaseResources()
     resampleSource.releaseResources();
 }
 
-void DJAudioPlayer::loadURL(juce::URL audioURL) 
+void DJAudioPlayer::loadURL(juce::URL audioURL, std::function<void(bool loaded)> onLoaded)
 {
     paused = false;
-    transportSource.setPosition(0.0);
-    juce::AudioFormatReader* reader = formatManager.createReaderFor(audioURL.createInputStream(false));
+    const int generation = ++loadGeneration;
+    decodeJumpBuffersNow = false;
+
+    TrackLoader::Request request;
+    request.url = audioURL;
+    request.readAheadBufferSize = readAheadBufferSize;
+    request.stats = &readAheadStats;
 
-    if (reader != nullptr) // good file!
+    juce::WeakReference<DJAudioPlayer> weakThis(this);
+
+    trackLoader.loadAsync(request, [weakThis, generation, onLoaded](std::unique_ptr<LoadedTrack> track)
     {
-        std::unique_ptr<juce::AudioFormatReaderSource> newSource(new juce::AudioFormatReaderSource(reader, true));
-        transportSource.setSource(newSource.get(), 0, nullptr, reader->sampleRate);
-        readerSource.reset(newSource.release());
-        trackLoaded = true;
-    }
-    else
+        auto* self = weakThis.get();
+
+        if (self == nullptr || generation != self->loadGeneration) // deck's gone, or a newer load was started while this one was running
+            return;
+
+        const bool loaded = track != nullptr;
+
+        if (loaded) // good file!
+        {
+            self->setLoadedTrack(std::move(track));
+        }
+        else
+        {
+            DBG("Something went wrong loading the file! :( ");
+        }
+
+        if (onLoaded != nullptr)
+            onLoaded(loaded);
+    });
+}
+
+bool DJAudioPlayer::loadURLNow(juce::URL audioURL)
+{
+    paused = false;
+    ++loadGeneration; // any load still running in the background is out of date now
+    decodeJumpBuffersNow = true;
+
+    TrackLoader::Request request;
+    request.url = audioURL;
+    request.readAheadBufferSize = readAheadBufferSize;
+    request.stats = &readAheadStats;
+
+    auto track = trackLoader.loadNow(request);
+
+    if (track == nullptr)
     {
         DBG("Something went wrong loading the file! :( ");
+        return false;
     }
+
+    setLoadedTrack(std::move(track));
+    return true;
+}
+
+void DJAudioPlayer::setLoadedTrack(std::unique_ptr<LoadedTrack> track)
+{
+    lastLoadTimings = track->timings;
+    trackSampleRate = track->sampleRate;
+    trackLengthInSamples = track->lengthInSamples;
+    loadedURL = track->url;
+    setBeatGrid({});
+
+    // the deck drops the old track's jump points along with it
+    hotCues.fill(-1);
+    loopStart = loopEnd = exitedLoopStart = -1;
+    loopBeats = 0.0;
+    jumpBuffers.clear();
+
+    DBG("Loaded " << track->url.getFileName() << " (" << track->formatName << ") in " << lastLoadTimings.totalMs
+        << "ms - open " << lastLoadTimings.openMs << "ms, probe " << lastLoadTimings.probeMs
+        << "ms, pre-buffer " << lastLoadTimings.prebufferMs << "ms");
+
+    deckSource.setTrack(std::move(track)); // picked up by the audio thread on its next block
+    trackLoaded = true;
 }
 
 void DJAudioPlayer::setGain(double gain) 
@@ -72,35 +250,23 @@ void DJAudioPlayer::setGain(double gain)
     }
     else
     {
-        transportSource.setGain(gain);
+        targetGain.store((float) gain);
     }
 }
 
 void DJAudioPlayer::setHighGain(double gain) // sets gain level for high frequency range
 {
-    for (int i = 0; i < 2; ++i)
-    {
-        highGainCoef[i] = juce::IIRCoefficients::makeHighShelf(lastSampleRate, 7000, 0.5, gain);
-        highGainControl[i].setCoefficients(highGainCoef[i]);
-    }
+    eq.setHighGain((float) gain);
 }
 
 void DJAudioPlayer::setMidGain(double gain) // sets gain level for mid frequency range
 {
-    for (int i = 0; i < 2; ++i)
-    {
-        midGainCoef[i] = juce::IIRCoefficients::makePeakFilter(lastSampleRate, 2500, 0.555, gain);
-        midGainControl[i].setCoefficients(midGainCoef[i]);
-    }
+    eq.setMidGain((float) gain);
 }
 
 void DJAudioPlayer::setLowGain(double gain) // sets gain level for low frequency range
 {
-    for (int i = 0; i < 2; ++i)
-    {
-        lowGainCoef[i] = juce::IIRCoefficients::makeLowShelf(lastSampleRate, 1000, 0.5, gain);
-        lowGainControl[i].setCoefficients(lowGainCoef[i]);
-    }
+    eq.setLowGain((float) gain);
 }
 
 void DJAudioPlayer::setSpeed(double ratio)
@@ -111,51 +277,71 @@ void DJAudioPlayer::setSpeed(double ratio)
     }
     else
     {
-        tempoValue = tempoValue * ratio;
-        resampleSource.setResamplingRatio(ratio);
+        speedRatio.store(ratio);
     }
 }
 
-void DJAudioPlayer::setPosition(double posInSecs)
+void DJAudioPlayer::setKeyLock(bool shouldLockKey)
 {
-    transportSource.setPosition(posInSecs);
+    keyLockEnabled.store(shouldLockKey);
 }
 
-void DJAudioPlayer::setPositionRelative(double pos)
+bool DJAudioPlayer::isKeyLocked() const
 {
-    if (pos < 1 || pos > 1)
+    return keyLockEnabled.load();
+}
+
+void DJAudioPlayer::setKeyLockQuality(TimeStretchSource::Quality quality)
+{
+    keyLockQuality.store((int) quality);
+}
+
+TimeStretchSource::Quality DJAudioPlayer::getKeyLockQuality() const
+{
+    return (TimeStretchSource::Quality) keyLockQuality.load();
+}
+
+float DJAudioPlayer::getCpuLoad() const
+{
+    return cpuLoad.load();
+}
+
+void DJAudioPlayer::setPosition(double posInSecs)
+{
+    if (! trackLoaded || ! (posInSecs >= 0 && posInSecs <= getTrackLength())) // also catches NaN
     {
-        DBG("Warning: invalid relative position value, should be between 0 and 1. at DJAudioPlayer::setPositionRelative");
+        DBG("Warning: invalid position value, should be between 0 and the track length. at DJAudioPlayer::setPosition");
     }
     else
     {
-        const double posInSecs = transportSource.getLengthInSeconds() * pos;
-        setPosition(posInSecs);
+        deckSource.setNextReadPosition((juce::int64) std::llround(posInSecs * trackSampleRate));
     }
-    transportSource.setPosition(pos);
 }
 
-void DJAudioPlayer::start()
+void DJAudioPlayer::setPositionRelative(double pos)
 {
-    playing = true;
-    if (positionAtPause != 0.0 && paused == true)
+    if (! (pos >= 0 && pos <= 1))
     {
-        setPositionRelative(positionAtPause);
-        positionAtPause = 0.0;
-        paused = false;
-        transportSource.start();
+        DBG("Warning: invalid relative position value, should be between 0 and 1. at DJAudioPlayer::setPositionRelative");
     }
     else
     {
-        transportSource.start();
+        setPosition(getTrackLength() * pos);
     }
 }
 
+void DJAudioPlayer::start()
+{
+    // the deck stays where it was paused, or wherever it was moved to since
+    playing = true;
+    paused = false;
+    transportSource.start();
+}
+
 void DJAudioPlayer::pause()
 {
     playing = false;
     paused = true;
-    positionAtPause = transportSource.getCurrentPosition();
     transportSource.stop();
 }
 
@@ -163,26 +349,310 @@ void DJAudioPlayer::stop()
 {
     playing = false;
     paused = false;
-    transportSource.setPosition(0.0);
+    deckSource.setNextReadPosition(0); // dropped if there's no track, so no need to check
     transportSource.stop();
 }
 
 double const DJAudioPlayer::getPositionRelative()
 {
-    return transportSource.getCurrentPosition() / transportSource.getLengthInSeconds();
+    return getPlaybackState().getRelative();
 }
 
 double const DJAudioPlayer::getTrackLength()
 {
-    return transportSource.getLengthInSeconds();
+    return trackSampleRate > 0 ? trackLengthInSamples / trackSampleRate : 0.0;
 }
 
-bool DJAudioPlayer::checkIfPaused()
+juce::int64 DJAudioPlayer::getPositionInSamples() const
 {
-    return paused;
+    return (juce::int64) getPlaybackState().positionInSamples;
+}
+
+DJAudioPlayer::PlaybackState DJAudioPlayer::getPlaybackState() const
+{
+    return publishedState.read();
+}
+
+double DJAudioPlayer::PlaybackState::getPositionAt(double nowMs) const
+{
+    // no block for a while means the audio has stopped, so don't run on past it
+    const double maxExtrapolationMs = 50.0;
+
+    if (! isPlaying || trackSampleRate <= 0)
+        return positionInSamples;
+
+    const double position = positionInSamples + juce::jlimit(0.0, maxExtrapolationMs, nowMs - timeMs) * 0.001 * trackSampleRate * speed;
+
+    // the deck stops at the end of the track, so the playhead doesn't run on past it either
+    return lengthInSamples > 0 ? juce::jmin(position, (double) lengthInSamples) : position;
+}
+
+double DJAudioPlayer::getTrackSampleRate() const
+{
+    return trackSampleRate;
+}
+
+double DJAudioPlayer::getSpeed() const
+{
+    return speedRatio.load();
+}
+
+void DJAudioPlayer::setReadAheadBufferSize(int numSamples)
+{
+    readAheadBufferSize = juce::jmax(8192, numSamples);
 }
 
-void DJAudioPlayer::movePlayheadWhilePaused(double newPos)
+int DJAudioPlayer::getReadAheadBufferSize() const
 {
-    positionAtPause = newPos;
-}
\ No newline at end of file
+    return readAheadBufferSize;
+}
+
+const ReadAheadStats& DJAudioPlayer::getReadAheadStats() const
+{
+    return readAheadStats;
+}
+
+TrackLoadTimings DJAudioPlayer::getLastLoadTimings() const
+{
+    return lastLoadTimings;
+}
+
+void DJAudioPlayer::setBeatGrid(const BeatGrid& grid)
+{
+    beatGrid = grid;
+    publishedBeatGrid.write(grid);
+}
+
+BeatGrid DJAudioPlayer::getBeatGrid() const
+{
+    return beatGrid;
+}
+
+void DJAudioPlayer::setHotCue(int index)
+{
+    if (! trackLoaded || ! juce::isPositiveAndBelow(index, numHotCues))
+        return;
+
+    hotCues[(size_t) index] = snapToBeat((juce::int64) getPlaybackState().positionInSamples);
+    decodeJumpBuffer(hotCues[(size_t) index], (juce::int64) (hotCueBufferSeconds * trackSampleRate));
+    publishJumpPoints();
+}
+
+void DJAudioPlayer::clearHotCue(int index)
+{
+    if (! juce::isPositiveAndBelow(index, numHotCues))
+        return;
+
+    hotCues[(size_t) index] = -1;
+    publishJumpPoints();
+}
+
+bool DJAudioPlayer::isHotCueSet(int index) const
+{
+    return juce::isPositiveAndBelow(index, numHotCues) && hotCues[(size_t) index] >= 0;
+}
+
+bool DJAudioPlayer::jumpToHotCue(int index)
+{
+    if (! isHotCueSet(index))
+        return false;
+
+    return deckSource.jumpTo(hotCues[(size_t) index]);
+}
+
+bool DJAudioPlayer::setBeatLoop(double numBeats)
+{
+    if (! trackLoaded || numBeats <= 0 || trackSampleRate <= 0)
+        return false;
+
+    if (! beatGrid.isValid())
+    {
+        DBG("Warning: can't set a beat loop until the track has been analysed. at DJAudioPlayer::setBeatLoop");
+        return false;
+    }
+
+    // loops shorter than a beat start on the nearest fraction of one below the playhead
+    const double unit = juce::jmin(numBeats, 1.0);
+    const double seconds = getPlaybackState().getSeconds();
+    const double startBeat = std::floor(beatGrid.getBeatPosition(seconds) / unit) * unit;
+
+    const auto newStart = (juce::int64) std::llround(beatGrid.getBeatTime(startBeat) * trackSampleRate);
+    const auto newEnd = (juce::int64) std::llround(beatGrid.getBeatTime(startBeat + numBeats) * trackSampleRate);
+
+    if (newStart < 0 || newEnd > trackLengthInSamples || newEnd <= newStart)
+        return false;
+
+    loopStart = newStart;
+    loopEnd = newEnd;
+    loopBeats = numBeats;
+    exitedLoopStart = -1;
+
+    // the whole loop if it fits, plus what plays past its end while fading round
+    const auto loopLength = juce::jmin(loopEnd - loopStart, (juce::int64) (maxLoopBufferSeconds * trackSampleRate));
+    decodeJumpBuffer(loopStart, loopLength + DeckTrackSource::crossfadeSamples);
+    publishJumpPoints();
+    return true;
+}
+
+void DJAudioPlayer::exitLoop()
+{
+    if (loopStart < 0)
+        return;
+
+    exitedLoopStart = loopStart;
+    loopStart = loopEnd = -1;
+    loopBeats = 0.0;
+    publishJumpPoints();
+}
+
+bool DJAudioPlayer::isLoopActive() const
+{
+    return loopStart >= 0;
+}
+
+double DJAudioPlayer::getLoopBeats() const
+{
+    return loopBeats;
+}
+
+juce::int64 DJAudioPlayer::snapToBeat(juce::int64 sample) const
+{
+    if (! beatGrid.isValid() || trackSampleRate <= 0)
+        return sample;
+
+    const double beat = std::round(beatGrid.getBeatPosition(sample / trackSampleRate));
+    const auto snapped = (juce::int64) std::llround(beatGrid.getBeatTime(beat) * trackSampleRate);
+
+    return juce::jlimit((juce::int64) 0, juce::jmax((juce::int64) 0, trackLengthInSamples - 1), snapped);
+}
+
+void DJAudioPlayer::decodeJumpBuffer(juce::int64 startSample, juce::int64 numSamples)
+{
+    numSamples = juce::jmin(numSamples, trackLengthInSamples - startSample);
+
+    if (numSamples <= 0)
+        return;
+
+    for (auto& buffer : jumpBuffers)
+        if (buffer->startSample == startSample && buffer->getEndSample() >= startSample + numSamples)
+            return;
+
+    if (decodeJumpBuffersNow)
+    {
+        addJumpBuffer(startSample, trackLoader.readRegionNow(loadedURL, startSample, (int) numSamples));
+        return;
+    }
+
+    const int generation = loadGeneration;
+
+    juce::WeakReference<DJAudioPlayer> weakThis(this);
+
+    trackLoader.readRegionAsync(loadedURL, startSample, (int) numSamples,
+                                [weakThis, generation, startSample](std::unique_ptr<juce::AudioBuffer<float>> samples)
+    {
+        auto* self = weakThis.get();
+
+        if (self == nullptr || generation != self->loadGeneration) // deck's gone, or the track's since been replaced
+            return;
+
+        self->addJumpBuffer(startSample, std::move(samples));
+        self->publishJumpPoints();
+    });
+}
+
+void DJAudioPlayer::addJumpBuffer(juce::int64 startSample, std::unique_ptr<juce::AudioBuffer<float>> samples)
+{
+    if (samples == nullptr)
+    {
+        DBG("Couldn't decode the jump buffer at sample " << startSample << ", the jump will stream instead");
+        return;
+    }
+
+    auto buffer = std::make_shared<JumpBuffer>();
+    buffer->startSample = startSample;
+    buffer->samples = std::move(*samples);
+
+    // a longer loop from the same start replaces the shorter one's buffer
+    jumpBuffers.erase(std::remove_if(jumpBuffers.begin(), jumpBuffers.end(),
+                                     [&](auto& b) { return b->startSample == startSample && b->getEndSample() <= buffer->getEndSample(); }),
+                      jumpBuffers.end());
+
+    jumpBuffers.push_back(std::move(buffer));
+}
+
+bool DJAudioPlayer::isJumpBufferWanted(juce::int64 startSample) const
+{
+    if (startSample == loopStart || startSample == exitedLoopStart)
+        return true;
+
+    return std::find(hotCues.begin(), hotCues.end(), startSample) != hotCues.end();
+}
+
+void DJAudioPlayer::publishJumpPoints()
+{
+    jumpBuffers.erase(std::remove_if(jumpBuffers.begin(), jumpBuffers.end(),
+                                     [this](auto& b) { return ! isJumpBufferWanted(b->startSample); }),
+                      jumpBuffers.end());
+
+    auto points = std::make_unique<JumpPoints>();
+    points->loopStart = loopStart;
+    points->loopEnd = loopEnd;
+    points->buffers = jumpBuffers;
+
+    // buffers the audio thread is still playing from stay alive in its copy until it lets go
+    deckSource.setJumpPoints(std::move(points));
+}
+
+double DJAudioPlayer::getPlayheadInSamples() const
+{
+    return playhead;
+}
+
+double DJAudioPlayer::getOutputLatencyInSamples() const
+{
+    if (! timeStretchSource.isEnabled())
+        return 0.0;
+
+    return TimeStretchSource::getLatencyMs(timeStretchSource.getQuality()) * 0.001
+         * deckSource.getCurrentSampleRate() * renderedSpeed;
+}
+
+double DJAudioPlayer::getCurrentTrackSampleRate() const
+{
+    return deckSource.getCurrentSampleRate();
+}
+
+double DJAudioPlayer::getOutputSampleRate() const
+{
+    return lastSampleRate;
+}
+
+double DJAudioPlayer::getRenderedSpeed() const
+{
+    return renderedSpeed;
+}
+
+bool DJAudioPlayer::isRendering() const
+{
+    return transportSource.isPlaying() && deckSource.getCurrentSampleRate() > 0;
+}
+
+const BeatGrid& DJAudioPlayer::getRenderedBeatGrid() const
+{
+    return audioBeatGrid;
+}
+
+void DJAudioPlayer::setSyncSpeed(double newSpeed)
+{
+    syncSpeed = newSpeed > 0 ? juce::jlimit(0.5, 2.0, newSpeed) : 0.0;
+}
+
+DJAudioPlayer::StageTimes DJAudioPlayer::getLastStageTimes() const
+{
+    return lastStageTimes;
+}
+
+bool DJAudioPlayer::checkIfPaused()
+{
+    return paused;
+}
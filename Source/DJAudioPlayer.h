@@ -10,24 +10,73 @@
 
 #pragma once
 
-#include "../JuceLibraryCode/JuceHeader.h"
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include "BeatAnalyser.h"
+#include "DeckTrackSource.h"
+#include "ReadAheadSource.h"
+#include "SeqLock.h"
+#include "ThreeBandEQ.h"
+#include "TimeStretchSource.h"
+#include "TrackLoader.h"
 
 class DJAudioPlayer : public juce::AudioSource
 {
     public:
-        DJAudioPlayer(juce::AudioFormatManager& _formatManager);
+        /** the deck as the audio thread left it at the end of its last block */
+        struct PlaybackState
+        {
+            double positionInSamples = 0.0; // the playhead as rendered, fractional, in samples of the track
+            double trackSampleRate = 0.0;   // 0 if no track has reached the audio thread yet
+            juce::int64 lengthInSamples = 0;
+            double speed = 1.0;             // as rendered, so including sync
+            double timeMs = 0.0;            // Time::getMillisecondCounterHiRes when the block was rendered
+            bool isPlaying = false;
+
+            double getSeconds() const { return trackSampleRate > 0 ? positionInSamples / trackSampleRate : 0.0; }
+            double getRelative() const { return lengthInSamples > 0 ? juce::jlimit(0.0, 1.0, positionInSamples / lengthInSamples) : 0.0; }
+
+            /** where the playhead will be at nowMs if the deck carries on as it was, for drawing between blocks */
+            double getPositionAt(double nowMs) const;
+        };
+
+        DJAudioPlayer(TrackLoader& _trackLoader);
         ~DJAudioPlayer();
 
         void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
         void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
         void releaseResources() override;
 
-        void loadURL(juce::URL audioURL);
+        /** loads the track in the background, onLoaded is called on the message thread once it's playable */
+        void loadURL(juce::URL audioURL, std::function<void(bool loaded)> onLoaded = nullptr);
+
+        /** loads the track on the calling thread, for offline rendering where there's no message loop */
+        bool loadURLNow(juce::URL audioURL);
+
+        /** a consistent copy of the last block's state, cheap enough to poll every frame. Not for the audio thread */
+        PlaybackState getPlaybackState() const;
+
         void setGain(double gain);
         void setHighGain(double gain);
         void setMidGain(double gain);
         void setLowGain(double gain);
         void setSpeed(double ratio);
+
+        /** with key-lock on, speed changes the tempo but not the pitch */
+        void setKeyLock(bool shouldLockKey);
+        bool isKeyLocked() const;
+
+        /** lower quality uses less CPU and adds less latency, see TimeStretchSource::getSettings */
+        void setKeyLockQuality(TimeStretchSource::Quality quality);
+        TimeStretchSource::Quality getKeyLockQuality() const;
+
+        /** smoothed fraction of real time spent rendering this deck, 1.0 meaning it can't keep up */
+        float getCpuLoad() const;
+
+        /** seeks to a time in the track, or a fraction of its length. Applied at the start of the
+            next block, paused or not. Out of range positions are refused */
         void setPosition(double posInSecs);
         void setPositionRelative(double pos);
 
@@ -35,33 +84,158 @@ class DJAudioPlayer : public juce::AudioSource
         void pause();
         void stop();
         bool checkIfPaused();
-        double tempoValue = 0.10471;
-        void movePlayheadWhilePaused(double newPos);
 
-        //** gets the relative pos of the playhead
+        //** gets the relative pos of the playhead, from the playback state
         double const getPositionRelative();
         double const getTrackLength();
+
+        /** the playhead in samples of the loaded track, from the playback state */
+        juce::int64 getPositionInSamples() const;
+        double getTrackSampleRate() const;
+        double getSpeed() const;
+
+        /** sets how many samples are decoded ahead of the playhead, takes effect on the next load */
+        void setReadAheadBufferSize(int numSamples);
+        int getReadAheadBufferSize() const;
+
+        /** underrun counters for this deck's read-ahead buffer */
+        const ReadAheadStats& getReadAheadStats() const;
+
+        /** how long each stage of the last successful load took */
+        TrackLoadTimings getLastLoadTimings() const;
+
+        /** the loaded track's beat grid, invalid until its analysis is done. Cleared by each new load */
+        void setBeatGrid(const BeatGrid& grid);
+        BeatGrid getBeatGrid() const;
+
+        //==============================================================================
+        // hot cues and loops. Jumps are made on the audio thread with a short crossfade,
+        // from buffers decoded when the cue or loop is set. All cleared by each new load
+
+        static constexpr int numHotCues = 8;
+
+        /** marks where the deck is as a hot cue, snapped to the nearest beat if there's a grid */
+        void setHotCue(int index);
+        void clearHotCue(int index);
+        bool isHotCueSet(int index) const;
+
+        /** jumps to a hot cue without a gap. Returns false if it isn't set */
+        bool jumpToHotCue(int index);
+
+        /** loops numBeats from the start of the beat, or fraction of a beat, the deck is in.
+            Returns false if there's no beat grid or the loop would run off the end */
+        bool setBeatLoop(double numBeats);
+        void exitLoop();
+        bool isLoopActive() const;
+
+        /** the length of the active loop in beats, or 0 */
+        double getLoopBeats() const;
+
+        //==============================================================================
+        // audio thread only, for DeckSync. These describe the deck as of the end of
+        // its last block
+
+        /** the playhead in samples of the track, fractional and counted from what
+            has actually been rendered rather than what has been read ahead */
+        double getPlayheadInSamples() const;
+
+        /** how far behind the playhead the deck's output is, in samples of the track. Only
+            key-lock adds any, as the stretcher's output runs behind what it's been fed */
+        double getOutputLatencyInSamples() const;
+
+        double getCurrentTrackSampleRate() const;
+        double getOutputSampleRate() const;
+        double getRenderedSpeed() const;
+        bool isRendering() const;
+        const BeatGrid& getRenderedBeatGrid() const;
+
+        /** plays at this speed instead of the tempo setting, or 0 to hand control back */
+        void setSyncSpeed(double newSpeed);
+
+        /** where the last block's time went: reading, stretching and resampling the track, then EQ and gain */
+        struct StageTimes
+        {
+            double resampleSeconds = 0.0;
+            double eqSeconds = 0.0;
+        };
+
+        StageTimes getLastStageTimes() const;
+
         bool trackLoaded = false;
         bool playing = false;
 
     private:
-        juce::AudioFormatManager& formatManager;
-        std::unique_ptr<juce::AudioFormatReaderSource> readerSource;
+        void setLoadedTrack(std::unique_ptr<LoadedTrack> track);
+        void renderSection(const juce::AudioSourceChannelInfo& section, double speed, double rateRatio);
+
+        juce::int64 snapToBeat(juce::int64 sample) const;
+        void decodeJumpBuffer(juce::int64 startSample, juce::int64 numSamples);
+        void addJumpBuffer(juce::int64 startSample, std::unique_ptr<juce::AudioBuffer<float>> samples);
+        bool isJumpBufferWanted(juce::int64 startSample) const;
+        void publishJumpPoints();
+
+        TrackLoader& trackLoader;
+        ReadAheadStats readAheadStats;
+        DeckTrackSource deckSource;
         juce::AudioTransportSource transportSource;
-        juce::ResamplingAudioSource resampleSource{&transportSource, false, 2};
+        TimeStretchSource timeStretchSource{ &transportSource };
+        juce::ResamplingAudioSource resampleSource{&timeStretchSource, false, 2};
 
         float lastSampleRate = 48000;
+
+        int readAheadBufferSize = 1 << 17; // ~2.7 seconds at 48kHz
+
+        int loadGeneration = 0; // lets us ignore loads that finish after a newer one was started
+        TrackLoadTimings lastLoadTimings;
+
+        // what the message thread knows about the loaded track
+        double trackSampleRate = 0.0;
+        juce::int64 trackLengthInSamples = 0;
+        BeatGrid beatGrid;
+        juce::URL loadedURL;
+
+        // hot cues and loop, in samples of the loaded track, -1 when unset
+        std::array<juce::int64, numHotCues> hotCues;
+        juce::int64 loopStart = -1;
+        juce::int64 loopEnd = -1;
+        juce::int64 exitedLoopStart = -1; // its buffer is kept, as the deck is probably still playing from it
+        double loopBeats = 0.0;
+
+        std::vector<std::shared_ptr<const JumpBuffer>> jumpBuffers;
+        bool decodeJumpBuffersNow = false; // for tracks from loadURLNow, where there's no message loop to hand them back on
+
+        static constexpr double hotCueBufferSeconds = 2.0;
+        static constexpr double maxLoopBufferSeconds = 16.0;
+
+        // the beat grid as the audio thread sees it
+        SeqLock<BeatGrid> publishedBeatGrid;
+        BeatGrid audioBeatGrid;
+
+        // audio thread state for sync
+        double playhead = 0.0;
+        double renderedSpeed = 1.0;
+        double syncSpeed = 0.0;
+        StageTimes lastStageTimes;
+
+        // targets written by the UI, glided towards on the audio thread
+        std::atomic<double> speedRatio{ 1.0 };
+        std::atomic<float> targetGain{ 1.0f };
+
+        juce::SmoothedValue<double> smoothedSpeed;
+        juce::SmoothedValue<float> smoothedGain;
+        static constexpr int speedSubBlockSize = 64;
+
+        std::atomic<bool> keyLockEnabled{ false };
+        std::atomic<int> keyLockQuality{ (int) TimeStretchSource::Quality::medium };
+        std::atomic<float> cpuLoad{ 0.0f };
         
         bool paused = false;
-        double positionAtPause = 0.0;
 
-        std::array<juce::IIRCoefficients, 2> highGainCoef;
-        std::array<juce::IIRFilter, 2> highGainControl;
+        SeqLock<PlaybackState> publishedState;
 
-        std::array<juce::IIRCoefficients, 2> midGainCoef;
-        std::array<juce::IIRFilter, 2> midGainControl;
+        ThreeBandEQ eq;
 
-        std::array<juce::IIRCoefficients, 2> lowGainCoef;
-        std::array<juce::IIRFilter, 2> lowGainControl;
+        // loads and decodes finish on the message thread, possibly after the deck has gone
+        JUCE_DECLARE_WEAK_REFERENCEABLE (DJAudioPlayer)
 
 };
\ No newline at end of file
@@ -15,29 +15,58 @@
 DeckGUI::DeckGUI(DJAudioPlayer* _player,
                 juce::AudioFormatManager& formatManagerToUse,
                 juce::AudioThumbnailCache& cacheToUse,
+                PeakStore& peakStore,
+                BeatAnalyser& _beatAnalyser,
+                DeckSync& _deckSync,
                 int deckNum)
                   : player(_player),
-                    waveformDisplay(formatManagerToUse, cacheToUse)
+                    beatAnalyser(_beatAnalyser),
+                    deckSync(_deckSync),
+                    waveformDisplay(formatManagerToUse, cacheToUse, peakStore),
+                    scrollingWaveform(*_player, peakStore)
 {
-    deckNumber = deckNum; // Deck 1 or Deck 2
+    deckNumber = deckNum; // odd decks sit on the left, even on the right
+    syncIndex = deckSync.addDeck(player);
     
     // Initialise and configure GUI components
     addAndMakeVisible(playButton);
     addAndMakeVisible(pauseButton);
     addAndMakeVisible(stopButton);
     addAndMakeVisible(loadButton);
+    addAndMakeVisible(keyLockButton);
+    addAndMakeVisible(syncButton);
     addAndMakeVisible(gainSlider);
     addAndMakeVisible(tempoDial);
     addAndMakeVisible(highGainDial);
     addAndMakeVisible(midGainDial);
     addAndMakeVisible(lowGainDial);
     addAndMakeVisible(waveformDisplay);
+    addAndMakeVisible(scrollingWaveform);
     addAndMakeVisible(posSlider);
  
     playButton.addListener(this);
     pauseButton.addListener(this);
     stopButton.addListener(this);
     loadButton.addListener(this);
+    keyLockButton.addListener(this);
+    syncButton.addListener(this);
+
+    for (size_t i = 0; i < hotCueButtons.size(); ++i)
+    {
+        hotCueButtons[i].setButtonText("CUE " + juce::String((int) i + 1));
+        hotCueButtons[i].setColour(juce::TextButton::buttonOnColourId, juce::Colours::orange);
+        hotCueButtons[i].addListener(this);
+        addAndMakeVisible(hotCueButtons[i]);
+    }
+
+    for (size_t i = 0; i < loopButtons.size(); ++i)
+    {
+        loopButtons[i].setButtonText("LOOP " + juce::String((int) loopLengths[i]));
+        loopButtons[i].setColour(juce::TextButton::buttonOnColourId, juce::Colours::green);
+        loopButtons[i].setTooltip("loops " + juce::String((int) loopLengths[i]) + " beats once the track has been analysed");
+        loopButtons[i].addListener(this);
+        addAndMakeVisible(loopButtons[i]);
+    }
 
     gainSlider.addListener(this);
     gainSlider.setRange(0.0, 1.0);
@@ -77,12 +106,15 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     lowGainDial.setValue(1.0f);
     lowGainDial.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::NoTextBox, false, 0, 0);
     
-    startTimer(500);
+    beatAnalyser.addListener(this);
+
+    startTimer(40); // the playback state is cheap to read, so the platter can turn smoothly
 }
 
 DeckGUI::~DeckGUI()
 {
     stopTimer();
+    beatAnalyser.removeListener(this);
 }
 
 void DeckGUI::paint (juce::Graphics& g)
@@ -102,7 +134,7 @@ void DeckGUI::paint (juce::Graphics& g)
     g.setFont (17.0f);
 
     // Draw Component labels
-    if (deckNumber == 1)
+    if (deckNumber % 2 == 1)
     {
         g.drawText("Gain",
             juce::Rectangle<float>(10.02 * rowW, rowH * 5.2, rowW * 2, rowH * 2),
@@ -154,7 +186,7 @@ void DeckGUI::paint (juce::Graphics& g)
     auto discCenter = juce::Rectangle< float >::Rectangle(2 * (rowW * 1.75), rowH * 2.25, rowW * 5, rowW * 5).getCentre();
     float diameter{ 130 };
     float radius{ diameter / 2 };
-    juce::Rectangle<float> discArea{ float(2 * (rowW * 1.75)), float(rowH * 2.25), float(rowW * 5), float(rowW * 5) };
+    juce::Rectangle<float> discArea = getDiscArea();
 
     g.drawEllipse(discArea, 5.0f);
     g.fillEllipse(discArea);
@@ -183,11 +215,20 @@ void DeckGUI::resized()
     loadButton.setBounds(rowW * 8.5, rowH * 6.75, rowW * 1.75, rowH / 1.5);
     posSlider.setBounds(0, 0, getWidth(), rowH*1.5);
     waveformDisplay.setBounds(0, 0, getWidth(), rowH*1.5);
+    scrollingWaveform.setBounds(0, rowH*1.5, getWidth(), rowH/2);
 
-    if (deckNumber == 1) // sets bounds for components if they differ between decks
+    for (size_t i = 0; i < hotCueButtons.size(); ++i)
+        hotCueButtons[i].setBounds(rowW * (0.5 + 1.4 * i), rowH * 7.5, rowW * 1.25, rowH / 2.2);
+
+    for (size_t i = 0; i < loopButtons.size(); ++i)
+        loopButtons[i].setBounds(rowW * (0.5 + 1.4 * (hotCueButtons.size() + i)), rowH * 7.5, rowW * 1.25, rowH / 2.2);
+
+    if (deckNumber % 2 == 1) // sets bounds for components if they differ between left and right decks
     {
         gainSlider.setBounds(getWidth()- rowW*1.5, rowH * 2, rowW, rowH * 4);
         tempoDial.setBounds(centreDeck + 3.25 * rowW, rowH * 2, dialWidth, rowH);
+        keyLockButton.setBounds(centreDeck + 5.5 * rowW, rowH * 3, rowW * 1.75, rowH / 2);
+        syncButton.setBounds(centreDeck + 5.5 * rowW, rowH * 3.5, rowW * 1.75, rowH / 2);
         highGainDial.setBounds(centreDeck - (4.25 * rowW), rowH * 2, dialWidth, rowH);
         midGainDial.setBounds(centreDeck - (4.25 * rowW), rowH * 3.5, dialWidth, rowH);
         lowGainDial.setBounds(centreDeck - (4.25 * rowW), rowH * 5, dialWidth, rowH);
@@ -196,6 +237,8 @@ void DeckGUI::resized()
     {
         gainSlider.setBounds(rowW/2, rowH * 2, rowW, rowH * 4);
         tempoDial.setBounds(centreDeck - 3.25 * rowW, rowH * 2, dialWidth, rowH);
+        keyLockButton.setBounds(centreDeck - 1.0 * rowW, rowH * 3, rowW * 1.75, rowH / 2);
+        syncButton.setBounds(centreDeck - 1.0 * rowW, rowH * 3.5, rowW * 1.75, rowH / 2);
         highGainDial.setBounds(rowW * 7.25, rowH * 2, dialWidth, rowH);
         midGainDial.setBounds(rowW * 7.25, rowH * 3.5, dialWidth, rowH);
         lowGainDial.setBounds(rowW * 7.25, rowH * 5, dialWidth, rowH);
@@ -259,15 +302,45 @@ void DeckGUI::buttonClicked(juce::Button* button)
     {
         player->stop();
     }
+    if (button == &keyLockButton) // tempo changes keep the track's pitch while this is on
+    {
+        player->setKeyLock(keyLockButton.getToggleState());
+    }
+    if (button == &syncButton) // locks this deck's tempo and beats to the other deck
+    {
+        deckSync.setSyncEnabled(syncIndex, syncButton.getToggleState());
+    }
+    for (size_t i = 0; i < hotCueButtons.size(); ++i)
+    {
+        if (button != &hotCueButtons[i])
+            continue;
+
+        if (juce::ModifierKeys::currentModifiers.isShiftDown())
+            player->clearHotCue((int) i);
+        else if (! player->jumpToHotCue((int) i))
+            player->setHotCue((int) i);
+
+        updateJumpButtons();
+    }
+    for (size_t i = 0; i < loopButtons.size(); ++i)
+    {
+        if (button != &loopButtons[i])
+            continue;
+
+        if (player->getLoopBeats() == loopLengths[i])
+            player->exitLoop();
+        else
+            player->setBeatLoop(loopLengths[i]);
+
+        updateJumpButtons();
+    }
     if (button == &loadButton)
     {
         auto fileChooserFlags = juce::FileBrowserComponent::canSelectFiles;
         fChooser.launchAsync(fileChooserFlags, [this](const juce::FileChooser& chooser)
             {
                 auto chosenFile = chooser.getResult();
-                player->loadURL(juce::URL{ chosenFile });
-                waveformDisplay.loadURL(juce::URL{ chosenFile });
-                notchAngleInRadians = 0;
+                loadTrack(juce::URL{ chosenFile });
             });
     }
 }
@@ -286,13 +359,11 @@ void DeckGUI::sliderValueChanged(juce::Slider* slider)
     {
         float playbackSpeed = slider->getValue(); // gets the value of the tempo slider
         player->setSpeed(playbackSpeed);
-        deckSpeed = player->tempoValue;
     }
 
     if (slider == &posSlider)
     {
-        if (player->checkIfPaused()) player->movePlayheadWhilePaused(slider->getValue());
-        player->setPositionRelative(slider->getValue()); // gets the value of the tempo slider
+        player->setPosition(slider->getValue()); // the slider's range is the track length in seconds
     }
 
     if (slider == &highGainDial) // pass the slider value to the setHighGain function
@@ -320,17 +391,75 @@ void DeckGUI::filesDropped(const juce::StringArray &files, int x, int y) // load
 {
     if (files.size() == 1)
     {
-        player->loadURL(juce::URL{ juce::File {files[0]} });
-        waveformDisplay.loadURL(juce::URL{ juce::File {files[0]} });
+        loadTrack(juce::URL{ juce::File {files[0]} });
     }
 }
 
+void DeckGUI::loadTrack(juce::URL audioURL) // the deck keeps playing its current track until the new one is ready
+{
+    player->loadURL(audioURL, [this, audioURL](bool loaded)
+    {
+        if (loaded)
+        {
+            waveformDisplay.loadURL(audioURL);
+            scrollingWaveform.loadURL(audioURL);
+            posSlider.setRange(0, player->getTrackLength());
+
+            // use the stored grid if there is one, otherwise it arrives in trackAnalysed
+            loadedFile = audioURL.getLocalFile();
+            updateJumpButtons();
+            BeatGrid grid;
+
+            if (beatAnalyser.getBeatGrid(loadedFile, grid))
+                player->setBeatGrid(grid);
+            else
+                beatAnalyser.analyse(loadedFile);
+        }
+    });
+}
+
 void DeckGUI::timerCallback() // updates waveform display playhead
 {
-    if (player->playing)
+    const auto state = player->getPlaybackState();
+
+    // the notch turns with the track like a record, so it follows seeks, loops and tempo changes
+    const auto turns = state.getSeconds() * platterRpm / 60.0;
+    const auto angle = (float) ((turns - std::floor(turns)) * juce::MathConstants<double>::twoPi);
+
+    if (angle != notchAngleInRadians)
     {
-        notchAngleInRadians >= 6.283 ? notchAngleInRadians = 2 * deckSpeed : notchAngleInRadians += deckSpeed;
-        repaint();
+        notchAngleInRadians = angle;
+        repaint(getDiscArea().expanded(20.0f).getSmallestIntegerContainer());
     }
-    waveformDisplay.setPositionRelative(player->getPositionRelative());
-}
\ No newline at end of file
+
+    waveformDisplay.setPositionRelative(state.getRelative());
+
+    // syncing the other deck can take this one off sync
+    syncButton.setToggleState(deckSync.isSyncEnabled(syncIndex), juce::dontSendNotification);
+
+    if (deckSync.isSyncEnabled(syncIndex))
+        syncButton.setTooltip("drift " + juce::String(deckSync.getDriftSamples(syncIndex), 2) + " samples");
+}
+
+juce::Rectangle<float> DeckGUI::getDiscArea() const
+{
+    const double rowH = getHeight() / 8;
+    const double rowW = getWidth() / 12;
+
+    return { float(2 * (rowW * 1.75)), float(rowH * 2.25), float(rowW * 5), float(rowW * 5) };
+}
+
+void DeckGUI::updateJumpButtons()
+{
+    for (size_t i = 0; i < hotCueButtons.size(); ++i)
+        hotCueButtons[i].setToggleState(player->isHotCueSet((int) i), juce::dontSendNotification);
+
+    for (size_t i = 0; i < loopButtons.size(); ++i)
+        loopButtons[i].setToggleState(player->getLoopBeats() == loopLengths[i], juce::dontSendNotification);
+}
+
+void DeckGUI::trackAnalysed(const juce::File& file, const BeatGrid& grid)
+{
+    if (file == loadedFile)
+        player->setBeatGrid(grid);
+}
@@ -11,9 +11,12 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
 #include <math.h>
 #include <numbers>
 #include "DJAudioPlayer.h"
+#include "DeckSync.h"
+#include "ScrollingWaveformDisplay.h"
 #include "WaveformDisplay.h"
 
 //==============================================================================
@@ -24,12 +27,16 @@ class DeckGUI  : public juce::Component,
                  public juce::Slider::Listener,
                  public juce::FileDragAndDropTarget,
                  public juce::Timer,
-                 public juce::LookAndFeel_V4          
+                 public juce::LookAndFeel_V4,
+                 public BeatAnalyser::Listener
 {
 public:
     DeckGUI(DJAudioPlayer* player,
             juce::AudioFormatManager& formatManagerToUse,
             juce::AudioThumbnailCache& cacheToUse,
+            PeakStore& peakStore,
+            BeatAnalyser& beatAnalyser,
+            DeckSync& deckSync,
             int deckNum);
 
     ~DeckGUI() override;
@@ -51,13 +58,34 @@ public:
 
     void filesDropped(const juce::StringArray &files, int x, int y) override;
 
+    /** loads a track on to this deck without blocking the message thread */
+    void loadTrack(juce::URL audioURL);
+
     void timerCallback() override;
 
+    /** hands the beat grid to the player if it's for the track on this deck */
+    void trackAnalysed(const juce::File& file, const BeatGrid& grid) override;
+
 private:
+    /** lights the hot cue and loop buttons that are set */
+    void updateJumpButtons();
+
+    juce::Rectangle<float> getDiscArea() const;
+
     juce::TextButton playButton{ "PLAY" };
     juce::TextButton pauseButton{ "PAUSE" };
     juce::TextButton stopButton{ "STOP" };
     juce::TextButton loadButton{ "LOAD" };
+    juce::ToggleButton keyLockButton{ "KEY LOCK" };
+    juce::ToggleButton syncButton{ "SYNC" };
+
+    // click an empty cue to set it and a set one to jump there, shift-click to clear
+    static constexpr int numHotCueButtons = 4;
+    std::array<juce::TextButton, numHotCueButtons> hotCueButtons;
+
+    // click again to leave the loop
+    static constexpr std::array<double, 4> loopLengths{ 1.0, 2.0, 4.0, 8.0 };
+    std::array<juce::TextButton, loopLengths.size()> loopButtons;
     
     juce::Slider gainSlider;
     juce::Slider posSlider;
@@ -67,13 +95,19 @@ private:
     juce::Slider lowGainDial;
 
     DJAudioPlayer* player;
+    BeatAnalyser& beatAnalyser;
+    juce::File loadedFile;
+
+    DeckSync& deckSync;
+    int syncIndex;
 
     WaveformDisplay waveformDisplay;
+    ScrollingWaveformDisplay scrollingWaveform;
 
     int deckNumber;
 
     float notchAngleInRadians = 0;
-    float deckSpeed = player->tempoValue;
+    static constexpr double platterRpm = 100.0 / 3.0;
 
     juce::FileChooser fChooser{ "Select a file..." };
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeckGUI);
@@ -0,0 +1,292 @@
+/*
+  ==============================================================================
+
+    DeckMixer.cpp
+    Created: 17 Oct 2026 9:24:48pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "DeckMixer.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <xmmintrin.h>
+#endif
+
+DeckMixer::DeckMixer(DeckRenderGroup* _renderGroup)
+                     : renderGroup(_renderGroup)
+{
+    for (auto& trim : trims)
+        trim.store(1.0f);
+}
+
+DeckMixer::~DeckMixer()
+{}
+
+int DeckMixer::addDeck(juce::AudioSource* deck, Side side)
+{
+    jassert(deck != nullptr);
+    const int count = numDecks.load();
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (decks[(size_t) i] == deck)
+        {
+            setSide(i, side);
+            return i;
+        }
+    }
+
+    if (count >= maxDecks)
+    {
+        jassertfalse; // raise maxDecks
+        return -1;
+    }
+
+    // a deck joining a running mix needs preparing before the audio thread can see it
+    if (blockSize.load() > 0)
+    {
+        deckBuffers[(size_t) count].setSize(2, blockSize.load());
+        deck->prepareToPlay(blockSize.load(), sampleRate.load());
+    }
+
+    decks[(size_t) count] = deck;
+    sides[(size_t) count].store((int) side);
+    trims[(size_t) count].store(1.0f);
+    numDecks.store(count + 1);
+
+    return count;
+}
+
+int DeckMixer::getNumDecks() const
+{
+    return numDecks.load();
+}
+
+void DeckMixer::setCrossfader(float position)
+{
+    crossfader.store(juce::jlimit(0.0f, 1.0f, position));
+}
+
+float DeckMixer::getCrossfader() const
+{
+    return crossfader.load();
+}
+
+void DeckMixer::setSide(int deckIndex, Side side)
+{
+    if (juce::isPositiveAndBelow(deckIndex, maxDecks))
+        sides[(size_t) deckIndex].store((int) side);
+}
+
+void DeckMixer::setTrim(int deckIndex, float gain)
+{
+    if (juce::isPositiveAndBelow(deckIndex, maxDecks))
+        trims[(size_t) deckIndex].store(juce::jmax(0.0f, gain));
+}
+
+float DeckMixer::getTrim(int deckIndex) const
+{
+    return juce::isPositiveAndBelow(deckIndex, maxDecks) ? trims[(size_t) deckIndex].load() : 0.0f;
+}
+
+float DeckMixer::getGainReductionDb() const
+{
+    return gainReductionDb.load();
+}
+
+int DeckMixer::getNumLateBlocks() const
+{
+    return numLateBlocks.load();
+}
+
+double DeckMixer::getLastMixSeconds() const
+{
+    return juce::Time::highResolutionTicksToSeconds(mixTicks);
+}
+
+void DeckMixer::prepareToPlay(int samplesPerBlockExpected, double newSampleRate)
+{
+    const int newBlockSize = juce::jmax(64, samplesPerBlockExpected);
+
+    limiterGain = 1.0f;
+
+    const int count = numDecks.load();
+
+    for (int i = 0; i < count; ++i)
+    {
+        deckBuffers[(size_t) i].setSize(2, newBlockSize, false, false, true);
+        decks[(size_t) i]->prepareToPlay(newBlockSize, newSampleRate);
+        currentGains[(size_t) i] = trims[(size_t) i].load() * getCrossfaderGain((Side) sides[(size_t) i].load(), crossfader.load());
+    }
+
+    sampleRate.store(newSampleRate);
+    blockSize.store(newBlockSize);
+}
+
+void DeckMixer::releaseResources()
+{
+    const int count = numDecks.load();
+
+    for (int i = 0; i < count; ++i)
+        decks[(size_t) i]->releaseResources();
+
+    blockSize.store(0);
+}
+
+void DeckMixer::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    const int maxSection = blockSize.load();
+
+    if (maxSection == 0)
+    {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    mixTicks = 0;
+
+    // the device can hand us bigger blocks than it promised, so mix those a deck buffer at a time
+    for (int done = 0; done < bufferToFill.numSamples; done += maxSection)
+    {
+        const int numThisTime = juce::jmin(maxSection, bufferToFill.numSamples - done);
+        mixSection(*bufferToFill.buffer, bufferToFill.startSample + done, numThisTime);
+
+        const auto limitTicks = juce::Time::getHighResolutionTicks();
+        limit(*bufferToFill.buffer, bufferToFill.startSample + done, numThisTime);
+        mixTicks += juce::Time::getHighResolutionTicks() - limitTicks;
+    }
+
+    const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+    if (elapsed * sampleRate.load() > bufferToFill.numSamples)
+        numLateBlocks.fetch_add(1);
+}
+
+float DeckMixer::getCrossfaderGain(Side side, float position) const
+{
+    const float angle = position * juce::MathConstants<float>::halfPi;
+
+    switch (side)
+    {
+        case Side::a:    return std::cos(angle);
+        case Side::b:    return std::sin(angle);
+        case Side::thru: return 1.0f;
+    }
+
+    return 1.0f;
+}
+
+void DeckMixer::mixSection(juce::AudioBuffer<float>& output, int startSample, int numSamples)
+{
+    const int numChannels = juce::jmin(2, output.getNumChannels());
+    const int count = numDecks.load();
+    const float position = crossfader.load();
+
+    output.clear(startSample, numSamples);
+
+    // every deck renders even when it's faded out, so it keeps its place in the track
+    sectionLength = numSamples;
+
+    if (renderGroup != nullptr)
+        renderGroup->perform(*this, count);
+    else
+        for (int i = 0; i < count; ++i)
+            perform(i);
+
+    const auto sumTicks = juce::Time::getHighResolutionTicks();
+    for (int i = 0; i < count; ++i)
+    {
+        const float startGain = currentGains[(size_t) i];
+        const float endGain = trims[(size_t) i].load() * getCrossfaderGain((Side) sides[(size_t) i].load(), position);
+
+        if (startGain != 0.0f || endGain != 0.0f)
+            for (int ch = 0; ch < numChannels; ++ch)
+                output.addFromWithRamp(ch, startSample, deckBuffers[(size_t) i].getReadPointer(ch), numSamples, startGain, endGain);
+
+        currentGains[(size_t) i] = endGain;
+    }
+
+    mixTicks += juce::Time::getHighResolutionTicks() - sumTicks;
+}
+
+void DeckMixer::perform(int deckIndex)
+{
+    // runs on whichever thread claimed the deck, and only touches that deck and its buffer
+    auto& buffer = deckBuffers[(size_t) deckIndex];
+    buffer.clear(0, sectionLength);
+    decks[(size_t) deckIndex]->getNextAudioBlock(juce::AudioSourceChannelInfo(&buffer, 0, sectionLength));
+}
+
+void DeckMixer::limit(juce::AudioBuffer<float>& output, int startSample, int numSamples)
+{
+    const int numChannels = juce::jmin(2, output.getNumChannels());
+    float peak = 0.0f;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(output.getReadPointer(ch, startSample), numSamples);
+        peak = juce::jmax(peak, -range.getStart(), range.getEnd());
+    }
+
+    // pull straight down to whatever keeps this block's peak under the ceiling, then let go slowly
+    const float needed = peak > ceiling ? ceiling / peak : 1.0f;
+    const float release = (float) std::exp(-numSamples / (releaseSeconds * sampleRate.load()));
+    const float newGain = juce::jmin(needed, 1.0f - (1.0f - limiterGain) * release);
+
+    const float startGain = limiterGain;
+
+    if (startGain != 1.0f || newGain != 1.0f)
+        for (int ch = 0; ch < numChannels; ++ch)
+            output.applyGainRamp(ch, startSample, numSamples, startGain, newGain);
+
+    limiterGain = newGain;
+    gainReductionDb.store(juce::Decibels::gainToDecibels(newGain));
+
+    // the gain ramps in over the block, so catch anything that gets ahead of it
+    if (peak * juce::jmax(startGain, newGain) > ceiling)
+        for (int ch = 0; ch < numChannels; ++ch)
+            softClip(output.getWritePointer(ch, startSample), numSamples);
+}
+
+void DeckMixer::softClip(float* data, int numSamples)
+{
+    // above the ceiling, the level follows ceiling + range * u / (1 + u), which leaves the ceiling
+    // with a slope of 1 and never quite reaches full scale
+    constexpr float range = 1.0f - ceiling;
+    int i = 0;
+
+   #if JUCE_USE_SSE_INTRINSICS
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 kneeV = _mm_set1_ps(ceiling);
+    const __m128 rangeV = _mm_set1_ps(range);
+    const __m128 invRangeV = _mm_set1_ps(1.0f / range);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        const __m128 x = _mm_loadu_ps(data + i);
+        const __m128 sign = _mm_and_ps(x, signMask);
+        const __m128 level = _mm_andnot_ps(signMask, x);
+
+        const __m128 u = _mm_mul_ps(_mm_max_ps(_mm_sub_ps(level, kneeV), zero), invRangeV);
+        const __m128 shaped = _mm_add_ps(_mm_min_ps(level, kneeV), _mm_mul_ps(rangeV, _mm_div_ps(u, _mm_add_ps(one, u))));
+
+        _mm_storeu_ps(data + i, _mm_or_ps(shaped, sign));
+    }
+   #endif
+
+    for (; i < numSamples; ++i)
+    {
+        const float level = std::abs(data[i]);
+
+        if (level > ceiling)
+        {
+            const float u = (level - ceiling) / range;
+            data[i] = std::copysign(ceiling + range * u / (1.0f + u), data[i]);
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    DeckMixer.h
+    Created: 17 Oct 2026 9:24:48pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "DeckRenderGroup.h"
+
+//==============================================================================
+/*
+    Mixes the decks to the master bus, in place of juce::MixerAudioSource.
+
+    Nothing here locks or allocates on the audio thread. Decks go in a fixed
+    array and are published by bumping an atomic count, the settings are
+    atomics the audio thread reads once a block, and each deck's buffer is
+    sized in prepareToPlay. Blocks bigger than that are mixed in pieces.
+
+    Given a DeckRenderGroup, the decks render into their buffers in parallel
+    and are summed once they're all done.
+
+    Each deck has a trim and a side of the crossfader. The crossfader uses a
+    constant-power curve, so the mix doesn't dip in the middle. Gain changes
+    are ramped across a block.
+
+    The master bus goes through a limiter: a block-rate gain that pulls the
+    peak down to the ceiling and recovers slowly, followed by a SIMD soft clip
+    that rounds off whatever gets past it before it reaches full scale.
+*/
+class DeckMixer : public juce::AudioSource,
+                  private DeckRenderGroup::Job
+{
+public:
+    static constexpr int maxDecks = 8;
+
+    enum class Side { a = 0, b, thru };
+
+    static constexpr float ceiling = 0.89f;          // -1 dBFS, where limiting starts
+    static constexpr double releaseSeconds = 0.25;
+
+    /** renders the decks one after another unless it's given a group to share them out across */
+    explicit DeckMixer(DeckRenderGroup* renderGroup = nullptr);
+    ~DeckMixer() override;
+
+    /** message thread. Adding a deck that's already in the mix just updates its side,
+        so it's safe to call again whenever the device restarts. Returns the deck's index */
+    int addDeck(juce::AudioSource* deck, Side side);
+    int getNumDecks() const;
+
+    /** 0 is all the way to side A, 1 all the way to side B */
+    void setCrossfader(float position);
+    float getCrossfader() const;
+
+    void setSide(int deckIndex, Side side);
+
+    /** linear gain applied to a deck before the crossfader */
+    void setTrim(int deckIndex, float gain);
+    float getTrim(int deckIndex) const;
+
+    /** how far the limiter is pulling the master down, in dB */
+    float getGainReductionDb() const;
+
+    /** blocks that took longer to mix than they last for */
+    int getNumLateBlocks() const;
+
+    /** audio thread: time the last block spent summing and limiting, not counting the decks' own rendering */
+    double getLastMixSeconds() const;
+
+    //==============================================================================
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    /** soft clips a buffer in place, leaving anything below the ceiling alone */
+    static void softClip(float* data, int numSamples);
+
+private:
+    void perform(int deckIndex) override;
+    void mixSection(juce::AudioBuffer<float>& output, int startSample, int numSamples);
+    void limit(juce::AudioBuffer<float>& output, int startSample, int numSamples);
+    float getCrossfaderGain(Side side, float position) const;
+
+    std::array<juce::AudioSource*, maxDecks> decks{};
+    std::atomic<int> numDecks{ 0 };
+
+    std::array<std::atomic<int>, maxDecks> sides{};
+    std::array<std::atomic<float>, maxDecks> trims{};
+    std::atomic<float> crossfader{ 0.5f };
+
+    // audio thread only
+    std::array<float, maxDecks> currentGains{};
+    float limiterGain = 1.0f;
+
+    std::atomic<float> gainReductionDb{ 0.0f };
+    std::atomic<int> numLateBlocks{ 0 };
+
+    DeckRenderGroup* renderGroup;
+    std::array<juce::AudioBuffer<float>, maxDecks> deckBuffers;
+    int sectionLength = 0;
+    juce::int64 mixTicks = 0;
+
+    // what the decks were last prepared with, so decks added later can be prepared to match
+    std::atomic<int> blockSize{ 0 };
+    std::atomic<double> sampleRate{ 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckMixer)
+};
@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+    DeckRenderGroup.cpp
+    Created: 17 Oct 2026 9:58:13pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "DeckRenderGroup.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <xmmintrin.h>
+#endif
+
+namespace
+{
+    void pause()
+    {
+       #if JUCE_USE_SSE_INTRINSICS
+        _mm_pause();
+       #else
+        std::this_thread::yield();
+       #endif
+    }
+
+    int getNumTasks(std::uint64_t word)  { return (int) ((word >> 16) & 0xffff); }
+    int getNextTask(std::uint64_t word)  { return (int) (word & 0xffff); }
+}
+
+//==============================================================================
+class DeckRenderGroup::Worker : public juce::Thread
+{
+public:
+    Worker(DeckRenderGroup& _group, int index)
+        : juce::Thread("Deck render " + juce::String(index)),
+          group(_group)
+    {}
+
+    ~Worker() override
+    {
+        signalThreadShouldExit();
+        wakeUp.signal();
+        stopThread(1000);
+    }
+
+    /** audio thread: wakes the worker if it's gone to sleep */
+    void wakeIfSleeping()
+    {
+        if (sleeping.load())
+            wakeUp.signal();
+    }
+
+    void run() override
+    {
+        int idleSpins = 0;
+
+        while (! threadShouldExit())
+        {
+            if (group.performNextTask())
+            {
+                idleSpins = 0;
+            }
+            else if (++idleSpins < spinsBeforeSleeping)
+            {
+                pause();
+            }
+            else
+            {
+                // say we're asleep before the last look for work, so a job published
+                // in between is sure to signal us
+                sleeping.store(true);
+
+                if (! group.hasWork())
+                    wakeUp.wait(100);
+
+                sleeping.store(false);
+                idleSpins = 0;
+            }
+        }
+    }
+
+private:
+    static constexpr int spinsBeforeSleeping = 4000; // tens of microseconds
+
+    DeckRenderGroup& group;
+    juce::WaitableEvent wakeUp;
+    std::atomic<bool> sleeping{ false };
+};
+
+//==============================================================================
+int DeckRenderGroup::getDefaultNumWorkers()
+{
+    // leave a core for the message thread and one for read-ahead
+    const int spareCores = juce::SystemStats::getNumCpus() - 3;
+    return juce::jlimit(0, maxWorkers, spareCores);
+}
+
+DeckRenderGroup::DeckRenderGroup(int numWorkers)
+{
+    for (int i = 0; i < juce::jlimit(0, maxWorkers, numWorkers); ++i)
+    {
+        auto* worker = workers.add(new Worker(*this, i));
+
+        if (! worker->startRealtimeThread(juce::Thread::RealtimeOptions{}))
+            worker->startThread(juce::Thread::Priority::highest);
+    }
+}
+
+DeckRenderGroup::~DeckRenderGroup()
+{
+    workers.clear();
+}
+
+int DeckRenderGroup::getNumWorkers() const
+{
+    return workers.size();
+}
+
+void DeckRenderGroup::perform(Job& job, int numTasks)
+{
+    jassert(numTasks <= maxTasks);
+
+    if (numTasks <= 0)
+        return;
+
+    if (workers.isEmpty() || numTasks == 1)
+    {
+        for (int i = 0; i < numTasks; ++i)
+            job.perform(i);
+
+        return;
+    }
+
+    currentJob.store(&job, std::memory_order_relaxed);
+    remaining.store(numTasks, std::memory_order_relaxed);
+
+    // seq_cst, like the worker's store to sleeping and its look in hasWork(): either we see it
+    // asleep and signal it, or its look sees this job - a release store would allow neither
+    const auto generation = (work.load(std::memory_order_relaxed) >> 32) + 1;
+    work.store((generation << 32) | ((std::uint64_t) numTasks << 16), std::memory_order_seq_cst);
+
+    for (auto* worker : workers)
+        worker->wakeIfSleeping();
+
+    // take tasks alongside the workers, then wait for any they're still running
+    while (performNextTask())
+    {}
+
+    while (remaining.load(std::memory_order_acquire) > 0)
+        pause();
+}
+
+bool DeckRenderGroup::hasWork() const
+{
+    // seq_cst to pair with the store in perform() - see there
+    const auto word = work.load(std::memory_order_seq_cst);
+    return getNextTask(word) < getNumTasks(word);
+}
+
+bool DeckRenderGroup::performNextTask()
+{
+    auto word = work.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        if (getNextTask(word) >= getNumTasks(word))
+            return false;
+
+        // the generation is part of the word, so a stale claim on a finished job always fails
+        if (work.compare_exchange_weak(word, word + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            break;
+    }
+
+    // the job can't change until this task is counted as done
+    currentJob.load(std::memory_order_relaxed)->perform(getNextTask(word));
+    remaining.fetch_sub(1, std::memory_order_release);
+
+    return true;
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    DeckRenderGroup.h
+    Created: 17 Oct 2026 9:58:13pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstdint>
+
+//==============================================================================
+/*
+    A few realtime worker threads that the audio callback hands deck renders
+    to, so on a many-core machine each deck decodes, resamples and EQs on its
+    own core and the callback only waits for the slowest one.
+
+    Handing out work never locks or allocates. A job is published as one
+    atomic word holding a generation, a task count and the next task, and
+    whoever claims a task with a compare-and-swap runs it, the audio thread
+    included. So if the workers are slow to wake the callback just does the
+    work itself, and it only ever waits for tasks that are already running.
+
+    Idle workers spin for a moment, since the next callback is usually close,
+    then sleep until they're woken. The audio thread only signals workers that
+    are actually asleep.
+*/
+class DeckRenderGroup
+{
+public:
+    struct Job
+    {
+        virtual ~Job() = default;
+
+        /** called once for each task index, on any of the threads */
+        virtual void perform(int taskIndex) = 0;
+    };
+
+    static constexpr int maxWorkers = 7;
+    static constexpr int maxTasks = 0xffff;
+
+    /** one worker per spare core, none on machines where the decks won't benefit */
+    static int getDefaultNumWorkers();
+
+    explicit DeckRenderGroup(int numWorkers = getDefaultNumWorkers());
+    ~DeckRenderGroup();
+
+    int getNumWorkers() const;
+
+    /** audio thread: runs every task of a job, returning once they've all finished */
+    void perform(Job& job, int numTasks);
+
+private:
+    class Worker;
+
+    bool performNextTask();
+    bool hasWork() const;
+
+    juce::OwnedArray<Worker> workers;
+
+    // generation << 32 | numTasks << 16 | next task
+    std::atomic<std::uint64_t> work{ 0 };
+    std::atomic<Job*> currentJob{ nullptr };
+    std::atomic<int> remaining{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckRenderGroup)
+};
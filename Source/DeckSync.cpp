@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    DeckSync.cpp
+    Created: 17 Oct 2026 8:52:10pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "DeckSync.h"
+
+DeckSync::DeckSync()
+{}
+
+DeckSync::~DeckSync()
+{}
+
+int DeckSync::addDeck(DJAudioPlayer* player)
+{
+    const int count = numDecks.load();
+
+    for (int i = 0; i < count; ++i)
+        if (decks[(size_t) i] == player)
+            return i;
+
+    if (count >= maxDecks)
+    {
+        jassertfalse; // raise maxDecks
+        return -1;
+    }
+
+    decks[(size_t) count] = player;
+    numDecks.store(count + 1); // the audio thread only looks at decks below this
+    return count;
+}
+
+int DeckSync::getNumDecks() const
+{
+    return numDecks.load();
+}
+
+void DeckSync::setLeader(int deckIndex)
+{
+    if (juce::isPositiveAndBelow(deckIndex, numDecks.load()))
+    {
+        syncEnabled[(size_t) deckIndex].store(false);
+        leader.store(deckIndex);
+    }
+}
+
+int DeckSync::getLeader() const
+{
+    return leader.load();
+}
+
+void DeckSync::setSyncEnabled(int deckIndex, bool shouldSync)
+{
+    const int count = numDecks.load();
+
+    if (! juce::isPositiveAndBelow(deckIndex, count))
+        return;
+
+    syncEnabled[(size_t) deckIndex].store(shouldSync);
+
+    // a deck can't follow itself, so hand the lead to another deck
+    if (shouldSync && leader.load() == deckIndex)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (i != deckIndex)
+            {
+                setLeader(i);
+                break;
+            }
+        }
+    }
+}
+
+bool DeckSync::isSyncEnabled(int deckIndex) const
+{
+    return juce::isPositiveAndBelow(deckIndex, numDecks.load())
+        && deckIndex != leader.load()
+        && syncEnabled[(size_t) deckIndex].load();
+}
+
+float DeckSync::getDriftSamples(int deckIndex) const
+{
+    return juce::isPositiveAndBelow(deckIndex, maxDecks) ? driftSamples[(size_t) deckIndex].load() : 0.0f;
+}
+
+bool DeckSync::isLocked(int deckIndex) const
+{
+    return juce::isPositiveAndBelow(deckIndex, maxDecks) && locked[(size_t) deckIndex].load();
+}
+
+float DeckSync::getMaxDriftSinceLock(int deckIndex) const
+{
+    return juce::isPositiveAndBelow(deckIndex, maxDecks) ? maxDriftSinceLock[(size_t) deckIndex].load() : 0.0f;
+}
+
+void DeckSync::process(int numSamples)
+{
+    const int count = numDecks.load();
+    const int leaderIndex = leader.load();
+
+    if (! juce::isPositiveAndBelow(leaderIndex, count) || numSamples <= 0)
+        return;
+
+    const auto& lead = *decks[(size_t) leaderIndex];
+    const auto& leadGrid = lead.getRenderedBeatGrid();
+    const double leadRate = lead.getCurrentTrackSampleRate();
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto& deck = *decks[(size_t) i];
+        auto& state = followers[(size_t) i];
+        const bool syncing = i != leaderIndex && syncEnabled[(size_t) i].load();
+
+        if (! syncing || ! leadGrid.isValid() || ! deck.getRenderedBeatGrid().isValid()
+            || leadRate <= 0 || deck.getCurrentTrackSampleRate() <= 0)
+        {
+            if (wasSyncing[(size_t) i])
+                deck.setSyncSpeed(0.0); // the deck's own tempo setting takes over again
+
+            wasSyncing[(size_t) i] = false;
+            state = {};
+            driftSamples[(size_t) i].store(0.0f);
+            locked[(size_t) i].store(false);
+            continue;
+        }
+
+        wasSyncing[(size_t) i] = true;
+
+        const auto& grid = deck.getRenderedBeatGrid();
+        const double leadSpeed = lead.getRenderedSpeed();
+
+        // play the follower's beats at the rate the leader's are coming out
+        const double matchedSpeed = leadSpeed * leadGrid.bpm / grid.bpm;
+        double nudge = 0.0;
+
+        if (lead.isRendering() && deck.isRendering())
+        {
+            // beat phase difference as heard, so a key-locked deck's stretcher latency comes off its playhead,
+            // wrapped to the nearest beat
+            const double playhead = deck.getPlayheadInSamples() - deck.getOutputLatencyInSamples();
+            const double leadPlayhead = lead.getPlayheadInSamples() - lead.getOutputLatencyInSamples();
+
+            double phase = grid.getBeatPosition(playhead / deck.getCurrentTrackSampleRate())
+                         - leadGrid.getBeatPosition(leadPlayhead / leadRate);
+            phase -= std::round(phase);
+
+            // as real time at the leader's tempo
+            const double error = phase * leadGrid.getBeatLengthSeconds() / leadSpeed;
+            const double blockSeconds = numSamples / deck.getOutputSampleRate();
+
+            // nudging can only move the error so far in a block, any more means one of the decks jumped
+            const bool jumped = std::abs(error - state.lastError) > 0.01;
+
+            if (! state.wasTracking || jumped)
+            {
+                state.integral = 0.0;
+                locked[(size_t) i].store(false);
+                maxDriftSinceLock[(size_t) i].store(0.0f);
+            }
+
+            // only integrate near lock and while the nudge isn't limited, so the integral can't wind up
+            if (std::abs(error) < integralWindowSeconds)
+            {
+                const double integral = state.integral + error * blockSeconds;
+
+                if (std::abs(error / proportionalSeconds + integral / (integralSeconds * integralSeconds)) < maxNudge)
+                    state.integral = integral;
+            }
+
+            nudge = -(error / proportionalSeconds + state.integral / (integralSeconds * integralSeconds));
+
+            nudge = juce::jlimit(-maxNudge, maxNudge, nudge);
+
+            state.lastError = error;
+            state.wasTracking = true;
+
+            const float drift = (float) (error * deck.getOutputSampleRate());
+            driftSamples[(size_t) i].store(drift);
+
+            if (std::abs(error) < lockThresholdSeconds)
+                locked[(size_t) i].store(true);
+
+            if (locked[(size_t) i].load())
+                maxDriftSinceLock[(size_t) i].store(juce::jmax(maxDriftSinceLock[(size_t) i].load(), std::abs(drift)));
+        }
+        else
+        {
+            state.wasTracking = false;
+        }
+
+        deck.setSyncSpeed(matchedSpeed * (1.0 + nudge));
+    }
+}
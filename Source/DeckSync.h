@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    DeckSync.h
+    Created: 17 Oct 2026 8:52:10pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "DJAudioPlayer.h"
+
+//==============================================================================
+/*
+    Locks decks to a leader deck's tempo and beat phase.
+
+    Runs on the audio thread, once per block before the decks render. Each
+    following deck plays at the leader's speed scaled by the ratio of their
+    BPMs, so their beats come round at the same rate, plus a small nudge from
+    a PI controller that pulls the follower's beat phase onto the leader's.
+
+    Phase is measured from each deck's fractional playhead and beat grid, so
+    it's exact to well under a sample rather than to the nearest block. A
+    key-locked deck's playhead is taken back by its stretcher's latency first,
+    so it's the beats that are heard that line up. How far the follower is
+    off, in output samples, is published for the UI and for checking that
+    lock holds over a whole track.
+
+    Decks are registered before playback starts. Sync can then be switched on
+    and off from the message thread at any time.
+*/
+class DeckSync
+{
+public:
+    static constexpr int maxDecks = 8;
+
+    // the follower's phase error is nudged out with a half second time constant, and never by more than 4% speed.
+    // The integral only runs close to lock, so pulling in from a long way off doesn't overshoot
+    static constexpr double proportionalSeconds = 0.5;
+    static constexpr double integralSeconds = 2.0;
+    static constexpr double integralWindowSeconds = 0.005;
+    static constexpr double maxNudge = 0.04;
+
+    // a follower counts as locked once it's within a millisecond of the leader
+    static constexpr double lockThresholdSeconds = 0.001;
+
+    DeckSync();
+    ~DeckSync();
+
+    /** message thread, before playback starts. Returns the deck's index */
+    int addDeck(DJAudioPlayer* player);
+    int getNumDecks() const;
+
+    //==============================================================================
+    /** message thread: the deck the others follow */
+    void setLeader(int deckIndex);
+    int getLeader() const;
+
+    /** message thread: makes a deck follow the leader. If it was the leader, another deck takes over */
+    void setSyncEnabled(int deckIndex, bool shouldSync);
+    bool isSyncEnabled(int deckIndex) const;
+
+    /** how far a follower's beats are from the leader's, in output samples. Positive means ahead */
+    float getDriftSamples(int deckIndex) const;
+
+    /** whether a follower has pulled in, and the worst drift it's had since it did */
+    bool isLocked(int deckIndex) const;
+    float getMaxDriftSinceLock(int deckIndex) const;
+
+    //==============================================================================
+    /** audio thread: sets each follower's speed for the next block */
+    void process(int numSamples);
+
+private:
+    struct Follower
+    {
+        double integral = 0.0;      // seconds x seconds of phase error
+        double lastError = 0.0;
+        bool wasTracking = false;
+    };
+
+    std::array<DJAudioPlayer*, maxDecks> decks{};
+    std::atomic<int> numDecks{ 0 };
+
+    std::atomic<int> leader{ 0 };
+    std::array<std::atomic<bool>, maxDecks> syncEnabled{};
+
+    // audio thread only
+    std::array<Follower, maxDecks> followers{};
+    std::array<bool, maxDecks> wasSyncing{};
+
+    std::array<std::atomic<float>, maxDecks> driftSamples{};
+    std::array<std::atomic<float>, maxDecks> maxDriftSinceLock{};
+    std::array<std::atomic<bool>, maxDecks> locked{};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckSync)
+};
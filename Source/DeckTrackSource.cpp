@@ -0,0 +1,406 @@
+/*
+  ==============================================================================
+
+    DeckTrackSource.cpp
+    Created: 17 Oct 2026 11:32:20am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "DeckTrackSource.h"
+
+const JumpBuffer* JumpPoints::findBuffer(juce::int64 position) const
+{
+    for (auto& buffer : buffers)
+        if (position >= buffer->startSample && position < buffer->getEndSample())
+            return buffer.get();
+
+    return nullptr;
+}
+
+//==============================================================================
+DeckTrackSource::DeckTrackSource()
+{}
+
+DeckTrackSource::~DeckTrackSource()
+{
+    stopTimer();
+    collectRetiredTracks();
+    collectRetiredJumpPoints();
+    delete pendingTrack.exchange(nullptr);
+    delete currentTrack;
+    delete pendingJumpPoints.exchange(nullptr);
+    delete currentJumpPoints;
+}
+
+void DeckTrackSource::setTrack(std::unique_ptr<LoadedTrack> newTrack)
+{
+    collectRetiredTracks();
+
+    // jump points made for the old track don't apply to this one. Nor do queued seeks, which
+    // the audio thread drops when it sees they're tagged with the old track
+    delete pendingJumpPoints.exchange(nullptr);
+
+    if (newTrack != nullptr)
+    {
+        newTrack->deckSerial = ++lastTrackSerial;
+        lastTrackLength = newTrack->lengthInSamples;
+    }
+
+    // if the audio thread never picked up the previous track, it's ours to delete
+    delete pendingTrack.exchange(newTrack.release());
+
+    startTimer(250);
+}
+
+void DeckTrackSource::collectRetiredTracks()
+{
+    const auto scope = retiredFifo.read(retiredFifo.getNumReady());
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        delete retiredTracks[(size_t) (scope.startIndex1 + i)];
+
+    for (int i = 0; i < scope.blockSize2; ++i)
+        delete retiredTracks[(size_t) (scope.startIndex2 + i)];
+}
+
+void DeckTrackSource::setJumpPoints(std::unique_ptr<JumpPoints> newPoints)
+{
+    collectRetiredJumpPoints();
+
+    if (newPoints != nullptr)
+        newPoints->trackSerial = lastTrackSerial;
+
+    delete pendingJumpPoints.exchange(newPoints.release());
+
+    startTimer(250);
+}
+
+bool DeckTrackSource::jumpTo(juce::int64 newPosition)
+{
+    return pushCommand(PositionCommand::Type::jump, newPosition);
+}
+
+bool DeckTrackSource::pushCommand(PositionCommand::Type type, juce::int64 newPosition)
+{
+    if (lastTrackSerial == 0 || commandFifo.getFreeSpace() == 0)
+        return false;
+
+    const auto scope = commandFifo.write(1);
+    auto& command = positionCommands[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)];
+    command.type = type;
+    command.position = juce::jlimit((juce::int64) 0, lastTrackLength, newPosition);
+    command.trackSerial = lastTrackSerial;
+    return true;
+}
+
+void DeckTrackSource::collectRetiredJumpPoints()
+{
+    const auto scope = retiredJumpPointsFifo.read(retiredJumpPointsFifo.getNumReady());
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        delete retiredJumpPoints[(size_t) (scope.startIndex1 + i)];
+
+    for (int i = 0; i < scope.blockSize2; ++i)
+        delete retiredJumpPoints[(size_t) (scope.startIndex2 + i)];
+}
+
+void DeckTrackSource::timerCallback()
+{
+    collectRetiredTracks();
+    collectRetiredJumpPoints();
+
+    if (pendingTrack.load() == nullptr && retiredFifo.getNumReady() == 0
+        && pendingJumpPoints.load() == nullptr && retiredJumpPointsFifo.getNumReady() == 0)
+        stopTimer();
+}
+
+DeckTrackSource::Update DeckTrackSource::updateFromAudioThread(bool isPlaying)
+{
+    Update update;
+
+    // only take the new track if there's room to hand the old one and its jump points back
+    if (pendingTrack.load() != nullptr && retiredFifo.getFreeSpace() > 0 && retiredJumpPointsFifo.getFreeSpace() > 0)
+    {
+        if (auto* newTrack = pendingTrack.exchange(nullptr))
+        {
+            if (currentTrack != nullptr)
+            {
+                const auto scope = retiredFifo.write(1);
+                retiredTracks[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)] = currentTrack;
+            }
+
+            retireJumpPoints(currentJumpPoints);
+            currentJumpPoints = nullptr;
+
+            currentTrack = newTrack;
+            totalLength.store(currentTrack->lengthInSamples);
+            playPosition = currentTrack->source->getNextReadPosition();
+            playingBuffer = nullptr;
+            fadeRemaining = 0;
+            position.store(playPosition);
+            update.trackChanged = true;
+        }
+    }
+
+    // the message thread deletes points that are still pending, so they're taken before being looked at
+    if (pendingJumpPoints.load() != nullptr && retiredJumpPointsFifo.getFreeSpace() > 0)
+        if (auto* newPoints = pendingJumpPoints.exchange(nullptr))
+            installJumpPoints(newPoints);
+
+    applyCommands(isPlaying, update);
+
+    position.store(playPosition);
+    return update;
+}
+
+juce::uint64 DeckTrackSource::getCurrentTrackSerial() const
+{
+    return currentTrack != nullptr ? currentTrack->deckSerial : 0;
+}
+
+void DeckTrackSource::installJumpPoints(JumpPoints* newPoints)
+{
+    if (newPoints->trackSerial < getCurrentTrackSerial())
+    {
+        retireJumpPoints(newPoints); // for a track that's been replaced
+        return;
+    }
+
+    if (newPoints->trackSerial > getCurrentTrackSerial())
+    {
+        // made for a track that hasn't reached us yet, so they go back to wait for it. If newer
+        // points have been published since, these are out of date anyway
+        JumpPoints* expected = nullptr;
+
+        if (! pendingJumpPoints.compare_exchange_strong(expected, newPoints))
+            retireJumpPoints(newPoints);
+
+        return;
+    }
+
+    retireJumpPoints(currentJumpPoints);
+    currentJumpPoints = newPoints;
+
+    // carry on through the same buffer if it's still there, or any other that holds the playhead
+    if (playingBuffer != nullptr)
+    {
+        const JumpBuffer* stillPlaying = nullptr;
+
+        for (auto& buffer : currentJumpPoints->buffers)
+            if (buffer.get() == playingBuffer)
+                stillPlaying = playingBuffer;
+
+        playingBuffer = stillPlaying != nullptr ? stillPlaying : currentJumpPoints->findBuffer(playPosition);
+    }
+}
+
+void DeckTrackSource::retireJumpPoints(JumpPoints* points)
+{
+    if (points == nullptr)
+        return;
+
+    // callers check there's room first
+    const auto scope = retiredJumpPointsFifo.write(1);
+    retiredJumpPoints[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)] = points;
+}
+
+void DeckTrackSource::applyCommands(bool isPlaying, Update& update)
+{
+    int start1, size1, start2, size2;
+    commandFifo.prepareToRead(commandFifo.getNumReady(), start1, size1, start2, size2);
+
+    int numRead = 0;
+
+    for (; numRead < size1 + size2; ++numRead)
+    {
+        const auto& command = positionCommands[(size_t) (numRead < size1 ? start1 + numRead : start2 + numRead - size1)];
+
+        // made for a track we haven't taken yet, so it waits for it
+        if (command.trackSerial > getCurrentTrackSerial())
+            break;
+
+        // made for a track that's since been replaced
+        if (command.trackSerial < getCurrentTrackSerial())
+            continue;
+
+        if (command.type == PositionCommand::Type::jump && isPlaying)
+        {
+            jumpFromAudioThread(command.position, true);
+        }
+        else
+        {
+            // a jump with nothing sounding to fade from is just a seek that can use the jump buffers
+            moveTo(command.position);
+            fadeRemaining = 0;
+            update.seeked = true;
+        }
+    }
+
+    commandFifo.finishedRead(numRead);
+}
+
+juce::int64 DeckTrackSource::takeJumpDistance()
+{
+    const auto distance = jumpDistance;
+    jumpDistance = 0;
+    return distance;
+}
+
+double DeckTrackSource::getCurrentSampleRate() const
+{
+    return currentTrack != nullptr ? currentTrack->sampleRate : 0.0;
+}
+
+void DeckTrackSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    fadeBuffer.setSize(2, crossfadeSamples);
+    fadeRemaining = 0;
+}
+
+void DeckTrackSource::releaseResources()
+{}
+
+void DeckTrackSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    if (currentTrack == nullptr)
+    {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+
+    auto& dest = *bufferToFill.buffer;
+    int start = bufferToFill.startSample;
+    int remaining = bufferToFill.numSamples;
+
+    while (remaining > 0)
+    {
+        // a block that crosses the loop end is split there, so the loop is sample accurate
+        const bool inLoop = currentJumpPoints != nullptr && currentJumpPoints->isLoopActive()
+                            && playPosition >= currentJumpPoints->loopStart && playPosition < currentJumpPoints->loopEnd;
+
+        const int numThisTime = inLoop ? (int) juce::jmin((juce::int64) remaining, currentJumpPoints->loopEnd - playPosition)
+                                       : remaining;
+
+        readTrack(dest, start, numThisTime);
+        applyCrossfade(dest, start, numThisTime);
+
+        start += numThisTime;
+        remaining -= numThisTime;
+
+        if (inLoop && playPosition >= currentJumpPoints->loopEnd)
+            jumpFromAudioThread(currentJumpPoints->loopStart, true);
+    }
+
+    position.store(playPosition);
+}
+
+void DeckTrackSource::readTrack(juce::AudioBuffer<float>& dest, int destStartSample, int numSamples)
+{
+    while (numSamples > 0)
+    {
+        if (playingBuffer != nullptr && playPosition >= playingBuffer->startSample && playPosition < playingBuffer->getEndSample())
+        {
+            const int offset = (int) (playPosition - playingBuffer->startSample);
+            const int numThisTime = (int) juce::jmin((juce::int64) numSamples, playingBuffer->getEndSample() - playPosition);
+            const int numBufferChannels = playingBuffer->samples.getNumChannels();
+
+            for (int channel = 0; channel < dest.getNumChannels(); ++channel)
+                dest.copyFrom(channel, destStartSample, playingBuffer->samples,
+                              juce::jmin(channel, numBufferChannels - 1), offset, numThisTime);
+
+            playPosition += numThisTime;
+            destStartSample += numThisTime;
+            numSamples -= numThisTime;
+            continue;
+        }
+
+        // past the end of the buffer, where the source should already be waiting
+        playingBuffer = nullptr;
+        auto& source = *currentTrack->source;
+
+        if (source.getNextReadPosition() != playPosition)
+            source.setNextReadPosition(playPosition);
+
+        source.getNextAudioBlock(juce::AudioSourceChannelInfo(&dest, destStartSample, numSamples));
+        playPosition += numSamples;
+        return;
+    }
+}
+
+void DeckTrackSource::jumpFromAudioThread(juce::int64 target, bool crossfade)
+{
+    const auto from = playPosition;
+
+    if (crossfade && fadeBuffer.getNumSamples() >= crossfadeSamples)
+    {
+        // what would have played next, faded out over the start of the target
+        readTrack(fadeBuffer, 0, crossfadeSamples);
+        fadePosition = 0;
+        fadeRemaining = crossfadeSamples;
+    }
+    else
+    {
+        fadeRemaining = 0;
+    }
+
+    jumpDistance += target - from;
+    moveTo(target);
+}
+
+void DeckTrackSource::moveTo(juce::int64 target)
+{
+    playPosition = target;
+    playingBuffer = currentJumpPoints != nullptr ? currentJumpPoints->findBuffer(target) : nullptr;
+
+    // while the buffer plays the source gets a head start on what follows it. Going round a
+    // loop it's already there, and a seek could throw away what it's read ahead
+    const auto sourcePosition = playingBuffer != nullptr ? playingBuffer->getEndSample() : target;
+
+    if (currentTrack->source->getNextReadPosition() != sourcePosition)
+        currentTrack->source->setNextReadPosition(sourcePosition);
+}
+
+void DeckTrackSource::applyCrossfade(juce::AudioBuffer<float>& dest, int destStartSample, int numSamples)
+{
+    if (fadeRemaining <= 0)
+        return;
+
+    const int numThisTime = juce::jmin(numSamples, fadeRemaining);
+
+    for (int channel = 0; channel < dest.getNumChannels(); ++channel)
+    {
+        auto* out = dest.getWritePointer(channel, destStartSample);
+        const auto* fadingOut = fadeBuffer.getReadPointer(juce::jmin(channel, fadeBuffer.getNumChannels() - 1), fadePosition);
+
+        for (int i = 0; i < numThisTime; ++i)
+        {
+            const float fadeIn = (float) (fadePosition + i + 1) / (float) crossfadeSamples;
+            out[i] = out[i] * fadeIn + fadingOut[i] * (1.0f - fadeIn);
+        }
+    }
+
+    fadePosition += numThisTime;
+    fadeRemaining -= numThisTime;
+}
+
+void DeckTrackSource::setNextReadPosition(juce::int64 newPosition)
+{
+    pushCommand(PositionCommand::Type::seek, newPosition);
+}
+
+juce::int64 DeckTrackSource::getNextReadPosition() const
+{
+    return position.load();
+}
+
+juce::int64 DeckTrackSource::getTotalLength() const
+{
+    return totalLength.load();
+}
+
+bool DeckTrackSource::isLooping() const
+{
+    return false;
+}
@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+    DeckTrackSource.h
+    Created: 17 Oct 2026 11:32:20am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "TrackLoader.h"
+
+//==============================================================================
+/** Part of a track decoded into memory ahead of time, so a jump to it never waits on the disk */
+struct JumpBuffer
+{
+    juce::int64 startSample = 0;
+    juce::AudioBuffer<float> samples;
+
+    juce::int64 getEndSample() const { return startSample + samples.getNumSamples(); }
+};
+
+//==============================================================================
+/** The loop a deck plays round and the buffers it can jump into, in samples of one track */
+struct JumpPoints
+{
+    juce::int64 loopStart = -1;
+    juce::int64 loopEnd = -1;   // -1 if there's no loop
+    std::vector<std::shared_ptr<const JumpBuffer>> buffers;
+
+    bool isLoopActive() const { return loopStart >= 0 && loopEnd > loopStart; }
+
+    /** a buffer holding position, or nullptr */
+    const JumpBuffer* findBuffer(juce::int64 position) const;
+
+    juce::uint64 trackSerial = 0; // the LoadedTrack::deckSerial these belong to, filled in by DeckTrackSource::setJumpPoints
+};
+
+//==============================================================================
+/*
+    The source a deck's transport plays from. It stays in place for the life of
+    the deck, and the tracks behind it are swapped without any locks:
+
+    - the message thread publishes a LoadedTrack with an atomic exchange
+    - the audio thread picks it up at the start of its next block
+    - the track it replaces is handed back through a FIFO so it's deleted on
+      the message thread rather than in the audio callback
+
+    Seeks and jumps go to the audio thread through one FIFO of commands,
+    applied in the order they were made at the start of the next block. Each
+    is tagged with the track it was made for, so one made just before a load
+    is dropped rather than landing on the new track. The audio thread is the
+    only one that moves the read position.
+
+    Hot cue jumps and loops are done here too, inside the audio callback,
+    rather than as seeks. A jump reads the next few milliseconds of where the
+    track was heading and crossfades them into the target, and plays the
+    target from a JumpBuffer decoded beforehand while the track's own source
+    catches up from the end of it. Jump points are published the same way as
+    tracks, and retired through a FIFO of their own.
+
+    Positions and lengths are in samples at the current track's sample rate.
+*/
+class DeckTrackSource : public juce::PositionableAudioSource,
+                        private juce::Timer
+{
+public:
+    DeckTrackSource();
+    ~DeckTrackSource() override;
+
+    //==============================================================================
+    /** message thread: queues a track to replace the current one */
+    void setTrack(std::unique_ptr<LoadedTrack> newTrack);
+
+    /** message thread: deletes tracks the audio thread has finished with */
+    void collectRetiredTracks();
+
+    /** message thread: replaces the loop and jump buffers for the track last passed to setTrack */
+    void setJumpPoints(std::unique_ptr<JumpPoints> newPoints);
+
+    /** message thread: jumps to a position without a gap, crossfading if the deck is playing.
+        Unlike a seek this carries on from where the audio thread is rather than starting afresh.
+        Returns false if there's no track or the command queue is full */
+    bool jumpTo(juce::int64 newPosition);
+
+    /** length of the crossfade into a jump or round a loop */
+    static constexpr int crossfadeSamples = 256;
+
+    //==============================================================================
+    struct Update
+    {
+        bool trackChanged = false;
+        bool seeked = false;
+    };
+
+    /** audio thread: installs a newly published track and jump points and applies any pending
+        seek or jump. Call at the start of each block */
+    Update updateFromAudioThread(bool isPlaying);
+
+    /** audio thread: how far jumps and loops have moved the read position since the last call */
+    juce::int64 takeJumpDistance();
+
+    /** audio thread: sample rate of the track currently playing, or 0 if there isn't one */
+    double getCurrentSampleRate() const;
+
+    //==============================================================================
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    /** message thread: queues a seek, clamped to the track. Dropped if there's no track or the
+        command queue is full */
+    void setNextReadPosition(juce::int64 newPosition) override;
+
+    /** where the audio thread will read from next */
+    juce::int64 getNextReadPosition() const override;
+    juce::int64 getTotalLength() const override;
+    bool isLooping() const override;
+
+private:
+    void timerCallback() override;
+    void collectRetiredJumpPoints();
+
+    struct PositionCommand
+    {
+        enum class Type
+        {
+            seek,
+            jump
+        };
+
+        Type type = Type::seek;
+        juce::int64 position = 0;
+        juce::uint64 trackSerial = 0; // the LoadedTrack::deckSerial it was made for
+    };
+
+    bool pushCommand(PositionCommand::Type type, juce::int64 newPosition);
+    void applyCommands(bool isPlaying, Update& update);
+
+    // audio thread
+    juce::uint64 getCurrentTrackSerial() const;
+    void installJumpPoints(JumpPoints* newPoints);
+    void retireJumpPoints(JumpPoints* points);
+    void readTrack(juce::AudioBuffer<float>& dest, int destStartSample, int numSamples);
+    void jumpFromAudioThread(juce::int64 target, bool crossfade);
+    void moveTo(juce::int64 target);
+    void applyCrossfade(juce::AudioBuffer<float>& dest, int destStartSample, int numSamples);
+
+    std::atomic<LoadedTrack*> pendingTrack{ nullptr };
+    LoadedTrack* currentTrack = nullptr; // only touched by the audio thread
+
+    static constexpr int maxRetiredTracks = 16;
+    juce::AbstractFifo retiredFifo{ maxRetiredTracks };
+    std::array<LoadedTrack*, maxRetiredTracks> retiredTracks{};
+
+    // message thread, for numbering tracks and tagging jump points and commands with them
+    juce::uint64 lastTrackSerial = 0;
+    juce::int64 lastTrackLength = 0;
+
+    std::atomic<JumpPoints*> pendingJumpPoints{ nullptr };
+    JumpPoints* currentJumpPoints = nullptr; // only touched by the audio thread
+
+    static constexpr int maxRetiredJumpPoints = 16;
+    juce::AbstractFifo retiredJumpPointsFifo{ maxRetiredJumpPoints };
+    std::array<JumpPoints*, maxRetiredJumpPoints> retiredJumpPoints{};
+
+    // audio thread: where the next sample comes from, and the buffer it's being played from if any
+    juce::int64 playPosition = 0;
+    const JumpBuffer* playingBuffer = nullptr;
+    juce::int64 jumpDistance = 0;
+
+    // the end of what was playing before a jump, faded out under the start of the target
+    juce::AudioBuffer<float> fadeBuffer;
+    int fadePosition = 0;
+    int fadeRemaining = 0;
+
+    static constexpr int maxPositionCommands = 32;
+    juce::AbstractFifo commandFifo{ maxPositionCommands };
+    std::array<PositionCommand, maxPositionCommands> positionCommands{};
+
+    std::atomic<juce::int64> position{ 0 };
+    std::atomic<juce::int64> totalLength{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckTrackSource)
+};
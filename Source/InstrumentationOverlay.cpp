@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    InstrumentationOverlay.cpp
+    Created: 17 Oct 2026 10:59:31pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "InstrumentationOverlay.h"
+
+//==============================================================================
+InstrumentationOverlay::InstrumentationOverlay(AudioInstrumentation& _instrumentation, juce::AudioDeviceManager& _deviceManager)
+                                               : instrumentation(_instrumentation),
+                                                 deviceManager(_deviceManager)
+{
+    addAndMakeVisible(csvButton);
+    addAndMakeVisible(jsonButton);
+    addAndMakeVisible(resetButton);
+
+    csvButton.onClick = [this] { dump(false); };
+    jsonButton.onClick = [this] { dump(true); };
+    resetButton.onClick = [this] { instrumentation.reset(); status = {}; repaint(); };
+}
+
+InstrumentationOverlay::~InstrumentationOverlay()
+{
+    stopTimer();
+}
+
+void InstrumentationOverlay::visibilityChanged()
+{
+    // only poll while someone's looking
+    if (isVisible())
+        startTimerHz(10);
+    else
+        stopTimer();
+}
+
+void InstrumentationOverlay::timerCallback()
+{
+    repaint();
+}
+
+void InstrumentationOverlay::dump(bool asJson)
+{
+    const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(asJson ? "instrumentation.json" : "instrumentation.csv");
+    const bool written = asJson ? instrumentation.writeJson(file) : instrumentation.writeCsv(file);
+
+    status = written ? "wrote " + file.getFileName() : "couldn't write " + file.getFileName();
+    repaint();
+}
+
+void InstrumentationOverlay::paint (juce::Graphics& g)
+{
+    g.setColour(juce::Colours::black.withAlpha(0.8f));
+    g.fillRoundedRectangle(getLocalBounds().toFloat(), 6.0f);
+
+    const auto summary = instrumentation.getSummary();
+    const auto& log = instrumentation.getXrunLog();
+    const auto history = instrumentation.getHistory();
+
+    auto area = getLocalBounds().reduced(8);
+    const int lineHeight = 16;
+
+    g.setFont(13.0f);
+
+    auto drawLine = [&](const juce::String& text, juce::Colour colour)
+    {
+        g.setColour(colour);
+        g.drawText(text, area.removeFromTop(lineHeight), juce::Justification::centredLeft, true);
+    };
+
+    const auto loadColour = summary.peakLoad > 1.0f ? juce::Colours::red
+                          : summary.peakLoad > 0.7f ? juce::Colours::orange
+                          : juce::Colours::lightgreen;
+
+    drawLine("load " + juce::String(juce::roundToInt(summary.lastLoad * 100)) + "%"
+             + "   avg " + juce::String(juce::roundToInt(summary.averageLoad * 100)) + "%"
+             + "   peak " + juce::String(juce::roundToInt(summary.peakLoad * 100)) + "%"
+             + "   max " + juce::String(summary.maxDurationMs, 2) + " ms", loadColour);
+
+    drawLine("callbacks " + juce::String(summary.numCallbacks)
+             + "   overruns " + juce::String(summary.numOverruns)
+             + "   late " + juce::String(summary.numLate)
+             + "   device xruns " + juce::String(deviceManager.getXRunCount())
+             + "   dropped " + juce::String(summary.numDropped), juce::Colours::white);
+
+    if (! history.empty())
+    {
+        const auto& last = history.back();
+        juce::String stages;
+
+        for (int stage = 0; stage < AudioInstrumentation::numStages; ++stage)
+            stages << AudioInstrumentation::getStageName((AudioInstrumentation::Stage) stage) << " "
+                   << juce::String(last.stageMs[(size_t) stage], 2) << "  ";
+
+        drawLine("last " + juce::String(last.durationMs, 2) + " of " + juce::String(last.budgetMs, 2) + " ms:  " + stages,
+                 juce::Colours::lightgrey);
+    }
+
+    if (! log.empty())
+    {
+        const auto& event = log.back();
+        drawLine("last xrun at " + juce::String(event.record.startSeconds, 1) + " s: "
+                 + (event.overrun ? "overrun " : "late ")
+                 + juce::String(event.overrun ? event.record.durationMs : event.record.intervalMs, 2) + " ms, mostly "
+                 + AudioInstrumentation::getStageName(event.record.getSlowestStage()),
+                 juce::Colours::orange);
+    }
+
+    if (status.isNotEmpty())
+        drawLine(status, juce::Colours::lightblue);
+
+    // jitter histogram along the bottom, above the buttons
+    area.removeFromBottom(30);
+    auto labels = area.removeFromBottom(12);
+    const auto& histogram = instrumentation.getJitterHistogram();
+    const auto peak = *std::max_element(histogram.begin(), histogram.end());
+
+    if (peak > 0 && area.getHeight() > 10)
+    {
+        const float barWidth = area.getWidth() / (float) histogram.size();
+
+        for (size_t i = 0; i < histogram.size(); ++i)
+        {
+            // log scale, so the rare slow callbacks still show up
+            const float height = area.getHeight() * (float) (std::log1p((double) histogram[i]) / std::log1p((double) peak));
+            const bool onTime = i > 0 && i < histogram.size() - 1;
+
+            g.setColour(onTime ? juce::Colours::skyblue : juce::Colours::red);
+            g.fillRect(area.getX() + barWidth * i, area.getBottom() - height, juce::jmax(1.0f, barWidth - 1.0f), height);
+        }
+
+        g.setColour(juce::Colours::grey);
+        g.setFont(11.0f);
+        g.drawText("-" + juce::String(AudioInstrumentation::jitterRangeMs, 0) + " ms", labels, juce::Justification::centredLeft);
+        g.drawText("callback jitter", labels, juce::Justification::centred);
+        g.drawText("+" + juce::String(AudioInstrumentation::jitterRangeMs, 0) + " ms", labels, juce::Justification::centredRight);
+    }
+}
+
+void InstrumentationOverlay::resized()
+{
+    auto buttons = getLocalBounds().reduced(8).removeFromBottom(24);
+    const int buttonWidth = 60;
+
+    resetButton.setBounds(buttons.removeFromRight(buttonWidth));
+    buttons.removeFromRight(4);
+    jsonButton.setBounds(buttons.removeFromRight(buttonWidth));
+    buttons.removeFromRight(4);
+    csvButton.setBounds(buttons.removeFromRight(buttonWidth));
+}
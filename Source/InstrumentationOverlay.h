@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    InstrumentationOverlay.h
+    Created: 17 Oct 2026 10:59:31pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioInstrumentation.h"
+
+//==============================================================================
+/*
+    A panel over the decks showing how hard the audio callback is working:
+    load, overruns and late callbacks, where the time went in the last
+    callback, the jitter histogram and the last xrun. Its buttons dump the
+    full history to instrumentation.csv or instrumentation.json.
+*/
+class InstrumentationOverlay  : public juce::Component,
+                                private juce::Timer
+{
+public:
+    InstrumentationOverlay(AudioInstrumentation& instrumentation, juce::AudioDeviceManager& deviceManager);
+    ~InstrumentationOverlay() override;
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+    void visibilityChanged() override;
+
+private:
+    void timerCallback() override;
+    void dump(bool asJson);
+
+    AudioInstrumentation& instrumentation;
+    juce::AudioDeviceManager& deviceManager;
+
+    juce::TextButton csvButton{ "CSV" };
+    juce::TextButton jsonButton{ "JSON" };
+    juce::TextButton resetButton{ "RESET" };
+    juce::String status;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InstrumentationOverlay)
+};
@@ -0,0 +1,300 @@
+/*
+  ==============================================================================
+
+    LibraryJournal.cpp
+    Created: 18 Oct 2026 5:37:12am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "LibraryJournal.h"
+#include <array>
+#include <cstring>
+
+namespace
+{
+    const char logMagic[4] = { 'O', 'T', 'L', 'G' };
+    constexpr size_t frameHeaderSize = 8;
+}
+
+//==============================================================================
+LibraryJournal::LibraryJournal(const juce::File& _snapshotFile, const juce::File& _logFile)
+    : juce::Thread("Library Journal"),
+      snapshotFile(_snapshotFile),
+      logFile(_logFile)
+{}
+
+LibraryJournal::~LibraryJournal()
+{
+    // the thread writes whatever's left in the queue on its way out, so give it time
+    stopThread(10000);
+}
+
+juce::uint32 LibraryJournal::crc32(const void* data, size_t size)
+{
+    static const auto table = []
+    {
+        std::array<juce::uint32, 256> entries{};
+
+        for (juce::uint32 i = 0; i < 256; ++i)
+        {
+            auto value = i;
+
+            for (int bit = 0; bit < 8; ++bit)
+                value = (value & 1) != 0 ? 0xedb88320u ^ (value >> 1) : value >> 1;
+
+            entries[i] = value;
+        }
+
+        return entries;
+    }();
+
+    const auto* bytes = static_cast<const juce::uint8*>(data);
+    juce::uint32 crc = 0xffffffffu;
+
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+
+    return crc ^ 0xffffffffu;
+}
+
+LibraryJournal::LogContents LibraryJournal::read(const std::function<void(const char* data, size_t size)>& applyPayload) const
+{
+    LogContents contents;
+    juce::MemoryBlock data;
+
+    if (! logFile.existsAsFile() || ! logFile.loadFileAsData(data)
+        || data.getSize() < headerSize || std::memcmp(data.getData(), logMagic, sizeof(logMagic)) != 0)
+        return contents;
+
+    const auto* bytes = static_cast<const char*>(data.getData());
+    contents.version = juce::ByteOrder::littleEndianInt(bytes + sizeof(logMagic));
+
+    if (contents.version != currentVersion)
+        return contents;
+
+    size_t position = headerSize;
+
+    while (data.getSize() - position >= frameHeaderSize)
+    {
+        const auto size = juce::ByteOrder::littleEndianInt(bytes + position);
+        const auto checksum = juce::ByteOrder::littleEndianInt(bytes + position + 4);
+
+        // cut short or damaged by a crash part way through an append
+        if (size > data.getSize() - position - frameHeaderSize
+            || crc32(bytes + position + frameHeaderSize, size) != checksum)
+            break;
+
+        applyPayload(bytes + position + frameHeaderSize, size);
+        position += frameHeaderSize + size;
+    }
+
+    contents.validBytes = (juce::int64) position;
+    return contents;
+}
+
+void LibraryJournal::open(juce::int64 validBytes)
+{
+    flush();
+    stopThread(10000);
+
+    log.reset();
+    logBytes = 0;
+    snapshotBytes = snapshotFile.existsAsFile() ? snapshotFile.getSize() : 0;
+
+    if (validBytes < (juce::int64) headerSize)
+    {
+        startNewLog();
+    }
+    else
+    {
+        log = std::make_unique<juce::FileOutputStream>(logFile);
+
+        // drop anything after the last whole frame, so new ones follow on from it
+        if (log->openedOk() && log->setPosition(validBytes) && log->truncate().wasOk())
+        {
+            logBytes = validBytes;
+        }
+        else
+        {
+            log.reset();
+            DBG("LibraryJournal: couldn't open " << logFile.getFullPathName() << ", edits won't be saved");
+        }
+    }
+
+    startThread();
+}
+
+void LibraryJournal::append(juce::MemoryBlock payload)
+{
+    {
+        const juce::ScopedLock sl(queueLock);
+        queue.push_back({ std::move(payload), nullptr });
+        ++numQueued;
+    }
+
+    notify();
+}
+
+void LibraryJournal::writeSnapshot(std::function<bool(juce::OutputStream&)> writeContents)
+{
+    ++numPendingSnapshots;
+
+    {
+        const juce::ScopedLock sl(queueLock);
+        queue.push_back({ {}, std::move(writeContents) });
+        ++numQueued;
+    }
+
+    notify();
+}
+
+void LibraryJournal::flush()
+{
+    juce::uint64 target;
+
+    {
+        const juce::ScopedLock sl(queueLock);
+        target = numQueued;
+    }
+
+    while (numWritten.load() < target && isThreadRunning())
+        itemsWritten.wait(100);
+}
+
+bool LibraryJournal::isSnapshotPending() const
+{
+    return numPendingSnapshots.load() > 0;
+}
+
+juce::int64 LibraryJournal::getLogBytes() const
+{
+    return logBytes.load();
+}
+
+juce::int64 LibraryJournal::getSnapshotBytes() const
+{
+    return snapshotBytes.load();
+}
+
+//==============================================================================
+void LibraryJournal::run()
+{
+    // anything queued before the thread started is written straight away
+    for (;;)
+    {
+        writeQueuedItems();
+
+        if (threadShouldExit())
+            break;
+
+        wait(-1);
+    }
+
+    writeQueuedItems();
+}
+
+void LibraryJournal::writeQueuedItems()
+{
+    for (;;)
+    {
+        std::deque<Item> items;
+
+        {
+            const juce::ScopedLock sl(queueLock);
+            items.swap(queue);
+        }
+
+        if (items.empty())
+            return;
+
+        for (auto& item : items)
+        {
+            if (item.writeSnapshot != nullptr)
+            {
+                if (! writeSnapshotNow(item.writeSnapshot))
+                    DBG("LibraryJournal: couldn't write " << snapshotFile.getFullPathName() << ", keeping the log");
+
+                --numPendingSnapshots;
+            }
+            else if (log != nullptr)
+            {
+                juce::uint8 frameHeader[frameHeaderSize];
+                const auto size = (juce::uint32) item.payload.getSize();
+                const auto checksum = crc32(item.payload.getData(), item.payload.getSize());
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    frameHeader[i] = (juce::uint8) (size >> (8 * i));
+                    frameHeader[4 + i] = (juce::uint8) (checksum >> (8 * i));
+                }
+
+                log->write(frameHeader, frameHeaderSize);
+                log->write(item.payload.getData(), item.payload.getSize());
+                logBytes += (juce::int64) (frameHeaderSize + item.payload.getSize());
+            }
+        }
+
+        // one flush for everything that queued up while the last lot was being written
+        if (log != nullptr)
+        {
+            log->flush();
+
+            if (log->getStatus().failed())
+                DBG("LibraryJournal: " << log->getStatus().getErrorMessage());
+        }
+
+        numWritten += items.size();
+        itemsWritten.signal();
+    }
+}
+
+bool LibraryJournal::writeSnapshotNow(const std::function<bool(juce::OutputStream&)>& writeContents)
+{
+    // written beside the old snapshot and renamed over it, so there's always a whole one on disk
+    juce::TemporaryFile temp(snapshotFile);
+
+    {
+        juce::FileOutputStream out(temp.getFile());
+
+        if (! out.openedOk() || ! writeContents(out))
+            return false;
+
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    if (! temp.overwriteTargetFileWithTemporary())
+        return false;
+
+    snapshotBytes = snapshotFile.getSize();
+
+    // the snapshot holds everything the log did. If we stop before the log is emptied,
+    // replaying it over the new snapshot just makes the same edits again
+    return startNewLog();
+}
+
+bool LibraryJournal::startNewLog()
+{
+    log.reset();
+
+    juce::MemoryOutputStream header;
+    header.write(logMagic, sizeof(logMagic));
+    header.writeInt((int) currentVersion);
+
+    if (logFile.replaceWithData(header.getData(), header.getDataSize()))
+        log = std::make_unique<juce::FileOutputStream>(logFile);
+
+    if (log == nullptr || ! log->openedOk())
+    {
+        log.reset();
+        DBG("LibraryJournal: couldn't reset " << logFile.getFullPathName() << ", edits won't be saved");
+        return false;
+    }
+
+    logBytes = (juce::int64) header.getDataSize();
+    return true;
+}
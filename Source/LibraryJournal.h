@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    LibraryJournal.h
+    Created: 18 Oct 2026 5:37:12am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+
+//==============================================================================
+/*
+    Writes the track library to disk on its own thread, so an edit only
+    costs the message thread a push onto a queue.
+
+    Edits go into an append-only log as they're made. Each append is one
+    frame - a uint32 size, a uint32 CRC-32, then the payload - so a batch of
+    edits is replayed whole or not at all, and a frame that was cut short or
+    scribbled over by a crash is spotted and dropped along with everything
+    after it.
+
+    Snapshots are written beside the old one and renamed over it, and only
+    then is the log emptied. A crash at any point leaves a whole snapshot and
+    a log that replays cleanly over it.
+
+    File layout (little-endian):
+        log: "OTLG", uint32 version, then frames of uint32 payload size,
+             uint32 CRC-32 of the payload, payload
+*/
+class LibraryJournal : private juce::Thread
+{
+public:
+    static constexpr juce::uint32 currentVersion = 2;
+    static constexpr size_t headerSize = 8;
+
+    LibraryJournal(const juce::File& snapshotFile, const juce::File& logFile);
+
+    /** writes anything still queued before returning */
+    ~LibraryJournal() override;
+
+    struct LogContents
+    {
+        juce::uint32 version = 0;   // 0 if there's no log, or it isn't one of ours. Nothing is read from
+                                    // a log of any version but currentVersion
+        juce::int64 validBytes = 0; // up to the end of the last whole frame
+    };
+
+    /** passes each whole payload in the log to applyPayload, in order. Call with nothing
+        queued, before open() */
+    LogContents read(const std::function<void(const char* data, size_t size)>& applyPayload) const;
+
+    /** starts the writer, appending after validBytes of the log and cutting off anything past them.
+        If there's no valid header there, the log is started afresh */
+    void open(juce::int64 validBytes);
+
+    /** queues a payload to be appended to the log as one frame */
+    void append(juce::MemoryBlock payload);
+
+    /** queues a new snapshot, written by writeContents on the journal's thread. The log is
+        emptied once it's in place, so writeContents must capture everything edited so far */
+    void writeSnapshot(std::function<bool(juce::OutputStream&)> writeContents);
+
+    /** waits until everything queued so far is on disk */
+    void flush();
+
+    bool isSnapshotPending() const;
+    juce::int64 getLogBytes() const;
+    juce::int64 getSnapshotBytes() const;
+
+    static juce::uint32 crc32(const void* data, size_t size);
+
+private:
+    struct Item
+    {
+        juce::MemoryBlock payload;
+        std::function<bool(juce::OutputStream&)> writeSnapshot; // set for snapshots instead of the payload
+    };
+
+    void run() override;
+    void writeQueuedItems();
+    bool writeSnapshotNow(const std::function<bool(juce::OutputStream&)>& writeContents);
+    bool startNewLog();
+
+    const juce::File snapshotFile, logFile;
+
+    juce::CriticalSection queueLock;
+    std::deque<Item> queue;
+    juce::uint64 numQueued = 0;
+    std::atomic<juce::uint64> numWritten{ 0 };
+    juce::WaitableEvent itemsWritten;
+
+    // only touched on the journal's thread once it's running
+    std::unique_ptr<juce::FileOutputStream> log;
+
+    std::atomic<int> numPendingSnapshots{ 0 };
+    std::atomic<juce::int64> logBytes{ 0 }, snapshotBytes{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibraryJournal)
+};
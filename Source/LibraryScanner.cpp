@@ -0,0 +1,536 @@
+/*
+  ==============================================================================
+
+    LibraryScanner.cpp
+    Created: 18 Oct 2026 3:02:47am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "LibraryScanner.h"
+#include <cstring>
+
+namespace
+{
+    constexpr int filesPerJob = 16;
+    constexpr int maxTextFrameBytes = 4096;     // longer than any title, and skips album art and lyrics
+    constexpr int maxCommentBlockBytes = 1 << 20;
+
+    juce::uint32 readBigEndian32(const juce::uint8* data)
+    {
+        return ((juce::uint32) data[0] << 24) | ((juce::uint32) data[1] << 16) | ((juce::uint32) data[2] << 8) | data[3];
+    }
+
+    /** ID3v2 sizes keep the top bit of each byte clear */
+    juce::uint32 readSynchsafe32(const juce::uint8* data)
+    {
+        return ((juce::uint32) (data[0] & 0x7f) << 21) | ((juce::uint32) (data[1] & 0x7f) << 14)
+             | ((juce::uint32) (data[2] & 0x7f) << 7) | (juce::uint32) (data[3] & 0x7f);
+    }
+
+    /** up to the first null, as a tag frame can hold several values */
+    juce::String decodeUTF16(const juce::uint8* data, size_t size, bool bigEndian)
+    {
+        juce::String text;
+
+        for (size_t i = 0; i + 1 < size; i += 2)
+        {
+            auto unit = (juce::juce_wchar) (bigEndian ? (data[i] << 8) | data[i + 1] : (data[i + 1] << 8) | data[i]);
+
+            if (unit == 0)
+                break;
+
+            if (unit >= 0xd800 && unit < 0xdc00 && i + 3 < size) // a surrogate pair
+            {
+                const auto low = (juce::juce_wchar) (bigEndian ? (data[i + 2] << 8) | data[i + 3] : (data[i + 3] << 8) | data[i + 2]);
+                unit = 0x10000 + ((unit - 0xd800) << 10) + (low - 0xdc00);
+                i += 2;
+            }
+
+            text += unit;
+        }
+
+        return text;
+    }
+
+    /** the text of an ID3v2 text frame, whose first byte says how it's encoded */
+    juce::String decodeID3Text(const juce::uint8* data, size_t size)
+    {
+        if (size < 2)
+            return {};
+
+        const auto encoding = data[0];
+        ++data;
+        --size;
+
+        switch (encoding)
+        {
+            case 1: // UTF-16 with a byte order mark
+                if (size >= 2 && data[0] == 0xfe && data[1] == 0xff)
+                    return decodeUTF16(data + 2, size - 2, true);
+
+                if (size >= 2 && data[0] == 0xff && data[1] == 0xfe)
+                    return decodeUTF16(data + 2, size - 2, false);
+
+                return decodeUTF16(data, size, false);
+
+            case 2:
+                return decodeUTF16(data, size, true);
+
+            case 3:
+                return juce::String::fromUTF8(reinterpret_cast<const char*>(data), (int) size);
+
+            default: // ISO-8859-1, whose characters are the first 256 of unicode
+            {
+                juce::String text;
+
+                for (size_t i = 0; i < size && data[i] != 0; ++i)
+                    text += (juce::juce_wchar) data[i];
+
+                return text;
+            }
+        }
+    }
+
+    /** title, artist and key from the ID3v2.3 or 2.4 tag at the start of an mp3 */
+    void readID3Tags(juce::InputStream& in, LibraryTrack& track)
+    {
+        juce::uint8 header[10];
+
+        if (in.read(header, sizeof(header)) != (int) sizeof(header) || std::memcmp(header, "ID3", 3) != 0)
+            return;
+
+        const int version = header[3];
+
+        if (version != 3 && version != 4)
+            return;
+
+        const juce::int64 tagEnd = sizeof(header) + readSynchsafe32(header + 6);
+
+        if ((header[5] & 0x40) != 0) // skip the extended header
+        {
+            juce::uint8 size[4];
+
+            if (in.read(size, sizeof(size)) != (int) sizeof(size))
+                return;
+
+            // 2.4 counts the size bytes themselves, 2.3 doesn't
+            in.setPosition(version == 4 ? in.getPosition() - 4 + readSynchsafe32(size)
+                                        : in.getPosition() + readBigEndian32(size));
+        }
+
+        juce::HeapBlock<juce::uint8> frameData(maxTextFrameBytes);
+
+        while (in.getPosition() + 10 <= tagEnd)
+        {
+            juce::uint8 frameHeader[10];
+
+            if (in.read(frameHeader, sizeof(frameHeader)) != (int) sizeof(frameHeader) || frameHeader[0] == 0)
+                return; // the padding after the last frame
+
+            const juce::String id(reinterpret_cast<const char*>(frameHeader), 4);
+            auto size = (juce::int64) (version == 4 ? readSynchsafe32(frameHeader + 4) : readBigEndian32(frameHeader + 4));
+            const auto frameEnd = in.getPosition() + size;
+
+            if (frameEnd > tagEnd)
+                return;
+
+            juce::String* field = id == "TIT2" ? &track.title
+                                : id == "TPE1" ? &track.artist
+                                : id == "TKEY" ? &track.key
+                                : nullptr;
+
+            // compressed or encrypted frames aren't worth unpacking for a title
+            const bool isPacked = version == 4 ? (frameHeader[9] & 0x0c) != 0 : (frameHeader[9] & 0xc0) != 0;
+
+            if (version == 4 && (frameHeader[9] & 0x01) != 0) // a data length comes before the text
+            {
+                in.skipNextBytes(4);
+                size -= 4;
+            }
+
+            if (field != nullptr && ! isPacked && size > 0 && size <= maxTextFrameBytes
+                && in.read(frameData, (int) size) == (int) size)
+                *field = decodeID3Text(frameData, (size_t) size).trim();
+
+            if (track.title.isNotEmpty() && track.artist.isNotEmpty() && track.key.isNotEmpty())
+                return;
+
+            in.setPosition(frameEnd);
+        }
+    }
+
+    /** title, artist and key from a flac's Vorbis comment block, skipping over the other metadata */
+    void readFlacTags(juce::InputStream& in, LibraryTrack& track)
+    {
+        char magic[4];
+
+        if (in.read(magic, sizeof(magic)) != (int) sizeof(magic) || std::memcmp(magic, "fLaC", 4) != 0)
+            return;
+
+        for (bool isLastBlock = false; ! isLastBlock;)
+        {
+            juce::uint8 header[4];
+
+            if (in.read(header, sizeof(header)) != (int) sizeof(header))
+                return;
+
+            isLastBlock = (header[0] & 0x80) != 0;
+            const int type = header[0] & 0x7f;
+            const int size = (header[1] << 16) | (header[2] << 8) | header[3];
+
+            if (type != 4) // not the comments - pictures especially are best not read
+            {
+                in.setPosition(in.getPosition() + size);
+                continue;
+            }
+
+            if (size > maxCommentBlockBytes)
+                return;
+
+            juce::MemoryBlock block;
+
+            if (in.readIntoMemoryBlock(block, size) != (size_t) size)
+                return;
+
+            // little-endian lengths: the vendor string, the number of comments, then each "NAME=value"
+            const auto* data = static_cast<const char*>(block.getData());
+            size_t position = 0;
+
+            auto readLength = [&](juce::uint32& length)
+            {
+                if (block.getSize() - position < 4)
+                    return false;
+
+                length = juce::ByteOrder::littleEndianInt(data + position);
+                position += 4;
+                return length <= block.getSize() - position;
+            };
+
+            juce::uint32 length = 0, numComments = 0;
+
+            if (! readLength(length))
+                return;
+
+            position += length;
+
+            if (block.getSize() - position < 4)
+                return;
+
+            numComments = juce::ByteOrder::littleEndianInt(data + position);
+            position += 4;
+
+            for (juce::uint32 i = 0; i < numComments && readLength(length); ++i)
+            {
+                const auto comment = juce::String::fromUTF8(data + position, (int) length);
+                position += length;
+
+                const auto name = comment.upToFirstOccurrenceOf("=", false, false).toUpperCase();
+                const auto value = comment.fromFirstOccurrenceOf("=", false, false).trim();
+
+                if (name == "TITLE")
+                    track.title = value;
+                else if (name == "ARTIST")
+                    track.artist = value;
+                else if (name == "INITIALKEY" || name == "KEY")
+                    track.key = value;
+            }
+
+            return;
+        }
+    }
+}
+
+//==============================================================================
+/** counts itself off when it's deleted, which the pool does for a job it removes from
+    the queue as well as for one that's run */
+class LibraryScanner::Job : public juce::ThreadPoolJob
+{
+public:
+    Job(LibraryScanner& _scanner, std::function<void()> _work)
+        : juce::ThreadPoolJob("Library scan"),
+          scanner(_scanner),
+          work(std::move(_work))
+    {
+        ++scanner.numJobs;
+    }
+
+    ~Job() override
+    {
+        --scanner.numJobs;
+    }
+
+    JobStatus runJob() override
+    {
+        if (! scanner.shouldExit())
+            work();
+
+        return jobHasFinished;
+    }
+
+private:
+    LibraryScanner& scanner;
+    std::function<void()> work;
+};
+
+//==============================================================================
+LibraryScanner::LibraryScanner(TrackLibrary& _trackLibrary,
+                               juce::AudioFormatManager& _formatManager,
+                               int numThreads)
+                               : trackLibrary(_trackLibrary),
+                                 formatManager(_formatManager),
+                                 workers(juce::jmax(1, numThreads))
+{}
+
+LibraryScanner::~LibraryScanner()
+{
+    stopTimer();
+    cancelled = true;
+
+    // no time limit: a job can be stuck in a reader's constructor on a big or remote file,
+    // and it writes to our members when it gets out
+    workers.removeAllJobs(true, -1);
+}
+
+bool LibraryScanner::scan(const juce::Array<juce::File>& filesAndFolders)
+{
+    if (cancelled)
+        return false;
+
+    if (filesAndFolders.isEmpty())
+        return true;
+
+    if (! scanning)
+    {
+        numFound = 0;
+        numRead = 0;
+        numUnchanged = 0;
+        numUnreadable = 0;
+        bytesRead = 0;
+        progress = {};
+        startTime = juce::Time::getMillisecondCounterHiRes();
+        scanning = true;
+        startTimer(100);
+    }
+
+    // what the library has now, for the walker to check files against without touching the library
+    auto knownFiles = std::make_shared<KnownFiles>();
+    knownFiles->reserve((size_t) trackLibrary.getNumTracks());
+
+    for (int row = 0; row < trackLibrary.getNumTracks(); ++row)
+    {
+        const auto& track = trackLibrary.getTrack(row);
+        (*knownFiles)[track.path] = { track.fileSize, track.modificationTime };
+    }
+
+    addJob([this, filesAndFolders, knownFiles] { walk(filesAndFolders, knownFiles); });
+    return true;
+}
+
+void LibraryScanner::cancel()
+{
+    if (! scanning || cancelled)
+        return;
+
+    // queued jobs are deleted and count themselves off, running ones are asked to stop.
+    // A job the walker adds after this sees cancelled and returns without running
+    cancelled = true;
+    workers.removeAllJobs(true, 0);
+}
+
+bool LibraryScanner::isScanning() const
+{
+    return scanning;
+}
+
+const LibraryScanner::Progress& LibraryScanner::getProgress() const
+{
+    return progress;
+}
+
+void LibraryScanner::addListener(Listener* listener)
+{
+    listeners.add(listener);
+}
+
+void LibraryScanner::removeListener(Listener* listener)
+{
+    listeners.remove(listener);
+}
+
+//==============================================================================
+void LibraryScanner::addJob(std::function<void()> job)
+{
+    if (cancelled)
+        return;
+
+    // the destructor waits for every job to finish, however long it takes, before any
+    // member the job touches is destroyed
+    workers.addJob(new Job(*this, std::move(job)), true);
+}
+
+bool LibraryScanner::shouldExit() const
+{
+    auto* job = juce::ThreadPoolJob::getCurrentThreadPoolJob();
+    return cancelled || (job != nullptr && job->shouldExit());
+}
+
+void LibraryScanner::walk(const juce::Array<juce::File>& filesAndFolders, const std::shared_ptr<const KnownFiles>& knownFiles)
+{
+    const auto wildcard = formatManager.getWildcardForAllFormats();
+    juce::Array<juce::File> batch;
+
+    auto addFile = [&](const juce::File& file, juce::int64 fileSize, juce::Time modificationTime)
+    {
+        const auto known = knownFiles->find(file.getFullPathName());
+
+        if (known != knownFiles->end()
+            && known->second.fileSize == fileSize
+            && known->second.modificationTime == modificationTime.toMilliseconds())
+        {
+            ++numUnchanged;
+            return;
+        }
+
+        ++numFound;
+        batch.add(file);
+
+        // hand files on as they're found, so reading starts before the walk finishes
+        if (batch.size() == filesPerJob)
+        {
+            juce::Array<juce::File> files;
+            files.swapWith(batch);
+            addJob([this, files] { readBatch(files); });
+        }
+    };
+
+    for (const auto& file : filesAndFolders)
+    {
+        if (file.isDirectory())
+        {
+            // the iterator already has each file's size and date, so unchanged files cost nothing more
+            for (const auto& entry : juce::RangedDirectoryIterator(file, true, wildcard))
+            {
+                if (shouldExit())
+                    return;
+
+                addFile(entry.getFile(), entry.getFileSize(), entry.getModificationTime());
+            }
+        }
+        else if (file.existsAsFile())
+        {
+            addFile(file, file.getSize(), file.getLastModificationTime());
+        }
+    }
+
+    if (! batch.isEmpty())
+        addJob([this, batch] { readBatch(batch); });
+}
+
+void LibraryScanner::readBatch(const juce::Array<juce::File>& files)
+{
+    std::vector<LibraryTrack> tracks;
+    tracks.reserve((size_t) files.size());
+
+    for (const auto& file : files)
+    {
+        if (shouldExit())
+            break;
+
+        LibraryTrack track;
+
+        if (readTrackInfo(formatManager, file, track))
+            tracks.push_back(std::move(track));
+        else
+            ++numUnreadable;
+
+        ++numRead;
+        bytesRead += track.fileSize;
+    }
+
+    const juce::ScopedLock sl(resultsLock);
+    results.insert(results.end(), std::make_move_iterator(tracks.begin()), std::make_move_iterator(tracks.end()));
+}
+
+bool LibraryScanner::readTrackInfo(juce::AudioFormatManager& formatManager, const juce::File& file, LibraryTrack& track)
+{
+    std::unique_ptr<juce::InputStream> in(file.createInputStream());
+
+    if (in == nullptr)
+        return false;
+
+    track.path = file.getFullPathName();
+    track.fileSize = file.getSize();
+    track.modificationTime = file.getLastModificationTime().toMilliseconds();
+
+    // the formats that keep their tags where the readers don't look
+    const auto extension = file.getFileExtension().toLowerCase();
+
+    if (extension == ".mp3")
+        readID3Tags(*in, track);
+    else if (extension == ".flac")
+        readFlacTags(*in, track);
+
+    // opening a reader only parses the header, nothing is decoded until samples are read
+    in->setPosition(0);
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(std::move(in)));
+
+    if (reader == nullptr)
+        return false;
+
+    if (reader->sampleRate > 0)
+        track.durationSeconds = reader->lengthInSamples / reader->sampleRate;
+
+    // wav INFO chunks and ogg comments are read with the header
+    const auto& metadata = reader->metadataValues;
+
+    if (track.title.isEmpty())
+        track.title = metadata.getValue(juce::WavAudioFormat::riffInfoTitle, metadata.getValue("id3title", {})).trim();
+
+    if (track.artist.isEmpty())
+        track.artist = metadata.getValue(juce::WavAudioFormat::riffInfoArtist, metadata.getValue("id3artist", {})).trim();
+
+    if (track.title.isEmpty())
+        track.title = file.getFileNameWithoutExtension();
+
+    return true;
+}
+
+//==============================================================================
+void LibraryScanner::timerCallback()
+{
+    // checked before taking the results, as every job has added its tracks by the time it's counted off
+    const bool jobsFinished = numJobs.load() <= 0;
+
+    std::vector<LibraryTrack> newTracks;
+
+    {
+        const juce::ScopedLock sl(resultsLock);
+        newTracks.swap(results);
+    }
+
+    // one append to the library's log for everything read since the last tick
+    trackLibrary.addOrUpdate(newTracks);
+
+    progress.numFound = numFound.load();
+    progress.numRead = numRead.load();
+    progress.numUnchanged = numUnchanged.load();
+    progress.numUnreadable = numUnreadable.load();
+    progress.bytesRead = bytesRead.load();
+    progress.elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    progress.finished = jobsFinished;
+
+    if (jobsFinished)
+    {
+        stopTimer();
+        scanning = false;
+        cancelled = false; // nothing is left that could still see it
+
+        DBG("LibraryScanner: read " << progress.numRead << " files (" << progress.numUnchanged << " unchanged, "
+            << progress.numUnreadable << " unreadable) in " << progress.elapsedSeconds << "s - "
+            << progress.getFilesPerSecond() << " files/s, " << progress.getMegabytesPerSecond() << " MB/s");
+    }
+
+    listeners.call([this](Listener& l) { l.scanProgress(progress); });
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    LibraryScanner.h
+    Created: 18 Oct 2026 3:02:47am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TrackLibrary.h"
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+//==============================================================================
+/*
+    Imports files and whole folders into the track library on a pool of
+    background threads.
+
+    One job walks the folders and hands the audio files it finds to the rest
+    of the pool in batches. Those read each file's header for its length and
+    its tags for title, artist and key - nothing is ever decoded. Files that
+    are already in the library with the same size and modification time are
+    skipped, so scanning a folder again only reads what's new or changed.
+
+    Results are collected on the workers and handed to the library a batch
+    at a time from a timer, so rows appear in the table while the scan runs
+    and the message thread only does one small append per tick.
+
+    Apart from readTrackInfo, everything here is for the message thread.
+*/
+class LibraryScanner : private juce::Timer
+{
+public:
+    /** how far a scan has got, reported while it runs */
+    struct Progress
+    {
+        int numFound = 0;           // audio files found so far that needed reading
+        int numRead = 0;            // of those, how many have been read
+        int numUnchanged = 0;       // already in the library as they are on disk
+        int numUnreadable = 0;      // not in a format we can open
+        juce::int64 bytesRead = 0;  // total size of the files read
+        double elapsedSeconds = 0.0;
+        bool finished = false;
+
+        double getFilesPerSecond() const { return elapsedSeconds > 0.0 ? numRead / elapsedSeconds : 0.0; }
+        double getMegabytesPerSecond() const { return elapsedSeconds > 0.0 ? bytesRead / (1024.0 * 1024.0) / elapsedSeconds : 0.0; }
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** called on the message thread a few times a second while scanning, and once when it finishes */
+        virtual void scanProgress(const Progress& progress) = 0;
+    };
+
+    LibraryScanner(TrackLibrary& trackLibrary,
+                   juce::AudioFormatManager& formatManager,
+                   int numThreads = juce::SystemStats::getNumCpus());
+    ~LibraryScanner() override;
+
+    /** adds the files, and every audio file in and below the folders, to the library.
+        Can be called again while a scan is running - the new files join it. Returns false,
+        doing nothing, while a cancelled scan is still waiting for its jobs to stop */
+    bool scan(const juce::Array<juce::File>& filesAndFolders);
+
+    /** stops the scan, keeping whatever was read before it stopped. Doesn't wait: the scan
+        reports that it's finished once the jobs that were running have returned */
+    void cancel();
+
+    bool isScanning() const;
+
+    const Progress& getProgress() const;
+
+    void addListener(Listener* listener);
+    void removeListener(Listener* listener);
+
+    /** reads a file's length and tags on the calling thread, without decoding any of it.
+        Returns false if it isn't a file we can open */
+    static bool readTrackInfo(juce::AudioFormatManager& formatManager, const juce::File& file, LibraryTrack& track);
+
+private:
+    class Job;
+
+    struct KnownFile
+    {
+        juce::int64 fileSize = 0;
+        juce::int64 modificationTime = 0;
+    };
+
+    using KnownFiles = std::unordered_map<juce::String, KnownFile>;
+
+    void walk(const juce::Array<juce::File>& filesAndFolders, const std::shared_ptr<const KnownFiles>& knownFiles);
+    void readBatch(const juce::Array<juce::File>& files);
+    void addJob(std::function<void()> job);
+    bool shouldExit() const;
+    void timerCallback() override;
+
+    TrackLibrary& trackLibrary;
+    juce::AudioFormatManager& formatManager;
+
+    // tracks read on the workers, waiting for the timer to hand them to the library
+    juce::CriticalSection resultsLock;
+    std::vector<LibraryTrack> results;
+
+    // set until every job of a cancelled scan has gone, whether it ran or was taken off the queue
+    std::atomic<bool> cancelled{ false };
+    std::atomic<int> numJobs{ 0 };
+    std::atomic<int> numFound{ 0 }, numRead{ 0 }, numUnchanged{ 0 }, numUnreadable{ 0 };
+    std::atomic<juce::int64> bytesRead{ 0 };
+
+    // after everything the jobs write to, so if it's ever destroyed with a job still running
+    // that job's state outlives it
+    juce::ThreadPool workers;
+
+    Progress progress;
+    double startTime = 0.0;
+    bool scanning = false;
+
+    juce::ListenerList<Listener> listeners;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibraryScanner)
+};
@@ -23,7 +23,12 @@ public:
     //==============================================================================
     void initialise (const juce::String& commandLine) override
     {
-        mainWindow.reset (new MainWindow (getApplicationName()));
+        // e.g. --decks=4 for a four deck layout
+        const juce::ArgumentList args (getApplicationName(), commandLine);
+        const auto decksOption = args.getValueForOption ("--decks");
+        const int numDecks = decksOption.isNotEmpty() ? decksOption.getIntValue() : MainComponent::defaultNumDecks;
+
+        mainWindow.reset (new MainWindow (getApplicationName(), numDecks));
     }
 
     void shutdown() override
@@ -56,14 +61,14 @@ public:
     class MainWindow    : public juce::DocumentWindow
     {
     public:
-        MainWindow (juce::String name)
+        MainWindow (juce::String name, int numDecks)
             : DocumentWindow (name,
                               juce::Desktop::getInstance().getDefaultLookAndFeel()
                                                           .findColour (juce::ResizableWindow::backgroundColourId),
                               DocumentWindow::allButtons)
         {
             setUsingNativeTitleBar (true);
-            setContentOwned (new MainComponent(), true);
+            setContentOwned (new MainComponent (numDecks), true);
 
            #if JUCE_IOS || JUCE_ANDROID
             setFullScreen (true);
@@ -3,11 +3,13 @@
 #include <iomanip> // std::setprecision
 
 //==============================================================================
-MainComponent::MainComponent()
+MainComponent::MainComponent(int numDecks)
 {
-    // Make sure you set the size of the component after
-    // you add any child components.
-    setSize (1300, 900);
+    // the decks go in before the audio starts, so the mixer prepares them with the device
+    for (int i = 0; i < juce::jlimit(1, maxDecks, numDecks); ++i)
+        addDeck();
+
+    playlistComponent = std::make_unique<PlaylistComponent>(formatManager, beatAnalyser, trackLibrary, libraryScanner, deckGUIs);
 
     // Some platforms require permissions to open input channels so request that here
     if (juce::RuntimePermissions::isRequired (juce::RuntimePermissions::recordAudio)
@@ -22,10 +24,23 @@ MainComponent::MainComponent()
         setAudioChannels (0, 2);
     }
 
-    addAndMakeVisible((deckGUI1));
-    addAndMakeVisible((deckGUI2));
-    addAndMakeVisible(playlistComponent);
+    crossfader.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+    crossfader.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::NoTextBox, true, 0, 0);
+    crossfader.setRange(0.0, 1.0);
+    crossfader.setValue(0.5);
+    crossfader.setDoubleClickReturnValue(true, 0.5);
+    crossfader.onValueChange = [this] { mixer.setCrossfader((float) crossfader.getValue()); };
+
+    addAndMakeVisible(crossfader);
+    addAndMakeVisible(*playlistComponent);
+    addChildComponent(instrumentationOverlay);
+    setWantsKeyboardFocus(true);
     formatManager.registerBasicFormats();
+
+    // Make sure you set the size of the component after
+    // you add any child components.
+    const int deckRows = (deckGUIs.size() + 1) / 2;
+    setSize (1300, 600 + 300 * deckRows);
 }
 
 MainComponent::~MainComponent()
@@ -34,23 +49,49 @@ MainComponent::~MainComponent()
     shutdownAudio();
 }
 
+void MainComponent::addDeck()
+{
+    const int deckNumber = players.size() + 1;
+
+    auto* player = players.add(new DJAudioPlayer(trackLoader));
+    auto* deckGUI = deckGUIs.add(new DeckGUI(player, formatManager, thumbnailCache, peakStore, beatAnalyser, deckSync, deckNumber));
+
+    // odd decks on the left of the crossfader, even decks on the right
+    mixer.addDeck(player, deckNumber % 2 == 1 ? DeckMixer::Side::a : DeckMixer::Side::b);
+
+    addAndMakeVisible(deckGUI);
+}
+
 //==============================================================================
 void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
 {
     // This function will be called when the audio device is started, or when
     // its settings (i.e. sample rate, block size, etc) are changed.
 
-    player1.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    player2.prepareToPlay(samplesPerBlockExpected, sampleRate);
-
-    mixerSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    mixerSource.addInputSource(&player1, false);
-    mixerSource.addInputSource(&player2, false);
+    // the mixer prepares the decks, which were added to it once in the constructor
+    mixer.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    instrumentation.prepare(sampleRate);
 }
 
 void MainComponent::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
 {
-    mixerSource.getNextAudioBlock(bufferToFill);
+    instrumentation.callbackStarted();
+
+    const auto syncStart = juce::Time::getHighResolutionTicks();
+    deckSync.process(bufferToFill.numSamples); // sets the followers' speeds before the decks render
+    instrumentation.addStageTime(AudioInstrumentation::sync, juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - syncStart));
+
+    mixer.getNextAudioBlock(bufferToFill);
+
+    for (auto* player : players)
+    {
+        const auto times = player->getLastStageTimes();
+        instrumentation.addStageTime(AudioInstrumentation::resample, times.resampleSeconds);
+        instrumentation.addStageTime(AudioInstrumentation::eq, times.eqSeconds);
+    }
+
+    instrumentation.addStageTime(AudioInstrumentation::mix, mixer.getLastMixSeconds());
+    instrumentation.callbackFinished(bufferToFill.numSamples);
 }
 
 void MainComponent::releaseResources()
@@ -59,9 +100,7 @@ void MainComponent::releaseResources()
     // restarted due to a setting change.
 
     // For more details, see the help for AudioProcessor::releaseResources()
-    player1.releaseResources();
-    player2.releaseResources();
-    mixerSource.releaseResources();
+    mixer.releaseResources();
 }
 
 //==============================================================================
@@ -78,25 +117,43 @@ void MainComponent::resized()
     // This is called when the MainContentComponent is resized.
 
 
-    // Define dimensions for the decks
-    int deckWidth = getWidth() / 2;
-    int deckHeight = static_cast<int>(getHeight() * (2.0 / 3.0));  // Allocate 2/3 of the height for the decks
-
+    // Define dimensions for the decks, two to a row
+    const int deckRows = (deckGUIs.size() + 1) / 2;
+    const int crossfaderHeight = 40;
+    int deckWidth = deckGUIs.size() > 1 ? getWidth() / 2 : getWidth();
+    int deckAreaHeight = static_cast<int>(getHeight() * (2.0 / 3.0)) - crossfaderHeight;  // Allocate 2/3 of the height for the decks
+    int deckHeight = deckAreaHeight / deckRows;
 
     // Set bounds for the decks
-    deckGUI1.setBounds(0, 0, deckWidth, deckHeight);
-    deckGUI2.setBounds(deckWidth, 0, deckWidth, deckHeight);
+    for (int i = 0; i < deckGUIs.size(); ++i)
+        deckGUIs[i]->setBounds((i % 2) * deckWidth, (i / 2) * deckHeight, deckWidth, deckHeight);
+
+    crossfader.setBounds(getWidth() / 4, deckAreaHeight, getWidth() / 2, crossfaderHeight);
 
     //deckGUI1.setBounds(0, 0, getWidth() / 2, getHeight()/1.5);
     //deckGUI2.setBounds(getWidth() / 2, 0, getWidth()/2, getHeight()/1.5);
 
     // Define dimensions and position for the playlistComponent
-    int playlistYPosition = deckHeight;
-    int playlistHeight = getHeight() - deckHeight;  // Remaining height after positioning the decks
+    int playlistYPosition = deckAreaHeight + crossfaderHeight;
+    int playlistHeight = getHeight() - playlistYPosition;  // Remaining height after positioning the decks
 
     // Set bounds for the playlistComponent
-    playlistComponent.setBounds(0, playlistYPosition, getWidth(), playlistHeight);
+    playlistComponent->setBounds(0, playlistYPosition, getWidth(), playlistHeight);
+
+    instrumentationOverlay.setBounds(getWidth() - 520, 10, 510, 200);
 
     //playlistComponent.setBounds(0, getHeight()/1.5, getWidth(), getHeight());
     // playlistComponent.setBounds(0, getHeight()/1.5, getWidth(), getHeight()/2);
 }
+
+bool MainComponent::keyPressed(const juce::KeyPress& key)
+{
+    if (key == juce::KeyPress('i', juce::ModifierKeys::commandModifier, 0))
+    {
+        instrumentationOverlay.setVisible(! instrumentationOverlay.isVisible());
+        instrumentationOverlay.toFront(false);
+        return true;
+    }
+
+    return false;
+}
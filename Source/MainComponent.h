@@ -1,9 +1,21 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BeatAnalyser.h"
+#include "AudioInstrumentation.h"
 #include "DJAudioPlayer.h"
 #include "DeckGUI.h"
+#include "DeckMixer.h"
+#include "DeckRenderGroup.h"
+#include "DeckSync.h"
+#include "InstrumentationOverlay.h"
+#include "LibraryScanner.h"
+#include "PeakStore.h"
 #include "PlaylistComponent.h"
+#include "ReadAheadThreadPool.h"
+#include "TrackCache.h"
+#include "TrackLibrary.h"
+#include "TrackLoader.h"
 
 //==============================================================================
 /*
@@ -14,7 +26,10 @@ class MainComponent : public juce::AudioAppComponent
 {
     public:
         //==============================================================================
-        MainComponent();
+        static constexpr int defaultNumDecks = 2;
+        static constexpr int maxDecks = DeckMixer::maxDecks;
+
+        explicit MainComponent(int numDecks = defaultNumDecks);
         ~MainComponent() override;
 
         void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
@@ -26,6 +41,9 @@ class MainComponent : public juce::AudioAppComponent
         void paint (juce::Graphics& g) override;
         void resized() override;
 
+        /** ctrl/cmd + I shows or hides the audio instrumentation overlay */
+        bool keyPressed(const juce::KeyPress& key) override;
+
 
     private:
         //==============================================================================
@@ -34,16 +52,48 @@ class MainComponent : public juce::AudioAppComponent
         juce::AudioFormatManager formatManager;
         juce::AudioThumbnailCache thumbnailCache{100};
 
-        int deckNum;
-        DJAudioPlayer player1{formatManager};
-        DeckGUI deckGUI1{ &player1, formatManager, thumbnailCache, deckNum=1 };
+        // waveform peaks saved to disk, so each track is only scanned once
+        PeakStore peakStore{ formatManager };
+
+        // background threads that decode ahead of the playhead for the decks
+        ReadAheadThreadPool readAheadPool{ 2 };
+
+        // decoded copies of recently loaded tracks, shared by all the decks
+        TrackCache trackCache{ formatManager };
+
+        // opens and pre-buffers tracks off the message thread
+        TrackLoader trackLoader{ formatManager, readAheadPool, &trackCache };
+
+        // tempo and beat grids, worked out in the background and saved to disk
+        BeatAnalyser beatAnalyser{ formatManager };
+
+        // every track in the playlist, saved as a snapshot plus a log of the edits since
+        TrackLibrary trackLibrary;
+
+        // imports files and folders into the library, reading only their headers and tags
+        LibraryScanner libraryScanner{ trackLibrary, formatManager };
+
+        // keeps a following deck's tempo and beats locked to the leader
+        DeckSync deckSync;
+
+        // the decks, each a player and its controls, in the order they're numbered
+        juce::OwnedArray<DJAudioPlayer> players;
+        juce::OwnedArray<DeckGUI> deckGUIs;
+
+        // realtime threads the decks render on in parallel, on machines with cores to spare
+        DeckRenderGroup renderGroup;
+
+        // the decks to the master bus, through the crossfader and limiter
+        DeckMixer mixer{ &renderGroup };
+        juce::Slider crossfader;
 
-        DJAudioPlayer player2{ formatManager };
-        DeckGUI deckGUI2{ &player2, formatManager, thumbnailCache, deckNum = 2 };
+        std::unique_ptr<PlaylistComponent> playlistComponent;
 
-        juce::MixerAudioSource mixerSource;
+        // per-callback timings from the audio thread, and the overlay that shows them
+        AudioInstrumentation instrumentation;
+        InstrumentationOverlay instrumentationOverlay{ instrumentation, deviceManager };
 
-        PlaylistComponent playlistComponent{ formatManager, &deckGUI1, &deckGUI2 };
+        void addDeck();
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainComponent)
 };
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    MappedTrackSource.cpp
+    Created: 17 Oct 2026 2:30:16pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "MappedTrackSource.h"
+
+MappedTrackSource::MappedTrackSource(std::unique_ptr<juce::MemoryMappedAudioFormatReader> _reader,
+                                     juce::TimeSliceThread& _thread,
+                                     int _readAheadSamples,
+                                     ReadAheadStats& _stats)
+                                     : reader(std::move(_reader)),
+                                       thread(_thread),
+                                       stats(_stats),
+                                       readAheadSamples(juce::jmax(8192, _readAheadSamples)),
+                                       samplesPerPage(juce::jmax(1, 4096 / juce::jmax(1, (int) (reader->bitsPerSample / 8 * reader->numChannels))))
+{
+    thread.addTimeSliceClient(this);
+}
+
+MappedTrackSource::~MappedTrackSource()
+{
+    thread.removeTimeSliceClient(this);
+}
+
+void MappedTrackSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{}
+
+void MappedTrackSource::releaseResources()
+{}
+
+void MappedTrackSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    auto pos = nextReadPos.load();
+    const int numSamples = bufferToFill.numSamples;
+    const int numToCopy = pos < 0 ? 0 : (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, getTotalLength() - pos);
+
+    stats.blocksRead++;
+
+    if (numToCopy > 0)
+    {
+        if (! isTouched(pos, numToCopy)) // still plays, but may have to wait for the disk
+        {
+            stats.coldReads++;
+            stats.samplesReadCold += numToCopy;
+        }
+
+        reader->read(bufferToFill.buffer, bufferToFill.startSample, numToCopy, pos, true, true);
+    }
+
+    if (numToCopy < numSamples)
+        bufferToFill.buffer->clear(bufferToFill.startSample + numToCopy, numSamples - numToCopy);
+
+    nextReadPos.compare_exchange_strong(pos, pos + numSamples);
+}
+
+void MappedTrackSource::setNextReadPosition(juce::int64 newPosition)
+{
+    nextReadPos.store(newPosition);
+}
+
+juce::int64 MappedTrackSource::getNextReadPosition() const
+{
+    return nextReadPos.load();
+}
+
+juce::int64 MappedTrackSource::getTotalLength() const
+{
+    return reader->lengthInSamples;
+}
+
+bool MappedTrackSource::isLooping() const
+{
+    return false;
+}
+
+bool MappedTrackSource::waitForBufferedSamples(int numSamples, int timeoutMs)
+{
+    const auto startTime = juce::Time::getMillisecondCounter();
+
+    for (;;)
+    {
+        const auto pos = nextReadPos.load();
+        const int needed = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, getTotalLength() - pos);
+
+        if (needed == 0 || isTouched(pos, needed))
+            return true;
+
+        if (juce::Time::getMillisecondCounter() - startTime > (juce::uint32) timeoutMs)
+            return false;
+
+        juce::Thread::sleep(2);
+    }
+}
+
+bool MappedTrackSource::isTouched(juce::int64 start, int numSamples) const
+{
+    return touchedStart.load() <= start && start + numSamples <= touchedEnd.load();
+}
+
+int MappedTrackSource::useTimeSlice()
+{
+    const auto pos = juce::jmax((juce::int64) 0, nextReadPos.load());
+    auto end = touchedEnd.load();
+
+    if (pos < touchedStart.load() || pos > end) // seeked away, start touching from the new position
+    {
+        touchedStart.store(std::numeric_limits<juce::int64>::max());
+        touchedEnd.store(pos);
+        touchedStart.store(pos);
+        end = pos;
+    }
+
+    const auto target = juce::jmin(pos + readAheadSamples, getTotalLength());
+
+    if (end >= target)
+        return 2;
+
+    // touch a slice at a time so a slow disk can't hold up the other tracks on this thread
+    const auto sliceEnd = juce::jmin(target, end + (juce::int64) samplesPerPage * 64);
+
+    for (auto sample = end; sample < sliceEnd; sample += samplesPerPage)
+        reader->touchSample(sample);
+
+    touchedEnd.store(sliceEnd);
+
+    // pages well behind the playhead are the OS's to drop, we no longer count on them
+    touchedStart.store(juce::jmax(touchedStart.load(), pos - readAheadSamples));
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    MappedTrackSource.h
+    Created: 17 Oct 2026 2:30:16pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include "ReadAheadSource.h"
+
+//==============================================================================
+/*
+    Plays an uncompressed file (WAV or AIFF) through a memory-mapped reader, so
+    samples are converted straight out of the OS page cache with no stream or
+    ring buffer copies in between. Opening is just a map call, however long
+    the file is.
+
+    The audio thread shouldn't be the one to fault pages in from disk, so a
+    read-ahead thread touches the pages just ahead of the playhead. Blocks that
+    reach past what has been touched still play, but are counted as cold reads
+    rather than underruns, as nothing is output as silence.
+*/
+class MappedTrackSource : public juce::PositionableAudioSource,
+                          private juce::TimeSliceClient
+{
+public:
+    MappedTrackSource(std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader,
+                      juce::TimeSliceThread& thread,
+                      int readAheadSamples,
+                      ReadAheadStats& stats);
+    ~MappedTrackSource() override;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    void setNextReadPosition(juce::int64 newPosition) override;
+    juce::int64 getNextReadPosition() const override;
+    juce::int64 getTotalLength() const override;
+    bool isLooping() const override;
+
+    /** blocks the calling thread until numSamples at the read position have been paged in */
+    bool waitForBufferedSamples(int numSamples, int timeoutMs);
+
+private:
+    int useTimeSlice() override;
+
+    bool isTouched(juce::int64 start, int numSamples) const;
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader;
+    juce::TimeSliceThread& thread;
+    ReadAheadStats& stats;
+
+    const int readAheadSamples;
+    const int samplesPerPage;
+
+    std::atomic<juce::int64> nextReadPos{ 0 };
+    std::atomic<juce::int64> touchedStart{ 0 };
+    std::atomic<juce::int64> touchedEnd{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MappedTrackSource)
+};
@@ -0,0 +1,279 @@
+/*
+  ==============================================================================
+
+    PeakFile.cpp
+    Created: 17 Oct 2026 3:20:42pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "PeakFile.h"
+
+namespace
+{
+    const char peakFileMagic[4] = { 'O', 'T', 'P', 'K' };
+    const int headerSize = 4 + 4 + 8 + 8 + 4 + 8 + 8 + 4 + 4; // plus the path's bytes
+    const int levelEntrySize = 4 + 4 + 8;
+    const int minPeaksInCoarsestLevel = 64;
+
+    PeakFile::Peak makePeak(float min, float max, float rms)
+    {
+        PeakFile::Peak peak;
+        peak.min = (juce::int8) juce::jlimit(-127, 127, juce::roundToInt(min * 127.0f));
+        peak.max = (juce::int8) juce::jlimit(-127, 127, juce::roundToInt(max * 127.0f));
+        peak.rms = (juce::uint8) juce::jlimit(0, 255, juce::roundToInt(rms * 255.0f));
+        peak.unused = 0;
+        return peak;
+    }
+}
+
+PeakFile::~PeakFile()
+{}
+
+juce::File PeakFile::getPeakFileFor(const juce::File& audioFile, const juce::File& peakDirectory)
+{
+    return peakDirectory.getChildFile(juce::String::toHexString(audioFile.getFullPathName().hashCode64()) + ".otpk");
+}
+
+std::unique_ptr<PeakFile> PeakFile::open(const juce::File& audioFile, const juce::File& peakDirectory)
+{
+    const auto peakFile = getPeakFileFor(audioFile, peakDirectory);
+
+    if (! peakFile.existsAsFile() || ! audioFile.existsAsFile())
+        return nullptr;
+
+    std::unique_ptr<PeakFile> result(new PeakFile());
+    result->map = std::make_unique<juce::MemoryMappedFile>(peakFile, juce::MemoryMappedFile::readOnly);
+
+    const auto* data = static_cast<const char*>(result->map->getData());
+    const auto size = (juce::int64) result->map->getSize();
+
+    if (data == nullptr || size < headerSize || std::memcmp(data, peakFileMagic, 4) != 0)
+        return nullptr;
+
+    juce::MemoryInputStream header(data + 4, (size_t) size - 4, false);
+
+    if ((juce::uint32) header.readInt() != currentVersion)
+        return nullptr;
+
+    // stale if the audio has changed since we built it
+    const auto sourceSize = header.readInt64();
+    const auto sourceModificationTime = header.readInt64();
+
+    if (sourceSize != audioFile.getSize() || sourceModificationTime != audioFile.getLastModificationTime().toMilliseconds())
+        return nullptr;
+
+    // or if it's another file's, whose path has the same hash
+    const auto pathBytes = (juce::int64) (juce::uint32) header.readInt();
+    const auto* pathData = data + 4 + header.getPosition();
+    const auto expectedPath = audioFile.getFullPathName();
+
+    if (headerSize + pathBytes > size
+        || pathBytes != (juce::int64) expectedPath.getNumBytesAsUTF8()
+        || std::memcmp(pathData, expectedPath.toRawUTF8(), (size_t) pathBytes) != 0)
+        return nullptr;
+
+    header.skipNextBytes(pathBytes);
+    const auto levelsStart = headerSize + pathBytes;
+
+    result->sampleRate = header.readDouble();
+    result->lengthInSamples = header.readInt64();
+    result->numChannels = header.readInt();
+    const int numLevels = header.readInt();
+
+    if (result->numChannels <= 0 || numLevels <= 0 || levelsStart + (juce::int64) numLevels * levelEntrySize > size)
+        return nullptr;
+
+    for (int i = 0; i < numLevels; ++i)
+    {
+        Level level;
+        level.samplesPerPeak = header.readInt();
+        level.numPeaks = header.readInt();
+        const auto offset = header.readInt64();
+
+        const auto bytes = (juce::int64) level.numPeaks * result->numChannels * (juce::int64) sizeof(Peak);
+
+        if (level.samplesPerPeak <= 0 || level.numPeaks <= 0 || offset < levelsStart || offset + bytes > size)
+            return nullptr;
+
+        level.peaks = reinterpret_cast<const Peak*>(data + offset);
+        result->levels.push_back(level);
+    }
+
+    return result;
+}
+
+bool PeakFile::build(juce::AudioFormatManager& formatManager,
+                     const juce::File& audioFile,
+                     const juce::File& peakDirectory,
+                     std::function<bool()> shouldAbort,
+                     juce::AudioThumbnail* preview)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(audioFile));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+        return false;
+
+    const int numChannels = (int) juce::jmin(2u, reader->numChannels);
+    const auto length = reader->lengthInSamples;
+    const auto numBasePeaks = (length + baseSamplesPerPeak - 1) / baseSamplesPerPeak;
+
+    if (numBasePeaks > std::numeric_limits<int>::max())
+        return false;
+
+    if (preview != nullptr)
+        preview->reset(numChannels, reader->sampleRate, length);
+
+    // finest level, straight from the audio
+    std::vector<std::vector<Peak>> levelData(1);
+    std::vector<int> levelSamplesPerPeak{ baseSamplesPerPeak };
+    levelData[0].reserve((size_t) numBasePeaks * (size_t) numChannels);
+
+    const int peaksPerChunk = 256;
+    juce::AudioBuffer<float> buffer(numChannels, baseSamplesPerPeak * peaksPerChunk);
+
+    for (juce::int64 pos = 0; pos < length; pos += buffer.getNumSamples())
+    {
+        if (shouldAbort != nullptr && shouldAbort())
+            return false;
+
+        const int numToRead = (int) juce::jmin((juce::int64) buffer.getNumSamples(), length - pos);
+        reader->read(&buffer, 0, numToRead, pos, true, true);
+
+        if (preview != nullptr)
+            preview->addBlock(pos, buffer, 0, numToRead);
+
+        for (int start = 0; start < numToRead; start += baseSamplesPerPeak)
+        {
+            const int count = juce::jmin(baseSamplesPerPeak, numToRead - start);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const float* samples = buffer.getReadPointer(ch, start);
+                const auto range = juce::FloatVectorOperations::findMinAndMax(samples, count);
+
+                float sumOfSquares = 0.0f;
+                for (int i = 0; i < count; ++i)
+                    sumOfSquares += samples[i] * samples[i];
+
+                levelData[0].push_back(makePeak(range.getStart(), range.getEnd(), std::sqrt(sumOfSquares / (float) count)));
+            }
+        }
+    }
+
+    // each coarser level combines 4 peaks of the one before
+    while ((int) (levelData.back().size() / (size_t) numChannels) > minPeaksInCoarsestLevel)
+    {
+        const auto& finer = levelData.back();
+        const int finerPeaks = (int) (finer.size() / (size_t) numChannels);
+        const int numPeaks = (finerPeaks + 3) / 4;
+
+        std::vector<Peak> coarser;
+        coarser.reserve((size_t) numPeaks * (size_t) numChannels);
+
+        for (int i = 0; i < numPeaks; ++i)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                int min = 127, max = -127;
+                float sumOfSquares = 0.0f;
+                int count = 0;
+
+                for (int j = i * 4; j < juce::jmin(i * 4 + 4, finerPeaks); ++j, ++count)
+                {
+                    const auto& p = finer[(size_t) j * (size_t) numChannels + (size_t) ch];
+                    min = juce::jmin(min, (int) p.min);
+                    max = juce::jmax(max, (int) p.max);
+                    sumOfSquares += (p.rms / 255.0f) * (p.rms / 255.0f);
+                }
+
+                coarser.push_back(makePeak(min / 127.0f, max / 127.0f, std::sqrt(sumOfSquares / (float) count)));
+            }
+        }
+
+        levelSamplesPerPeak.push_back(levelSamplesPerPeak.back() * 4);
+        levelData.push_back(std::move(coarser));
+    }
+
+    // write to a temporary file and swap it in, so a reader never sees half a file
+    if (! peakDirectory.createDirectory())
+        return false;
+
+    const auto target = getPeakFileFor(audioFile, peakDirectory);
+    const auto path = audioFile.getFullPathName();
+    juce::TemporaryFile temp(target);
+
+    {
+        juce::FileOutputStream out(temp.getFile());
+
+        if (! out.openedOk())
+            return false;
+
+        out.write(peakFileMagic, 4);
+        out.writeInt((int) currentVersion);
+        out.writeInt64(audioFile.getSize());
+        out.writeInt64(audioFile.getLastModificationTime().toMilliseconds());
+        out.writeInt((int) path.getNumBytesAsUTF8());
+        out.write(path.toRawUTF8(), path.getNumBytesAsUTF8());
+        out.writeDouble(reader->sampleRate);
+        out.writeInt64(length);
+        out.writeInt(numChannels);
+        out.writeInt((int) levelData.size());
+
+        juce::int64 offset = headerSize + (juce::int64) path.getNumBytesAsUTF8() + (juce::int64) levelData.size() * levelEntrySize;
+
+        for (size_t i = 0; i < levelData.size(); ++i)
+        {
+            out.writeInt(levelSamplesPerPeak[i]);
+            out.writeInt((int) (levelData[i].size() / (size_t) numChannels));
+            out.writeInt64(offset);
+            offset += (juce::int64) (levelData[i].size() * sizeof(Peak));
+        }
+
+        for (const auto& level : levelData)
+            out.write(level.data(), level.size() * sizeof(Peak));
+
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+double PeakFile::getSampleRate() const
+{
+    return sampleRate;
+}
+
+juce::int64 PeakFile::getLengthInSamples() const
+{
+    return lengthInSamples;
+}
+
+int PeakFile::getNumChannels() const
+{
+    return numChannels;
+}
+
+int PeakFile::getNumLevels() const
+{
+    return (int) levels.size();
+}
+
+const PeakFile::Level& PeakFile::getLevel(int index) const
+{
+    return levels[(size_t) juce::jlimit(0, getNumLevels() - 1, index)];
+}
+
+const PeakFile::Level& PeakFile::getLevelFor(double samplesPerPixel) const
+{
+    size_t best = 0;
+
+    for (size_t i = 1; i < levels.size() && levels[i].samplesPerPeak <= samplesPerPixel; ++i)
+        best = i;
+
+    return levels[best];
+}
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    PeakFile.h
+    Created: 17 Oct 2026 3:20:42pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/*
+    A pre-computed waveform overview of an audio file, stored on disk so it only
+    ever has to be generated once.
+
+    The file holds several levels of min/max/RMS peaks, each covering 4x as many
+    samples per peak as the one before, so a display of any width can pick a
+    level that's close to one peak per pixel. Once written, it's memory-mapped
+    rather than read, which makes opening it practically free.
+
+    File layout (all little-endian):
+        "OTPK", uint32 version
+        int64 source file size, int64 source modification time (ms since 1970)
+        uint32 source path length, source path (UTF-8, no terminator)
+        double sample rate, int64 length in samples, uint32 channels, uint32 levels
+        per level: uint32 samples per peak, uint32 number of peaks, int64 data offset
+        per level: numPeaks * numChannels Peaks, channels interleaved
+
+    Peak files are named after a hash of the audio file's path, so the path is
+    stored too, in case two files share a hash. A peak file is stale (and gets
+    rebuilt) if it was built for another path, or the audio file's size or
+    modification time no longer match the ones it was built from.
+*/
+class PeakFile
+{
+public:
+    static constexpr juce::uint32 currentVersion = 2;
+    static constexpr int baseSamplesPerPeak = 256;
+
+    struct Peak
+    {
+        juce::int8 min;     // -127..127
+        juce::int8 max;     // -127..127
+        juce::uint8 rms;    // 0..255
+        juce::uint8 unused;
+    };
+
+    struct Level
+    {
+        int samplesPerPeak = 0;
+        int numPeaks = 0;
+        const Peak* peaks = nullptr; // numPeaks * numChannels
+
+        const Peak& get(int index, int channel, int numChannels) const { return peaks[(size_t) index * (size_t) numChannels + (size_t) channel]; }
+    };
+
+    ~PeakFile();
+
+    /** where the peak file for audioFile lives inside peakDirectory */
+    static juce::File getPeakFileFor(const juce::File& audioFile, const juce::File& peakDirectory);
+
+    /** maps the peak file for audioFile, or returns nullptr if there isn't an up-to-date one */
+    static std::unique_ptr<PeakFile> open(const juce::File& audioFile, const juce::File& peakDirectory);
+
+    /** decodes audioFile and writes its peak file, replacing any old one. shouldAbort is polled
+        between chunks so a long decode can be cancelled. If preview isn't null, it's fed the audio
+        as it's decoded, so a waveform can be drawn before the peaks are finished. Returns true if
+        the file was written */
+    static bool build(juce::AudioFormatManager& formatManager,
+                      const juce::File& audioFile,
+                      const juce::File& peakDirectory,
+                      std::function<bool()> shouldAbort = nullptr,
+                      juce::AudioThumbnail* preview = nullptr);
+
+    double getSampleRate() const;
+    juce::int64 getLengthInSamples() const;
+    int getNumChannels() const;
+    int getNumLevels() const;
+    const Level& getLevel(int index) const;
+
+    /** the coarsest level that still has at least one peak per pixel, so nothing is skipped when drawing */
+    const Level& getLevelFor(double samplesPerPixel) const;
+
+private:
+    PeakFile() = default;
+
+    std::unique_ptr<juce::MemoryMappedFile> map;
+    double sampleRate = 0.0;
+    juce::int64 lengthInSamples = 0;
+    int numChannels = 0;
+    std::vector<Level> levels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PeakFile)
+};
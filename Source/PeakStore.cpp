@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    PeakStore.cpp
+    Created: 17 Oct 2026 3:41:09pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "PeakStore.h"
+
+PeakStore::PeakStore(juce::AudioFormatManager& _formatManager,
+                     juce::File _peakDirectory)
+                     : formatManager(_formatManager),
+                       peakDirectory(_peakDirectory)
+{}
+
+PeakStore::~PeakStore()
+{
+    builders.removeAllJobs(true, -1); // a build checks shouldExit between blocks, so this is quick
+}
+
+std::shared_ptr<const PeakFile> PeakStore::getOrBuild(const juce::File& audioFile, Callback onReady)
+{
+    if (auto peaks = PeakFile::open(audioFile, peakDirectory))
+        return std::shared_ptr<const PeakFile>(std::move(peaks));
+
+    const auto path = audioFile.getFullPathName();
+    auto& build = pending[path];
+    const bool alreadyBuilding = ! build.callbacks.empty();
+    build.callbacks.push_back(std::move(onReady));
+
+    if (alreadyBuilding)
+        return nullptr;
+
+    build.preview = std::make_shared<juce::AudioThumbnail>(1000, formatManager, previewCache);
+    juce::WeakReference<PeakStore> weakThis(this);
+
+    // the job only reads formatManager and peakDirectory, which are declared before builders, and
+    // the destructor waits for it without a time limit. 'pending' is left to the message thread.
+    // A thumbnail can be fed from any thread, and the job keeps its own reference to the preview
+    builders.addJob([this, weakThis, audioFile, path, preview = build.preview]() mutable
+    {
+        const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+        const bool built = PeakFile::build(formatManager, audioFile, peakDirectory, []
+        {
+            auto* job = juce::ThreadPoolJob::getCurrentThreadPoolJob();
+            return job != nullptr && job->shouldExit();
+        }, preview.get());
+
+        std::shared_ptr<const PeakFile> peaks(built ? PeakFile::open(audioFile, peakDirectory) : nullptr);
+
+        DBG("PeakStore: " << (peaks != nullptr ? "built" : "failed to build") << " peaks for "
+            << audioFile.getFileName() << " in " << juce::Time::getMillisecondCounterHiRes() - startTime << " ms");
+
+        // the preview goes along so its last reference is always dropped on the message thread
+        juce::MessageManager::callAsync([weakThis, path, peaks, preview = std::move(preview)]
+        {
+            if (weakThis == nullptr)
+                return;
+
+            auto build = std::move(weakThis->pending[path]);
+            weakThis->pending.erase(path);
+
+            for (auto& callback : build.callbacks)
+                if (callback)
+                    callback(peaks);
+        });
+    });
+
+    return nullptr;
+}
+
+std::shared_ptr<juce::AudioThumbnail> PeakStore::getPreview(const juce::File& audioFile) const
+{
+    auto it = pending.find(audioFile.getFullPathName());
+    return it != pending.end() ? it->second.preview : nullptr;
+}
+
+juce::File PeakStore::getPeakDirectory() const
+{
+    return peakDirectory;
+}
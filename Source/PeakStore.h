@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    PeakStore.h
+    Created: 17 Oct 2026 3:41:09pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <map>
+#include <vector>
+#include "PeakFile.h"
+
+//==============================================================================
+/*
+    Hands out the peak files for tracks, building any that are missing or
+    stale on a background thread.
+
+    Peak files live in a "peaks" folder next to the playlist, so a track's
+    waveform is only ever scanned once, however many times it gets loaded.
+*/
+class PeakStore
+{
+public:
+    PeakStore(juce::AudioFormatManager& formatManager,
+              juce::File peakDirectory = juce::File::getCurrentWorkingDirectory().getChildFile("peaks"));
+    ~PeakStore();
+
+    /** called on the message thread with the peaks, or nullptr if they couldn't be built */
+    using Callback = std::function<void(std::shared_ptr<const PeakFile>)>;
+
+    /** returns the peaks straight away if there's an up-to-date peak file. Otherwise
+        returns nullptr, builds the file in the background and calls onReady once it's done */
+    std::shared_ptr<const PeakFile> getOrBuild(const juce::File& audioFile, Callback onReady);
+
+    /** while a file's peaks are being built, a thumbnail that fills in from the same decode,
+        so nothing has to read the file a second time to draw it in the meantime. nullptr otherwise */
+    std::shared_ptr<juce::AudioThumbnail> getPreview(const juce::File& audioFile) const;
+
+    juce::File getPeakDirectory() const;
+
+private:
+    struct Build
+    {
+        std::vector<Callback> callbacks;
+        std::shared_ptr<juce::AudioThumbnail> preview;
+    };
+
+    juce::AudioFormatManager& formatManager;
+    const juce::File peakDirectory;
+    juce::AudioThumbnailCache previewCache{ 1 }; // the previews never use it, but a thumbnail needs one
+    juce::ThreadPool builders{ 1 };
+
+    // each file that's being built, so a file is never built twice at once
+    std::map<juce::String, Build> pending;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (PeakStore)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PeakStore)
+};
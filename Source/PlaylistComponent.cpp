@@ -12,60 +12,89 @@
 #include "PlaylistComponent.h"
 
 //==============================================================================
-PlaylistComponent::PlaylistComponent(juce::AudioFormatManager& _formatManager, DeckGUI* _deck1, DeckGUI* _deck2)
-                                     : formatManager(_formatManager),
-                                       deck1(_deck1), 
-                                       deck2(_deck2)
+PlaylistComponent::PlaylistComponent(juce::AudioFormatManager& _formatManager,
+                                     BeatAnalyser& _beatAnalyser,
+                                     TrackLibrary& _trackLibrary,
+                                     LibraryScanner& _libraryScanner,
+                                     const juce::OwnedArray<DeckGUI>& _decks)
+                                     : trackLibrary(_trackLibrary),
+                                       libraryScanner(_libraryScanner),
+                                       formatManager(_formatManager),
+                                       beatAnalyser(_beatAnalyser),
+                                       decks(_decks)
 {
-    if (std::filesystem::exists("playlist.csv")) // checks if playlist file exists
+    // checked before loading, as loading starts an empty log
+    const bool libraryIsNew = ! trackLibrary.existsOnDisk();
+    const auto loaded = trackLibrary.load();
+
+    if (loaded.failed())
     {
-        std::string playlistFile = "playlist.csv";
-        try
-        {
-            readFromPlaylistFile(playlistFile);
-        }
-        catch (const std::exception& e)
-        {
-            // If file is empty or corrupted, show error message box
-            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon,
-                "Playlist Error",
-                "Could not open or read from playlist file. File is empty or has been corrupted."
-                "OK"
-            );
-
-            writeToPlaylistFile(playlist); // then write a blank playlist to the playlist file
-        }
+        // the damaged files are left alone, so nothing more is lost if they can be recovered
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon,
+            "Library Error",
+            "Could not load the music library. " + loaded.getErrorMessage()
+                + "\nThe library is read-only until this is fixed, so changes to it won't be saved.",
+            "OK"
+        );
     }
-    else
-    {   // populate playlist vector with default values
-        playlist[0].push_back("Track 1");
-        playlist[0].push_back("-");
-        playlist[1].push_back("Track 2");
-        playlist[1].push_back("-");
-        playlist[2].push_back("Track 3");
-        playlist[2].push_back("-");
-        playlist[3].push_back("Track 4");
-        playlist[3].push_back("-");
-        playlist[4].push_back("Track 5");
-        playlist[4].push_back("-");
-        playlist[5].push_back("Track 6");
-        playlist[5].push_back("-");
-        writeToPlaylistFile(playlist);
+    else if (libraryIsNew && std::filesystem::exists("playlist.csv"))
+    {
+        // the library replaced playlist.csv, so bring its tracks across the first time round
+        importPlaylistFile(juce::File::getCurrentWorkingDirectory().getChildFile("playlist.csv"));
     }
+
     // create table
-    tableComponent.getHeader().addColumn("Track title", 1, 400);
-    tableComponent.getHeader().addColumn("Track length", 2, 400);
-    tableComponent.getHeader().addColumn("", 3, 500/3);
-    tableComponent.getHeader().addColumn("", 4, 500/3);
-    tableComponent.getHeader().addColumn("", 5, 500/3);
+    tableComponent.getHeader().addColumn("Track title", titleColumn, 400);
+    tableComponent.getHeader().addColumn("Track length", lengthColumn, 300);
+    tableComponent.getHeader().addColumn("BPM", bpmColumn, 100);
+
+    const int buttonWidth = 500 / (decks.size() + 1);
+
+    for (int i = 0; i < decks.size(); ++i)
+        tableComponent.getHeader().addColumn("", firstDeckColumn + i, buttonWidth, 30, -1, juce::TableHeaderComponent::notSortable);
+
+    tableComponent.getHeader().addColumn("", removeColumn, buttonWidth, 30, -1, juce::TableHeaderComponent::notSortable);
     tableComponent.setModel(this);
     tableComponent.setRowHeight(tableComponent.getRowHeight() * 2);
 
+    addButton.addListener(this);
+    importButton.addListener(this);
+    exportButton.addListener(this);
+
+    // a library that failed to load refuses edits, so don't offer any
+    addButton.setEnabled(! trackLibrary.isReadOnly());
+    importButton.setEnabled(! trackLibrary.isReadOnly());
+
+    searchBox.setTextToShowWhenEmpty("Search title, artist, path or BPM", juce::Colours::grey);
+    searchBox.onTextChange = [this]
+    {
+        searchIndex.setQuery(searchBox.getText());
+        tableComponent.updateContent();
+        tableComponent.repaint();
+    };
+
     addAndMakeVisible(tableComponent);
+    addAndMakeVisible(addButton);
+    addAndMakeVisible(importButton);
+    addAndMakeVisible(exportButton);
+    addAndMakeVisible(scanStatus);
+    addAndMakeVisible(searchBox);
+
+    searchIndex.update(trackLibrary);
+
+    // tempos are asked for as rows come into view, so launching doesn't touch every track
+    beatAnalyser.addListener(this);
+    trackLibrary.addListener(this);
+    libraryScanner.addListener(this);
+    startTimer(250);
 }
 
 PlaylistComponent::~PlaylistComponent()
 {
+    stopTimer();
+    libraryScanner.removeListener(this);
+    trackLibrary.removeListener(this);
+    beatAnalyser.removeListener(this);
 }
 
 void PlaylistComponent::paint (juce::Graphics& g)
@@ -79,17 +108,22 @@ void PlaylistComponent::paint (juce::Graphics& g)
     g.setFont (14.0f);
     g.drawText ("PlaylistComponent", getLocalBounds(),
                 juce::Justification::centred, true);   // draw some placeholder text
-    tableComponent.setBounds(0, 0, getWidth(), getHeight());
 }
 
 void PlaylistComponent::resized()
 {
-    tableComponent.setBounds(0, 0, getWidth(), getHeight());
+    const int toolbarHeight = 30;
+    addButton.setBounds(4, 3, 120, toolbarHeight - 6);
+    importButton.setBounds(addButton.getRight() + 4, 3, 120, toolbarHeight - 6);
+    exportButton.setBounds(importButton.getRight() + 4, 3, 80, toolbarHeight - 6);
+    searchBox.setBounds(getWidth() - 304, 3, 300, toolbarHeight - 6);
+    scanStatus.setBounds(exportButton.getRight() + 8, 0, searchBox.getX() - exportButton.getRight() - 12, toolbarHeight);
+    tableComponent.setBounds(0, toolbarHeight, getWidth(), getHeight() - toolbarHeight);
 }
 
 int PlaylistComponent::getNumRows()
 {
-    return playlist.size();
+    return searchIndex.getNumVisibleRows();
 }
 
 void PlaylistComponent::paintRowBackground(juce::Graphics& g,
@@ -117,18 +151,20 @@ void PlaylistComponent::paintCell(juce::Graphics& g,
                                   int columnId,
                                   int width,
                                   int height,
-                                  bool rowIsSelected) // draw in the values from the playlist vector on to the gui
+                                  bool rowIsSelected) // draws the text the search index formatted when the track last changed
 { 
-    if (columnId == 1)
-    {
-        g.drawText(playlist[rowNumber][0], 2, 0, width - 4, height, juce::Justification::centredLeft, true);
-    }
+    const auto* text = searchIndex.getDisplayText(rowNumber);
 
-    if (columnId == 2)
-    {
-        g.drawText(playlist[rowNumber][1], 2, 0, width - 4, height, juce::Justification::centredLeft, true);
-    }
-    std::string trackname = playlist[rowNumber][0];
+    if (text == nullptr)
+        return;
+
+    const juce::String* cellText = columnId == titleColumn ? &text->title
+                                 : columnId == lengthColumn ? &text->duration
+                                 : columnId == bpmColumn ? &text->bpm
+                                 : nullptr;
+
+    if (cellText != nullptr)
+        g.drawText(*cellText, 2, 0, width - 4, height, juce::Justification::centredLeft, true);
 }
 
 // Creates the buttons for each playlist row
@@ -137,181 +173,265 @@ juce::Component* PlaylistComponent::refreshComponentForCell(int rowNumber,
     bool isRowSelected,
     Component* existingComponentToUpdate)
 {   
-    if (columnId == 3)
-    {
-        if (existingComponentToUpdate == nullptr)
-        {
-            juce::TextButton* btn = new juce::TextButton{ "DECK 1" };
-            juce::String id{ std::to_string(rowNumber) };
-            btn->setComponentID(id);
-            juce::String title{ "Deck1LoadFromPlaylist" };
-            btn->setTitle(title);
-            btn->addListener(this);
-            existingComponentToUpdate = btn;
-        }
-    }
+    const bool isDeckColumn = columnId >= firstDeckColumn && columnId < firstDeckColumn + decks.size();
 
-    if (columnId == 4)
-    {
-        if (existingComponentToUpdate == nullptr)
-        {
-            juce::TextButton* btn = new juce::TextButton{ "DECK 2" };
-            juce::String id{ std::to_string(rowNumber) };
-            btn->setComponentID(id);
-            juce::String title{ "Deck2LoadFromPlaylist" };
-            btn->setTitle(title);
-            btn->addListener(this);
-            existingComponentToUpdate = btn;
-        }
-    }
+    if (! isDeckColumn && columnId != removeColumn)
+        return existingComponentToUpdate;
 
-    if (columnId == 5)
+    // only CellButtons are ever made for these columns
+    auto* button = static_cast<CellButton*>(existingComponentToUpdate);
+
+    if (button == nullptr)
     {
-        if (existingComponentToUpdate == nullptr)
-        {
-            juce::TextButton* btn = new juce::TextButton{ "LOAD" };
-            juce::String id{ std::to_string(rowNumber) };
-            btn->setComponentID(id);
-            juce::String title{ "LoadButton" };
-            btn->setTitle(title);
-            btn->addListener(this);
-            existingComponentToUpdate = btn;
-        }
+        button = new CellButton(isDeckColumn ? "DECK " + juce::String(columnId - firstDeckColumn + 1) : "REMOVE", columnId);
+        button->onClick = [this, button] { cellButtonClicked(button->columnId, button->libraryRow); };
     }
-    return existingComponentToUpdate;
+
+    button->libraryRow = searchIndex.getLibraryRow(rowNumber);
+    return button;
+}
+
+void PlaylistComponent::sortOrderChanged(int newSortColumnId, bool isForwards)
+{
+    if (newSortColumnId == titleColumn)
+        searchIndex.setSortOrder(TrackSearchIndex::SortColumn::title, isForwards);
+    else if (newSortColumnId == lengthColumn)
+        searchIndex.setSortOrder(TrackSearchIndex::SortColumn::duration, isForwards);
+    else if (newSortColumnId == bpmColumn)
+        searchIndex.setSortOrder(TrackSearchIndex::SortColumn::bpm, isForwards);
+
+    tableComponent.updateContent();
+    tableComponent.repaint();
 }
 
 // Checks which button was clicked, and performs appropriate response
 void PlaylistComponent::buttonClicked(juce::Button* button)
 {
-    int id = std::stoi(button->getComponentID().toStdString());
-    selectedTrackID = id;
-
-    if (button->getTitle() == "Deck1LoadFromPlaylist")
+    if (button == &addButton) // launch a file chooser
     {
-        if (playlist[id].size() == 3)
+        auto fileChooserFlags = juce::FileBrowserComponent::openMode
+                              | juce::FileBrowserComponent::canSelectFiles
+                              | juce::FileBrowserComponent::canSelectMultipleItems;
+
+        fChooser.launchAsync(fileChooserFlags, [this](const juce::FileChooser& chooser)
         {
-            juce::StringArray fileToLoad;
-            fileToLoad.add(playlist[id][2]);
+            // playlists bring in the tracks they list, everything else is scanned as a track
+            juce::Array<juce::File> tracks;
+            PlaylistFile::Format format;
 
-            deck1->filesDropped(fileToLoad, 0, 0);
+            for (const auto& file : chooser.getResults())
+            {
+                if (PlaylistFile::getFormat(file, format))
+                    importPlaylistFile(file);
+                else
+                    tracks.add(file);
+            }
 
-        }
-        else
-        {
-            // Alert dialogue to inform user that no track is currently loaded
-            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon,
-                                                   "Playlist Error",
-                                                   "No track currently loaded in this playlist slot!",
-                                                   "OK");
-        } 
+            scanOrSayWhy(tracks);
+        });
+
+        return;
     }
 
-    if (button->getTitle() == "Deck2LoadFromPlaylist")
+    if (button == &importButton) // pick a folder to import, or stop the import that's running
     {
-        if (playlist[id].size() == 3)
+        if (libraryScanner.isScanning())
         {
-            juce::StringArray fileToLoad;
-            fileToLoad.add(playlist[id][2]);
+            libraryScanner.cancel();
+            return;
+        }
 
-            deck2->filesDropped(fileToLoad, 0, 0);
+        auto folderChooserFlags = juce::FileBrowserComponent::openMode
+                                | juce::FileBrowserComponent::canSelectDirectories;
 
-        }
-        else
+        folderChooser.launchAsync(folderChooserFlags, [this](const juce::FileChooser& chooser)
         {
-            // Alert dialogue to inform user that no track is currently loaded
-            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon,
-                                                   "Playlist Error",
-                                                   "No track currently loaded in this playlist slot!",
-                                                   "OK");
-        }
+            scanOrSayWhy(chooser.getResults());
+        });
+
+        return;
     }
 
-    if (button->getTitle() == "LoadButton") // launch a file chooser
+    if (button == &exportButton)
     {
-        auto fileChooserFlags = juce::FileBrowserComponent::canSelectFiles;
-        fChooser.launchAsync(fileChooserFlags, [this](const juce::FileChooser& chooser)
+        auto exportChooserFlags = juce::FileBrowserComponent::saveMode
+                                | juce::FileBrowserComponent::canSelectFiles
+                                | juce::FileBrowserComponent::warnAboutOverwriting;
+
+        exportChooser.launchAsync(exportChooserFlags, [this](const juce::FileChooser& chooser)
         {
-            
-            updatePlaylist(selectedTrackID, chooser.getResult());
-            
+            auto file = chooser.getResult();
+            PlaylistFile::Format format;
+
+            if (file == juce::File())
+                return;
+
+            if (! PlaylistFile::getFormat(file, format))
+                file = file.withFileExtension("m3u8");
+
+            exportPlaylistFile(file);
         });
+
+        return;
     }
 }
 
-// update playlist with information about the new track and save path
-void PlaylistComponent::updatePlaylist(int trackIndex, juce::File selectedTrack)
+void PlaylistComponent::cellButtonClicked(int columnId, int libraryRow)
 {
-    std::string newTrackName = selectedTrack.getFileNameWithoutExtension().toStdString();
-    std::string trackLength;
-    std::string path = selectedTrack.getFullPathName().toStdString();
+    if (! juce::isPositiveAndBelow(libraryRow, trackLibrary.getNumTracks()))
+        return;
 
-    if (auto reader = formatManager.createReaderFor(selectedTrack))
+    if (columnId == removeColumn)
     {
-        // Calculate length of the audio file in minutes/secs from sample rate
-        int lengthInSeconds = (reader->lengthInSamples / reader->sampleRate);
+        trackLibrary.remove(libraryRow);
+        return;
+    }
+
+    const int deckIndex = columnId - firstDeckColumn;
 
-        // Calculate minutes and seconds
-        int finalMinutes = floor(lengthInSeconds / 60);
-        int finalSeconds = lengthInSeconds - finalMinutes * 60;
-       
-        // Convert to string
-        trackLength = std::to_string(finalMinutes) + "m " + std::to_string(finalSeconds) + "s";
+    if (juce::isPositiveAndBelow(deckIndex, decks.size()))
+        decks[deckIndex]->filesDropped(juce::StringArray(trackLibrary.getTrack(libraryRow).path), 0, 0);
+}
 
+void PlaylistComponent::scanOrSayWhy(const juce::Array<juce::File>& filesAndFolders)
+{
+    if (! libraryScanner.scan(filesAndFolders))
+        scanStatus.setText("Still stopping the last import - try again in a moment", juce::dontSendNotification);
+}
+
+void PlaylistComponent::importPlaylistFile(const juce::File& playlistFile)
+{
+    const auto directory = playlistFile.getParentDirectory();
+    std::vector<LibraryTrack> importedTracks;
+
+    const auto result = PlaylistFile::read(playlistFile, [&](const PlaylistFile::Entry& entry)
+    {
+        // relative paths are relative to the playlist, and M3U files may hold file:// URLs
+        const auto path = entry.toString(entry.path);
+        const auto file = path.startsWithIgnoreCase("file://") ? juce::URL(path).getLocalFile()
+                                                              : directory.getChildFile(path);
+
+        // a track that's already in the library has better details than the playlist
+        if (trackLibrary.indexOf(file.getFullPathName()) >= 0)
+            return;
+
+        // the size and modification time are left at 0, so the next scan of its folder reads its tags
+        LibraryTrack track;
+        track.path = file.getFullPathName();
+        track.title = entry.title.empty() ? file.getFileNameWithoutExtension() : entry.toString(entry.title);
+        track.artist = entry.toString(entry.artist);
+        track.durationSeconds = juce::jmax(0.0, entry.durationSeconds);
+        track.bpm = juce::jmax(0.0, entry.bpm);
+        importedTracks.push_back(std::move(track));
+    });
+
+    // one append to the log; the library compacts it once it has grown enough
+    trackLibrary.addOrUpdate(importedTracks);
+
+    if (result.failed())
+    {
+        // whatever came before the error is kept
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
+            "Playlist Error",
+            "Only part of " + playlistFile.getFileName() + " could be imported.\n" + result.getErrorMessage(),
+            "OK"
+        );
+    }
+}
+
+void PlaylistComponent::exportPlaylistFile(const juce::File& playlistFile)
+{
+    const auto toView = [](const juce::String& text) { return std::string_view(text.toRawUTF8(), text.getNumBytesAsUTF8()); };
+
+    // the entries point at the library's strings, which don't change while it's written
+    std::vector<PlaylistFile::Entry> entries((size_t) searchIndex.getNumVisibleRows());
+
+    for (size_t row = 0; row < entries.size(); ++row)
+    {
+        const auto& track = trackLibrary.getTrack(searchIndex.getLibraryRow((int) row));
+        auto& entry = entries[row];
+        entry.path = toView(track.path);
+        entry.title = toView(track.title);
+        entry.artist = toView(track.artist);
+        entry.durationSeconds = track.durationSeconds > 0 ? track.durationSeconds : -1.0;
+        entry.bpm = track.bpm;
     }
 
-    // Update the track vector in the playlist array with the new track and repaint to display changes
-    playlist[trackIndex][0] = newTrackName;
-    playlist[trackIndex][1] = trackLength;
-    playlist[trackIndex].size() == 3 ? playlist[trackIndex][2] = path : playlist[trackIndex].push_back(path);
-    writeToPlaylistFile(playlist);
-    PlaylistComponent::repaint();
+    const auto result = PlaylistFile::write(playlistFile, entries);
+
+    if (result.failed())
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
+            "Playlist Error",
+            result.getErrorMessage(),
+            "OK"
+        );
+    }
 }
 
-// read from the saved playlist csv file and save it in to the playlist array
-void PlaylistComponent::readFromPlaylistFile(std::string playlistFile)
+void PlaylistComponent::timerCallback()
 {
-    std::ifstream savedPlaylist(playlistFile);
-    if (!savedPlaylist.is_open()) throw std::runtime_error("Could not open playlist file");
+    // only tracks in view are analysed, and the analyser checks for a stored grid first
+    const int rowHeight = juce::jmax(1, tableComponent.getRowHeight());
+    const int firstRow = tableComponent.getViewport()->getViewPositionY() / rowHeight;
+    const int endRow = juce::jmin(getNumRows(), firstRow + tableComponent.getNumRowsOnScreen() + 1);
 
-    std::string line;
-    std::string delimiter = ",";
-    int trackIndex = 0;
+    std::set<juce::String> inView;
 
-    if (savedPlaylist.good())
+    for (int row = firstRow; row < endRow; ++row)
     {
-        while (std::getline(savedPlaylist, line)) // for each line in the csv
-        {
-            size_t pos = 0;
-            while ((pos = line.find(delimiter)) != std::string::npos) // tokenise with ',' as delimiter 
-            {
-                std::string token = line.substr(0, pos);
-                playlist[trackIndex].push_back(token);
-                line.erase(0, pos + delimiter.length());
-            }
-            playlist[trackIndex].push_back(line); // save to playlist array
-            trackIndex += 1;
-        }
+        const auto& track = trackLibrary.getTrack(searchIndex.getLibraryRow(row));
+
+        if (track.bpm == 0.0)
+            inView.insert(track.path);
     }
-    else
+
+    // scrolling through the library leaves only what's in view queued. One already being
+    // analysed stays asked for, as its result is on the way
+    for (auto it = tempoRequests.begin(); it != tempoRequests.end();)
     {
-        throw std::runtime_error("Could not read playlist file");
+        if (inView.count(*it) == 0 && beatAnalyser.cancel(juce::File(*it)))
+            it = tempoRequests.erase(it);
+        else
+            ++it;
     }
+
+    for (const auto& path : inView)
+        if (tempoRequests.insert(path).second)
+            beatAnalyser.analyse(juce::File(path), true);
 }
 
-// Saves updated playlist array in to the playlist csv file
-void PlaylistComponent::writeToPlaylistFile(std::array<std::vector<std::string>, 6> playlist)
+void PlaylistComponent::trackAnalysed(const juce::File& file, const BeatGrid& grid)
 {
-    std::ofstream playlistFile("playlist.csv");
+    tempoRequests.erase(file.getFullPathName());
+    trackLibrary.setBpm(file.getFullPathName(), grid.isValid() ? grid.bpm : LibraryTrack::noClearBeat);
+}
+
+void PlaylistComponent::libraryChanged()
+{
+    searchIndex.update(trackLibrary);
+    tableComponent.updateContent();
+    tableComponent.repaint();
+}
+
+void PlaylistComponent::scanProgress(const LibraryScanner::Progress& progress)
+{
+    juce::String status;
+    status << "Imported " << progress.numRead << " of " << progress.numFound << " files, "
+           << juce::String(progress.getFilesPerSecond(), 0) << " files/s, "
+           << juce::String(progress.getMegabytesPerSecond(), 1) << " MB/s";
 
-    for (int i = 0; i < playlist.size(); ++i) // for all tracks in playlist
+    if (progress.finished)
     {
-        for (int j=0; j < playlist[i].size(); ++j) // for all elements of the track vector
-        {
-            playlistFile << playlist.at(i)[j];
-            if (j != playlist[i].size() - 1) playlistFile << ","; // No comma at end of line
-        }
-        playlistFile << "\n";
+        status << " - done in " << juce::String(progress.elapsedSeconds, 1) << "s";
+
+        if (progress.numUnchanged > 0)
+            status << ", " << progress.numUnchanged << " already in the library";
+
+        if (progress.numUnreadable > 0)
+            status << ", " << progress.numUnreadable << " couldn't be read";
     }
-    playlistFile.close();
-}
\ No newline at end of file
+
+    scanStatus.setText(status, juce::dontSendNotification);
+    importButton.setButtonText(progress.finished ? "IMPORT FOLDER" : "STOP IMPORT");
+}
@@ -15,7 +15,13 @@
 #include <string>
 #include <string.h>
 #include <array>
+#include <set>
+#include "BeatAnalyser.h"
 #include "DeckGUI.h"
+#include "LibraryScanner.h"
+#include "PlaylistFile.h"
+#include "TrackLibrary.h"
+#include "TrackSearchIndex.h"
 #include <fstream>
 #include <filesystem>
 
@@ -25,11 +31,19 @@
 */
 class PlaylistComponent  : public juce::Component,
                            public juce::TableListBoxModel,
-                           public juce::Button::Listener
+                           public juce::Button::Listener,
+                           public BeatAnalyser::Listener,
+                           public TrackLibrary::Listener,
+                           public LibraryScanner::Listener,
+                           private juce::Timer
 
 {
 public:
-    PlaylistComponent(juce::AudioFormatManager& _formatManager, DeckGUI* deck1, DeckGUI* deck2);
+    PlaylistComponent(juce::AudioFormatManager& _formatManager,
+                      BeatAnalyser& beatAnalyser,
+                      TrackLibrary& trackLibrary,
+                      LibraryScanner& libraryScanner,
+                      const juce::OwnedArray<DeckGUI>& decks);
     ~PlaylistComponent() override;
 
     void paint (juce::Graphics&) override;
@@ -55,27 +69,80 @@ public:
                                        bool isRowSelected,
                                        Component* existingComponentToUpdate) override;
 
+    /** sorts by the clicked column, then by whichever was clicked before it */
+    void sortOrderChanged(int newSortColumnId, bool isForwards) override;
+
     void buttonClicked(juce::Button* button);
 
-    void readFromPlaylistFile(std::string playlistFile);
+    /** starts scanning the files, or says to try again if a stopped import hasn't finished stopping */
+    void scanOrSayWhy(const juce::Array<juce::File>& filesAndFolders);
+
+    /** adds the tracks in a CSV, M3U or PLS playlist to the library, including an old playlist.csv */
+    void importPlaylistFile(const juce::File& playlistFile);
+
+    /** saves the rows the table is showing, in the order it's showing them */
+    void exportPlaylistFile(const juce::File& playlistFile);
+
+    /** stores the track's tempo in the library when its analysis finishes, or that it has none */
+    void trackAnalysed(const juce::File& file, const BeatGrid& grid) override;
 
-    void writeToPlaylistFile(std::array<std::vector<std::string>, 6> playlist);
+    void libraryChanged() override;
 
-    void updatePlaylist(int trackIndex, juce::File selectedTrack);
+    /** shows how far an import has got. The new tracks' tempos are asked for as they come into view */
+    void scanProgress(const LibraryScanner::Progress& progress) override;
 
 private:
+    enum ColumnIds
+    {
+        titleColumn = 1,
+        lengthColumn = 2,
+        removeColumn = 5,
+        bpmColumn = 6,
+        firstDeckColumn = 10    // one "DECK n" column per deck, numbered on from here
+    };
+
+    /** a button in one of the table's button columns. The table keeps one per cell of each
+        row component and hands them on to other rows as it scrolls, so only the track changes */
+    class CellButton : public juce::TextButton
+    {
+    public:
+        CellButton(const juce::String& text, int _columnId) : juce::TextButton(text), columnId(_columnId) {}
+
+        const int columnId;
+        int libraryRow = -1;
+    };
+
+    /** loads the track on a deck or removes it, depending on the button's column */
+    void cellButtonClicked(int columnId, int libraryRow);
+
+    /** asks for the tempos of the rows in view, and drops the queued ones that have scrolled away */
+    void timerCallback() override;
+
     juce::TableListBox tableComponent;
+    juce::TextButton addButton{ "ADD TRACKS" };
+    juce::TextButton importButton{ "IMPORT FOLDER" };
+    juce::TextButton exportButton{ "EXPORT" };
+    juce::Label scanStatus;
+    juce::TextEditor searchBox;
+
+    // the rows the table shows, filtered by the search box and sorted by the header
+    TrackSearchIndex searchIndex;
+
+    // tracks whose tempo has been asked for and hasn't arrived yet
+    std::set<juce::String> tempoRequests;
 
-    std::array<std::vector<std::string>, 6> playlist;
+    TrackLibrary& trackLibrary;
+    LibraryScanner& libraryScanner;
 
-    juce::FileChooser fChooser{ "Select a file..." };
+    juce::FileChooser fChooser{ "Select files..." };
+    juce::FileChooser folderChooser{ "Select a folder to import..." };
+    juce::FileChooser exportChooser{ "Export the playlist as...", {}, "*.m3u8;*.m3u;*.pls;*.csv" };
 
     juce::AudioFormatManager& formatManager;
 
-    int selectedTrackID = 0;
+    BeatAnalyser& beatAnalyser;
 
-    DeckGUI* deck1;
-    DeckGUI* deck2;
+    const juce::OwnedArray<DeckGUI>& decks;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlaylistComponent)
 };
@@ -0,0 +1,809 @@
+/*
+  ==============================================================================
+
+    PlaylistFile.cpp
+    Created: 18 Oct 2026 12:02:37am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "PlaylistFile.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <string>
+
+namespace
+{
+    using Entry = PlaylistFile::Entry;
+
+    constexpr size_t maxCsvFields = 32; // any after these are ignored
+
+    char toLower(char c)
+    {
+        return c >= 'A' && c <= 'Z' ? (char) (c - 'A' + 'a') : c;
+    }
+
+    bool startsWithIgnoreCase(std::string_view text, std::string_view lowerCasePrefix)
+    {
+        if (text.size() < lowerCasePrefix.size())
+            return false;
+
+        for (size_t i = 0; i < lowerCasePrefix.size(); ++i)
+            if (toLower(text[i]) != lowerCasePrefix[i])
+                return false;
+
+        return true;
+    }
+
+    bool equalsIgnoreCase(std::string_view text, std::string_view lowerCaseWord)
+    {
+        return text.size() == lowerCaseWord.size() && startsWithIgnoreCase(text, lowerCaseWord);
+    }
+
+    std::string_view trim(std::string_view text)
+    {
+        while (! text.empty() && (text.front() == ' ' || text.front() == '\t'))
+            text.remove_prefix(1);
+
+        while (! text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r'))
+            text.remove_suffix(1);
+
+        return text;
+    }
+
+    /** a plain decimal such as "402", "-1" or "126.5", read from the front of text. Returns the
+        number of characters used, or 0 if there isn't one */
+    size_t readNumber(std::string_view text, double& value)
+    {
+        size_t i = 0;
+        const bool negative = i < text.size() && text[i] == '-';
+
+        if (negative)
+            ++i;
+
+        const auto firstDigit = i;
+        double result = 0.0;
+
+        for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i)
+            result = result * 10.0 + (text[i] - '0');
+
+        if (i == firstDigit)
+            return 0;
+
+        if (i < text.size() && text[i] == '.')
+        {
+            double scale = 0.1;
+
+            for (++i; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, scale *= 0.1)
+                result += (text[i] - '0') * scale;
+        }
+
+        value = negative ? -result : result;
+        return i;
+    }
+
+    /** the whole of text as a number */
+    bool parseNumber(std::string_view text, double& value)
+    {
+        return ! text.empty() && readNumber(text, value) == text.size();
+    }
+
+    /** "402", "402.5", "6:42", "1:02:03" or "6m 42s". Empty or "-" is an unknown length */
+    bool parseDuration(std::string_view text, double& seconds)
+    {
+        if (text.empty() || text == "-")
+        {
+            seconds = -1.0;
+            return true;
+        }
+
+        double total = 0.0, part = 0.0;
+        auto used = readNumber(text, part);
+
+        if (used == 0)
+            return false;
+
+        total = part;
+        text.remove_prefix(used);
+
+        if (! text.empty() && text.front() == 'm')
+        {
+            text = trim(text.substr(1));
+
+            if (! text.empty())
+            {
+                if ((used = readNumber(text, part)) == 0)
+                    return false;
+
+                total = total * 60.0 + part;
+                text.remove_prefix(used);
+            }
+            else
+            {
+                total *= 60.0;
+            }
+        }
+        else
+        {
+            while (! text.empty() && text.front() == ':')
+            {
+                if ((used = readNumber(text.substr(1), part)) == 0)
+                    return false;
+
+                total = total * 60.0 + part;
+                text.remove_prefix(used + 1);
+            }
+        }
+
+        if (! text.empty() && text.front() == 's')
+            text.remove_prefix(1);
+
+        seconds = total;
+        return text.empty();
+    }
+
+    juce::String toString(std::string_view text)
+    {
+        return juce::String::fromUTF8(text.data(), (int) text.size());
+    }
+
+    enum CsvColumn
+    {
+        pathColumn,
+        titleColumn,
+        artistColumn,
+        durationColumn,
+        bpmColumn,
+        numCsvColumns
+    };
+
+    /** the column a CSV header names, or -1 if it's one we don't use */
+    int getCsvColumn(std::string_view name)
+    {
+        name = trim(name);
+
+        if (equalsIgnoreCase(name, "path") || equalsIgnoreCase(name, "location") || equalsIgnoreCase(name, "file"))
+            return pathColumn;
+
+        if (equalsIgnoreCase(name, "title") || equalsIgnoreCase(name, "name"))
+            return titleColumn;
+
+        if (equalsIgnoreCase(name, "artist"))
+            return artistColumn;
+
+        if (equalsIgnoreCase(name, "duration") || equalsIgnoreCase(name, "length") || equalsIgnoreCase(name, "time"))
+            return durationColumn;
+
+        if (equalsIgnoreCase(name, "bpm") || equalsIgnoreCase(name, "tempo"))
+            return bpmColumn;
+
+        return -1;
+    }
+
+    //==============================================================================
+    class Parser
+    {
+    public:
+        Parser(std::string_view _text, const PlaylistFile::EntryCallback& _onEntry, PlaylistFile::Position* _errorPosition)
+            : text(_text), onEntry(_onEntry), errorPosition(_errorPosition)
+        {
+            if (startsWithIgnoreCase(text, "\xef\xbb\xbf")) // a UTF-8 byte order mark
+                position = 3;
+        }
+
+        juce::Result parseCsv();
+        juce::Result parseM3u();
+        juce::Result parsePls();
+
+    private:
+        /** the next line, without its line break, or false at the end */
+        bool readLine(std::string_view& line);
+
+        /** the fields of the next CSV row, with where each starts in the text */
+        juce::Result readCsvRow(size_t& numFields);
+
+        size_t getOffset(std::string_view part) const { return (size_t) (part.data() - text.data()); }
+
+        juce::Result fail(size_t offset, const juce::String& message);
+
+        const std::string_view text;
+        size_t position = 0;
+        const PlaylistFile::EntryCallback& onEntry;
+        PlaylistFile::Position* errorPosition;
+
+        std::array<std::string_view, maxCsvFields> fields;
+        std::array<size_t, maxCsvFields> fieldOffsets;
+        std::string unescaped; // quoted fields with "" in them, reused for every row
+    };
+
+    bool Parser::readLine(std::string_view& line)
+    {
+        if (position >= text.size())
+            return false;
+
+        const auto* start = text.data() + position;
+        const auto* newLine = static_cast<const char*>(std::memchr(start, '\n', text.size() - position));
+        const auto length = newLine != nullptr ? (size_t) (newLine - start) : text.size() - position;
+
+        line = std::string_view(start, length);
+        position += length + 1;
+
+        if (! line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+
+        return true;
+    }
+
+    juce::Result Parser::fail(size_t offset, const juce::String& message)
+    {
+        // only worked out when something's wrong, so parsing doesn't have to count lines
+        const auto* begin = text.data();
+        const auto line = 1 + (int) std::count(begin, begin + offset, '\n');
+        const auto lineStart = text.rfind('\n', offset == 0 ? 0 : offset - 1);
+        const auto column = 1 + (int) (lineStart == std::string_view::npos || offset == 0 ? offset : offset - lineStart - 1);
+
+        if (errorPosition != nullptr)
+            *errorPosition = { (juce::int64) offset, line, column };
+
+        return juce::Result::fail("line " + juce::String(line) + ", column " + juce::String(column) + ": " + message);
+    }
+
+    //==============================================================================
+    juce::Result Parser::readCsvRow(size_t& numFields)
+    {
+        numFields = 0;
+
+        const auto* start = text.data() + position;
+        const auto remaining = text.size() - position;
+        const auto* newLine = static_cast<const char*>(std::memchr(start, '\n', remaining));
+        const auto lineLength = newLine != nullptr ? (size_t) (newLine - start) : remaining;
+
+        if (std::memchr(start, '"', lineLength) == nullptr)
+        {
+            // nothing quoted, so the fields are whatever is between the commas
+            std::string_view line(start, lineLength);
+            position += lineLength + 1;
+
+            if (! line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+
+            for (;;)
+            {
+                const auto comma = line.find(',');
+
+                if (numFields < maxCsvFields)
+                {
+                    fields[numFields] = line.substr(0, comma);
+                    fieldOffsets[numFields] = getOffset(line);
+                    ++numFields;
+                }
+
+                if (comma == std::string_view::npos)
+                    return juce::Result::ok();
+
+                line.remove_prefix(comma + 1);
+            }
+        }
+
+        // a quoted field can hold line breaks, so find where the row really ends first. The
+        // buffer can then be made big enough for the whole row, so the views into it stay put
+        size_t rowEnd = position;
+        bool atFieldStart = true;
+
+        while (rowEnd < text.size() && text[rowEnd] != '\n')
+        {
+            if (atFieldStart && text[rowEnd] == '"')
+            {
+                const auto openingQuote = rowEnd;
+
+                for (++rowEnd;; ++rowEnd)
+                {
+                    if (rowEnd >= text.size())
+                        return fail(openingQuote, "this quoted field is never closed");
+
+                    if (text[rowEnd] == '"')
+                    {
+                        if (rowEnd + 1 < text.size() && text[rowEnd + 1] == '"')
+                            ++rowEnd;
+                        else
+                            break;
+                    }
+                }
+            }
+
+            atFieldStart = text[rowEnd] == ',';
+            ++rowEnd;
+        }
+
+        unescaped.clear();
+        unescaped.reserve(rowEnd - position);
+
+        while (position <= rowEnd)
+        {
+            const auto fieldStart = position;
+            std::string_view field;
+
+            if (position < rowEnd && text[position] == '"')
+            {
+                const auto unescapedStart = unescaped.size();
+
+                for (++position;; ++position)
+                {
+                    if (text[position] == '"')
+                    {
+                        if (position + 1 < rowEnd && text[position + 1] == '"')
+                            ++position;
+                        else
+                            break;
+                    }
+
+                    unescaped += text[position];
+                }
+
+                field = std::string_view(unescaped.data() + unescapedStart, unescaped.size() - unescapedStart);
+                ++position; // past the closing quote
+
+                if (position + 1 == rowEnd && text[position] == '\r')
+                    ++position;
+
+                if (position < rowEnd && text[position] != ',')
+                    return fail(position, "expected a comma after the closing quote");
+            }
+            else
+            {
+                const auto* comma = static_cast<const char*>(std::memchr(text.data() + position, ',', rowEnd - position));
+                const auto fieldEnd = comma != nullptr ? (size_t) (comma - text.data()) : rowEnd;
+                field = text.substr(position, fieldEnd - position);
+                position = fieldEnd;
+
+                if (! field.empty() && field.back() == '\r' && position == rowEnd)
+                    field.remove_suffix(1);
+            }
+
+            if (numFields < maxCsvFields)
+            {
+                fields[numFields] = field;
+                fieldOffsets[numFields] = fieldStart;
+                ++numFields;
+            }
+
+            ++position; // past the comma, or the line break at the end of the row
+        }
+
+        return juce::Result::ok();
+    }
+
+    juce::Result Parser::parseCsv()
+    {
+        std::array<int, numCsvColumns> columns;
+        columns.fill(-1);
+
+        bool isFirstRow = true;
+        size_t numFields = 0;
+
+        while (position < text.size())
+        {
+            const auto result = readCsvRow(numFields);
+
+            if (result.failed())
+                return result;
+
+            if (numFields == 1 && trim(fields[0]).empty())
+                continue;
+
+            if (isFirstRow)
+            {
+                isFirstRow = false;
+
+                for (size_t i = 0; i < numFields; ++i)
+                {
+                    const int column = getCsvColumn(fields[i]);
+
+                    if (column >= 0 && columns[(size_t) column] < 0)
+                        columns[(size_t) column] = (int) i;
+                }
+
+                if (columns[pathColumn] >= 0)
+                    continue;
+            }
+
+            // without a header, rows are the old playlist.csv: title, length, path. Its titles weren't
+            // quoted, so one with a comma in it is split over more fields, and the path is always the
+            // last of them. A row of one field is just a path, and one of two is an old empty slot
+            if (columns[pathColumn] < 0 && numFields == 2)
+                continue;
+
+            const auto getColumn = [&](CsvColumn column)
+            {
+                if (columns[pathColumn] >= 0)
+                    return columns[(size_t) column];
+
+                if (column == pathColumn)
+                    return (int) numFields - 1;
+
+                if (numFields < 3)
+                    return -1;
+
+                return column == titleColumn ? 0 : column == durationColumn ? (int) numFields - 2 : -1;
+            };
+
+            const auto getField = [&](int column)
+            {
+                return juce::isPositiveAndBelow(column, (int) numFields) ? trim(fields[(size_t) column]) : std::string_view();
+            };
+
+            Entry entry;
+            entry.path = getField(getColumn(pathColumn));
+
+            if (entry.path.empty())
+                continue;
+
+            entry.title = getField(getColumn(titleColumn));
+            entry.artist = getField(getColumn(artistColumn));
+
+            const int durationField = getColumn(durationColumn);
+            const auto duration = getField(durationField);
+
+            if (! parseDuration(duration, entry.durationSeconds))
+                return fail(fieldOffsets[(size_t) durationField], "\"" + toString(duration) + "\" isn't a length");
+
+            const int bpmField = getColumn(bpmColumn);
+            const auto bpm = getField(bpmField);
+
+            if (! bpm.empty() && ! parseNumber(bpm, entry.bpm))
+                return fail(fieldOffsets[(size_t) bpmField], "\"" + toString(bpm) + "\" isn't a tempo");
+
+            onEntry(entry);
+        }
+
+        return juce::Result::ok();
+    }
+
+    //==============================================================================
+    juce::Result Parser::parseM3u()
+    {
+        Entry entry;
+        std::string_view line;
+
+        while (readLine(line))
+        {
+            line = trim(line);
+
+            if (line.empty())
+                continue;
+
+            if (line.front() != '#')
+            {
+                entry.path = line;
+                onEntry(entry);
+                entry = {};
+                continue;
+            }
+
+            // other directives, including the #EXTM3U header, don't say anything about the tracks
+            if (! startsWithIgnoreCase(line, "#extinf:"))
+                continue;
+
+            // #EXTINF:<seconds> [attributes],<title>, where the attributes are key="value"
+            auto info = line.substr(8);
+            const auto used = readNumber(info, entry.durationSeconds);
+
+            if (used == 0 || (used < info.size() && info[used] != ',' && info[used] != ' '))
+                return fail(getOffset(info), "expected the track's length in seconds after #EXTINF:");
+
+            bool inQuotes = false;
+
+            for (size_t i = used; i < info.size(); ++i)
+            {
+                if (info[i] == '"')
+                {
+                    inQuotes = ! inQuotes;
+                }
+                else if (info[i] == ',' && ! inQuotes)
+                {
+                    entry.title = trim(info.substr(i + 1));
+                    break;
+                }
+            }
+        }
+
+        return juce::Result::ok();
+    }
+
+    //==============================================================================
+    juce::Result Parser::parsePls()
+    {
+        // an entry's keys usually come together, but nothing says they have to, so entries are
+        // gathered by number and passed on in order once the file's been read
+        std::map<long, Entry> entries;
+
+        const auto passOnEntries = [&]
+        {
+            for (const auto& numberedEntry : entries)
+                if (! numberedEntry.second.path.empty())
+                    onEntry(numberedEntry.second);
+        };
+
+        std::string_view line;
+
+        while (readLine(line))
+        {
+            line = trim(line);
+
+            // blank lines, comments and the [playlist] section header
+            if (line.empty() || line.front() == ';' || line.front() == '#' || line.front() == '[')
+                continue;
+
+            const auto equals = line.find('=');
+
+            if (equals == std::string_view::npos)
+            {
+                passOnEntries();
+                return fail(getOffset(line), "expected a key=value line");
+            }
+
+            const auto key = trim(line.substr(0, equals));
+            const auto value = trim(line.substr(equals + 1));
+
+            // FileN, TitleN and LengthN, where N is the entry's number. Anything else, such as
+            // NumberOfEntries or Version, isn't needed
+            const auto name = key.substr(0, std::min(key.find_first_of("0123456789"), key.size()));
+            const auto numberText = key.substr(name.size());
+
+            const bool isFile = equalsIgnoreCase(name, "file");
+            const bool isTitle = equalsIgnoreCase(name, "title");
+
+            if (! isFile && ! isTitle && ! equalsIgnoreCase(name, "length"))
+                continue;
+
+            long number = 0;
+
+            for (const auto c : numberText)
+            {
+                if (c < '0' || c > '9')
+                {
+                    number = 0;
+                    break;
+                }
+
+                number = std::min(number * 10 + (c - '0'), 100000000L);
+            }
+
+            if (number == 0)
+            {
+                passOnEntries();
+                return fail(getOffset(key), "expected an entry number after \"" + toString(name) + "\"");
+            }
+
+            auto& entry = entries[number];
+
+            if (isFile)
+                entry.path = value;
+            else if (isTitle)
+                entry.title = value;
+            else if (! parseDuration(value, entry.durationSeconds))
+            {
+                passOnEntries();
+                return fail(getOffset(value), "\"" + toString(value) + "\" isn't a length");
+            }
+        }
+
+        passOnEntries();
+        return juce::Result::ok();
+    }
+
+    //==============================================================================
+    void writeText(juce::OutputStream& out, std::string_view text)
+    {
+        out.write(text.data(), text.size());
+    }
+
+    void writeCsvField(juce::OutputStream& out, std::string_view text)
+    {
+        if (text.find_first_of(",\"\r\n") == std::string_view::npos)
+        {
+            writeText(out, text);
+            return;
+        }
+
+        out.writeByte('"');
+
+        for (auto quote = text.find('"'); quote != std::string_view::npos; quote = text.find('"'))
+        {
+            writeText(out, text.substr(0, quote + 1));
+            out.writeByte('"');
+            text.remove_prefix(quote + 1);
+        }
+
+        writeText(out, text);
+        out.writeByte('"');
+    }
+
+    /** "artist - title", as M3U and PLS have nowhere else to put the artist */
+    void writeDisplayTitle(juce::OutputStream& out, const Entry& entry)
+    {
+        if (! entry.artist.empty())
+        {
+            writeText(out, entry.artist);
+            out << " - ";
+        }
+
+        writeText(out, entry.title);
+    }
+
+    void writeCsv(juce::OutputStream& out, const std::vector<Entry>& entries)
+    {
+        out << "path,title,artist,duration,bpm\n";
+
+        for (const auto& entry : entries)
+        {
+            writeCsvField(out, entry.path);
+            out.writeByte(',');
+            writeCsvField(out, entry.title);
+            out.writeByte(',');
+            writeCsvField(out, entry.artist);
+            out.writeByte(',');
+
+            if (entry.durationSeconds >= 0)
+                out << juce::String(entry.durationSeconds, 2);
+
+            out.writeByte(',');
+
+            if (entry.bpm > 0)
+                out << juce::String(entry.bpm, 2);
+
+            out.writeByte('\n');
+        }
+    }
+
+    void writeM3u(juce::OutputStream& out, const std::vector<Entry>& entries)
+    {
+        out << "#EXTM3U\n";
+
+        for (const auto& entry : entries)
+        {
+            out << "#EXTINF:" << (entry.durationSeconds >= 0 ? juce::roundToInt(entry.durationSeconds) : -1) << ",";
+            writeDisplayTitle(out, entry);
+            out.writeByte('\n');
+            writeText(out, entry.path);
+            out.writeByte('\n');
+        }
+    }
+
+    void writePls(juce::OutputStream& out, const std::vector<Entry>& entries)
+    {
+        out << "[playlist]\n";
+
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            const auto& entry = entries[i];
+            const auto number = juce::String((juce::int64) i + 1);
+
+            out << "File" << number << "=";
+            writeText(out, entry.path);
+            out << "\nTitle" << number << "=";
+            writeDisplayTitle(out, entry);
+            out << "\nLength" << number << "=" << (entry.durationSeconds >= 0 ? juce::roundToInt(entry.durationSeconds) : -1) << "\n";
+        }
+
+        out << "NumberOfEntries=" << (int) entries.size() << "\nVersion=2\n";
+    }
+}
+
+//==============================================================================
+juce::String PlaylistFile::Entry::toString(std::string_view text) const
+{
+    if (! isLatin1)
+        return juce::String::fromUTF8(text.data(), (int) text.size());
+
+    // Latin-1 is the first 256 code points, so each byte is its own character
+    juce::String result;
+    result.preallocateBytes(text.size() * 2);
+
+    for (const auto c : text)
+        result += (juce::juce_wchar) (juce::uint8) c;
+
+    return result;
+}
+
+bool PlaylistFile::getFormat(const juce::File& file, Format& format)
+{
+    if (file.hasFileExtension("csv"))
+        format = Format::csv;
+    else if (file.hasFileExtension("m3u;m3u8"))
+        format = Format::m3u;
+    else if (file.hasFileExtension("pls"))
+        format = Format::pls;
+    else
+        return false;
+
+    return true;
+}
+
+juce::Result PlaylistFile::read(const juce::File& file, const EntryCallback& onEntry, Position* errorPosition)
+{
+    Format format;
+
+    if (! getFormat(file, format))
+        return juce::Result::fail(file.getFileName() + " isn't a playlist");
+
+    if (! file.existsAsFile())
+        return juce::Result::fail("Couldn't find " + file.getFullPathName());
+
+    // mapping an empty file fails, but there's nothing in it to read anyway
+    if (file.getSize() == 0)
+        return juce::Result::ok();
+
+    const juce::MemoryMappedFile map(file, juce::MemoryMappedFile::readOnly);
+
+    if (map.getData() == nullptr)
+        return juce::Result::fail("Couldn't read " + file.getFullPathName());
+
+    const std::string_view text(static_cast<const char*>(map.getData()), map.getSize());
+
+    // an .m3u8 is always UTF-8, but a plain .m3u from an older player may be Latin-1
+    if (file.hasFileExtension("m3u")
+        && ! juce::CharPointer_UTF8::isValidString(text.data(), (int) juce::jmin(text.size(), (size_t) std::numeric_limits<int>::max())))
+    {
+        return parse(text, format, [&onEntry](const Entry& entry)
+        {
+            auto latin1Entry = entry;
+            latin1Entry.isLatin1 = true;
+            onEntry(latin1Entry);
+        }, errorPosition);
+    }
+
+    return parse(text, format, onEntry, errorPosition);
+}
+
+juce::Result PlaylistFile::parse(std::string_view text, Format format, const EntryCallback& onEntry, Position* errorPosition)
+{
+    Parser parser(text, onEntry, errorPosition);
+
+    switch (format)
+    {
+        case Format::csv:   return parser.parseCsv();
+        case Format::m3u:   return parser.parseM3u();
+        case Format::pls:   return parser.parsePls();
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Result PlaylistFile::write(const juce::File& file, const std::vector<Entry>& entries)
+{
+    Format format;
+
+    if (! getFormat(file, format))
+        return juce::Result::fail(file.getFileName() + " isn't a playlist");
+
+    // written beside the old file and renamed over it, so a failed export doesn't lose it
+    juce::TemporaryFile temp(file);
+
+    {
+        juce::FileOutputStream out(temp.getFile());
+
+        if (! out.openedOk())
+            return juce::Result::fail("Couldn't write " + file.getFullPathName());
+
+        switch (format)
+        {
+            case Format::csv:   writeCsv(out, entries); break;
+            case Format::m3u:   writeM3u(out, entries); break;
+            case Format::pls:   writePls(out, entries); break;
+        }
+
+        out.flush();
+
+        if (out.getStatus().failed())
+            return out.getStatus();
+    }
+
+    if (! temp.overwriteTargetFileWithTemporary())
+        return juce::Result::fail("Couldn't replace " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    PlaylistFile.h
+    Created: 18 Oct 2026 12:02:37am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+//==============================================================================
+/*
+    Reads and writes playlists exported by other DJ software and players:
+    CSV, M3U, M3U8 and PLS, told apart by their extension.
+
+    Files are memory-mapped and parsed in one pass, handing each track on as
+    soon as it's read, so however long the playlist is the only memory used
+    is the mapping itself. Entries are views into the file rather than
+    copies. The exceptions are a quoted CSV field with "" in it, which is
+    unescaped into a buffer that's reused for every row, and PLS, whose keys
+    can come in any order, so its entries are gathered up before they're
+    passed on.
+
+    CSV fields may be quoted, with "" for a quote and commas and line breaks
+    allowed inside. If the first row names a path column ("path", "location"
+    or "file") it's read as a header, and the title, artist, duration and
+    bpm columns are picked out by name. Without one, rows are the old
+    playlist.csv layout of title, length and path, or just a path.
+
+    M3U takes its titles and durations from #EXTINF lines, and PLS from the
+    TitleN and LengthN keys. Paths are given as written, so relative ones are
+    relative to the playlist. Text is UTF-8, apart from an .m3u that isn't
+    valid UTF-8, which is taken to be Latin-1 as older players wrote them.
+
+    A malformed line stops the parse, with the line and column it was found at.
+*/
+class PlaylistFile
+{
+public:
+    enum class Format
+    {
+        csv,
+        m3u,    // and m3u8, which is the same but always UTF-8
+        pls
+    };
+
+    /** one track in a playlist. The text points into the playlist and is only valid during the callback */
+    struct Entry
+    {
+        std::string_view path;
+        std::string_view title;
+        std::string_view artist;
+        double durationSeconds = -1.0;  // -1 if the playlist doesn't say
+        double bpm = 0.0;               // 0 if the playlist doesn't say
+        bool isLatin1 = false;          // the text is Latin-1 rather than UTF-8
+
+        /** one of the entry's text fields as a String, decoded the way the playlist was written */
+        juce::String toString(std::string_view text) const;
+    };
+
+    /** where in the text parsing stopped. Line and column count from 1, and columns are in bytes */
+    struct Position
+    {
+        juce::int64 offset = 0;
+        int line = 0;
+        int column = 0;
+    };
+
+    using EntryCallback = std::function<void(const Entry& entry)>;
+
+    /** the format of a file from its extension. Returns false if it isn't a playlist */
+    static bool getFormat(const juce::File& file, Format& format);
+
+    /** maps the file into memory and passes each track in it to onEntry, in order. If it fails
+        part way through, the tracks before the error have already been passed on */
+    static juce::Result read(const juce::File& file, const EntryCallback& onEntry, Position* errorPosition = nullptr);
+
+    /** the same for text that's already in memory */
+    static juce::Result parse(std::string_view text, Format format, const EntryCallback& onEntry,
+                              Position* errorPosition = nullptr);
+
+    /** writes the entries in the format of the file's extension, beside the old file and renamed over it */
+    static juce::Result write(const juce::File& file, const std::vector<Entry>& entries);
+};
@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+
+    ReadAheadSource.cpp
+    Created: 17 Oct 2026 10:14:37am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "ReadAheadSource.h"
+
+ReadAheadSource::ReadAheadSource(std::unique_ptr<juce::AudioFormatReader> _reader,
+                                 juce::TimeSliceThread& _thread,
+                                 int bufferSizeSamples,
+                                 ReadAheadStats& _stats)
+                                 : reader(std::move(_reader)),
+                                   thread(_thread),
+                                   stats(_stats),
+                                   ringSize(juce::jmax(8192, bufferSizeSamples)),
+                                   chunkSize(juce::jmin(8192, ringSize / 4))
+{
+    jassert(reader != nullptr);
+
+    ring.setSize(2, ringSize);
+    ring.clear();
+
+    thread.addTimeSliceClient(this);
+}
+
+ReadAheadSource::~ReadAheadSource()
+{
+    thread.removeTimeSliceClient(this); // waits for any read in progress to finish
+}
+
+void ReadAheadSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{}
+
+void ReadAheadSource::releaseResources()
+{}
+
+void ReadAheadSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    auto pos = nextReadPos.load();
+    const int numSamples = bufferToFill.numSamples;
+    const int numToCopy = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, getTotalLength() - pos);
+
+    stats.blocksRead++;
+
+    bool copied = false;
+
+    if (numToCopy > 0 && pos >= 0 && isBuffered(pos, numToCopy))
+    {
+        const int slot = (int) (pos % ringSize);
+        const int firstPart = juce::jmin(numToCopy, ringSize - slot);
+
+        for (int ch = 0; ch < bufferToFill.buffer->getNumChannels(); ++ch)
+        {
+            const int srcCh = juce::jmin(ch, ring.getNumChannels() - 1);
+            bufferToFill.buffer->copyFrom(ch, bufferToFill.startSample, ring, srcCh, slot, firstPart);
+
+            if (firstPart < numToCopy)
+                bufferToFill.buffer->copyFrom(ch, bufferToFill.startSample + firstPart, ring, srcCh, 0, numToCopy - firstPart);
+        }
+
+        // the background thread may have started overwriting these slots while we were copying
+        std::atomic_thread_fence(std::memory_order_acquire);
+        copied = isBuffered(pos, numToCopy);
+    }
+
+    if (numToCopy > 0 && ! copied) // not buffered in time, play silence rather than wait for the disk
+    {
+        bufferToFill.buffer->clear(bufferToFill.startSample, numToCopy);
+        stats.underruns++;
+        stats.samplesMissed += numToCopy;
+    }
+
+    if (numToCopy < numSamples) // past the end of the track
+        bufferToFill.buffer->clear(bufferToFill.startSample + numToCopy, numSamples - numToCopy);
+
+    // only advance if nobody seeked while we were reading
+    nextReadPos.compare_exchange_strong(pos, pos + numSamples);
+}
+
+void ReadAheadSource::setNextReadPosition(juce::int64 newPosition)
+{
+    nextReadPos.store(newPosition);
+}
+
+juce::int64 ReadAheadSource::getNextReadPosition() const
+{
+    return nextReadPos.load();
+}
+
+juce::int64 ReadAheadSource::getTotalLength() const
+{
+    return reader->lengthInSamples;
+}
+
+bool ReadAheadSource::isLooping() const
+{
+    return false;
+}
+
+double ReadAheadSource::getSampleRate() const
+{
+    return reader->sampleRate;
+}
+
+bool ReadAheadSource::waitForBufferedSamples(int numSamples, int timeoutMs)
+{
+    const auto startTime = juce::Time::getMillisecondCounter();
+
+    for (;;)
+    {
+        const auto pos = nextReadPos.load();
+        const int needed = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, getTotalLength() - pos);
+
+        if (needed == 0 || isBuffered(pos, needed))
+            return true;
+
+        if (juce::Time::getMillisecondCounter() - startTime > (juce::uint32) timeoutMs)
+            return false;
+
+        juce::Thread::sleep(2);
+    }
+}
+
+bool ReadAheadSource::isBuffered(juce::int64 start, int numSamples) const
+{
+    return validStart.load() <= start && start + numSamples <= validEnd.load();
+}
+
+int ReadAheadSource::useTimeSlice()
+{
+    const auto pos = juce::jmax((juce::int64) 0, nextReadPos.load());
+    const auto length = getTotalLength();
+    auto end = validEnd.load();
+
+    if (pos < validStart.load() || pos > end) // seeked outside the buffered range, start again from there
+    {
+        validStart.store(std::numeric_limits<juce::int64>::max()); // nothing is valid while we move the window
+        validEnd.store(pos);
+        validStart.store(pos);
+        end = pos;
+    }
+
+    // never write over samples at or after the read position
+    const int numToRead = (int) juce::jmin((juce::int64) chunkSize, pos + ringSize - end, length - end);
+
+    if (numToRead <= 0)
+        return 2; // buffer is full (or we've reached the end), check again shortly
+
+    // the slots we're about to fill currently hold the oldest samples, so drop them from the valid range first
+    validStart.store(juce::jmax(validStart.load(), end + numToRead - ringSize));
+
+    // a store only orders what came before it - without this the ring writes below could be seen
+    // first, and a reader's recheck after copying would still pass over torn samples
+    std::atomic_thread_fence(std::memory_order_release);
+    readIntoRing(end, numToRead);
+    validEnd.store(end + numToRead);
+
+    return 0;
+}
+
+void ReadAheadSource::readIntoRing(juce::int64 start, int numSamples)
+{
+    const int slot = (int) (start % ringSize);
+    const int firstPart = juce::jmin(numSamples, ringSize - slot);
+
+    reader->read(&ring, slot, firstPart, start, true, true);
+
+    if (firstPart < numSamples)
+        reader->read(&ring, 0, numSamples - firstPart, start + firstPart, true, true);
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    ReadAheadSource.h
+    Created: 17 Oct 2026 10:14:37am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/** Counters for a deck's read-ahead buffer. Written by the audio thread,
+    safe to read from anywhere.
+*/
+struct ReadAheadStats
+{
+    std::atomic<juce::int64> blocksRead{ 0 };       // blocks the audio thread asked for
+    std::atomic<juce::int64> underruns{ 0 };        // blocks that weren't buffered in time
+    std::atomic<juce::int64> samplesMissed{ 0 };    // samples output as silence because of an underrun
+    std::atomic<juce::int64> coldReads{ 0 };        // blocks read from a mapped file before their pages were touched
+    std::atomic<juce::int64> samplesReadCold{ 0 };  // samples in those blocks, which played but may have waited on the disk
+};
+
+//==============================================================================
+/*
+    Plays an AudioFormatReader through a ring buffer that is filled on a
+    background TimeSliceThread.
+
+    All reading and decoding happens on the background thread. The audio thread
+    only copies samples out of the ring buffer, and never takes a lock or waits:
+    if the samples it wants aren't there yet it outputs silence and counts an
+    underrun instead of blocking on I/O.
+
+    Seeks that land inside the part of the track that is already buffered are
+    instant; anything else makes the background thread restart from the new
+    position.
+*/
+class ReadAheadSource : public juce::PositionableAudioSource,
+                        private juce::TimeSliceClient
+{
+public:
+    ReadAheadSource(std::unique_ptr<juce::AudioFormatReader> reader,
+                    juce::TimeSliceThread& thread,
+                    int bufferSizeSamples,
+                    ReadAheadStats& stats);
+    ~ReadAheadSource() override;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    void setNextReadPosition(juce::int64 newPosition) override;
+    juce::int64 getNextReadPosition() const override;
+    juce::int64 getTotalLength() const override;
+    bool isLooping() const override;
+
+    /** blocks the calling thread until numSamples are buffered at the read position,
+        returns false if that didn't happen within timeoutMs. Never call this from the audio thread */
+    bool waitForBufferedSamples(int numSamples, int timeoutMs);
+
+    double getSampleRate() const;
+
+private:
+    int useTimeSlice() override;
+
+    bool isBuffered(juce::int64 start, int numSamples) const;
+    void readIntoRing(juce::int64 start, int numSamples);
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    juce::TimeSliceThread& thread;
+    ReadAheadStats& stats;
+
+    juce::AudioBuffer<float> ring;
+    const int ringSize;
+    const int chunkSize;
+
+    // the ring holds track samples [validStart, validEnd), slot = position % ringSize
+    std::atomic<juce::int64> nextReadPos{ 0 };
+    std::atomic<juce::int64> validStart{ 0 };
+    std::atomic<juce::int64> validEnd{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReadAheadSource)
+};
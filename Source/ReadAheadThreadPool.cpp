@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    ReadAheadThreadPool.cpp
+    Created: 17 Oct 2026 10:02:11am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "ReadAheadThreadPool.h"
+
+ReadAheadThreadPool::ReadAheadThreadPool(int numThreads)
+{
+    for (int i = 0; i < juce::jmax(1, numThreads); ++i)
+    {
+        auto* thread = threads.add(new juce::TimeSliceThread("Deck read-ahead " + juce::String(i + 1)));
+        thread->startThread();
+    }
+}
+
+ReadAheadThreadPool::~ReadAheadThreadPool()
+{
+    for (auto* thread : threads)
+        thread->stopThread(2000);
+}
+
+juce::TimeSliceThread& ReadAheadThreadPool::getNextThread()
+{
+    const int index = (int) (nextThread.fetch_add(1) % (unsigned int) threads.size());
+    return *threads[index];
+}
+
+int ReadAheadThreadPool::getNumThreads() const
+{
+    return threads.size();
+}
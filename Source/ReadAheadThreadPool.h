@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    ReadAheadThreadPool.h
+    Created: 17 Oct 2026 10:02:11am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/*
+    A small set of background threads that do all of the disk reading and
+    decoding for the decks, so that the audio callback only ever copies samples
+    that are already sitting in memory.
+
+    Tracks are handed out to the threads in round-robin order, which means a
+    deck reading from a slow disk or network share can't hold up the read-ahead
+    of the other deck.
+*/
+class ReadAheadThreadPool
+{
+public:
+    explicit ReadAheadThreadPool(int numThreads = 2);
+    ~ReadAheadThreadPool();
+
+    /** returns the thread that the next loaded track should read ahead on */
+    juce::TimeSliceThread& getNextThread();
+
+    int getNumThreads() const;
+
+private:
+    juce::OwnedArray<juce::TimeSliceThread> threads;
+    std::atomic<unsigned int> nextThread{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReadAheadThreadPool)
+};
@@ -0,0 +1,237 @@
+/*
+  ==============================================================================
+
+    ScrollingWaveformDisplay.cpp
+    Created: 17 Oct 2026 4:52:37pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ScrollingWaveformDisplay.h"
+
+//==============================================================================
+ScrollingWaveformDisplay::ScrollingWaveformDisplay(DJAudioPlayer& _player, PeakStore& _peakStore)
+                                                   : player(_player),
+                                                     peakStore(_peakStore),
+                                                     vBlankAttachment(this, [this] { onVBlank(); })
+{
+    setOpaque(true);
+}
+
+ScrollingWaveformDisplay::~ScrollingWaveformDisplay()
+{
+}
+
+void ScrollingWaveformDisplay::paint (juce::Graphics& g)
+{
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+
+    if (peaks != nullptr && ringStart != ringEnd)
+    {
+        // the visible columns start part way through the ring and wrap around its end
+        const int width = ring.getWidth();
+        const int height = ring.getHeight();
+        const int x0 = (int) (((visibleStart % width) + width) % width);
+        const int firstPart = width - x0;
+
+        g.drawImage(ring, 0, 0, firstPart, height, x0, 0, firstPart, height);
+
+        if (x0 > 0)
+            g.drawImage(ring, firstPart, 0, x0, height, 0, 0, x0, height);
+
+        g.setColour(juce::Colours::lightgreen);
+        g.fillRect(getWidth() / 2, 0, 2, getHeight());
+    }
+    else if (currentFile != juce::File())
+    {
+        g.setColour(juce::Colours::grey);
+        g.setFont(14.0f);
+        g.drawText("Building waveform...", getLocalBounds(), juce::Justification::centred, true);
+    }
+
+    g.setColour (juce::Colours::grey);
+    g.drawRect (getLocalBounds(), 1);
+
+    if (peaks != nullptr)
+    {
+        const auto frameMs = pendingUpdateMs + juce::Time::getMillisecondCounterHiRes() - startTime;
+        pendingUpdateMs = 0.0;
+
+        frameStats.numFrames++;
+        frameStats.lastFrameMs = frameMs;
+        frameStats.totalFrameMs += frameMs;
+        frameStats.maxFrameMs = juce::jmax(frameStats.maxFrameMs, frameMs);
+
+        if (frameMs > frameBudgetMs)
+            frameStats.numFramesOverBudget++;
+    }
+}
+
+void ScrollingWaveformDisplay::resized()
+{
+    ring = juce::Image(juce::Image::RGB, juce::jmax(1, getWidth()), juce::jmax(1, getHeight()), true);
+    invalidateColumns();
+}
+
+void ScrollingWaveformDisplay::mouseWheelMove(const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel)
+{
+    if (wheel.deltaY != 0.0f)
+        setSecondsVisible(secondsVisible * (wheel.deltaY > 0.0f ? 0.8 : 1.25));
+}
+
+void ScrollingWaveformDisplay::loadURL(juce::URL audioURL)
+{
+    peaks = nullptr;
+    currentFile = juce::File();
+    invalidateColumns();
+
+    if (audioURL.isLocalFile())
+    {
+        currentFile = audioURL.getLocalFile();
+        juce::Component::SafePointer<ScrollingWaveformDisplay> safeThis(this);
+
+        peaks = peakStore.getOrBuild(currentFile, [safeThis, file = currentFile](std::shared_ptr<const PeakFile> builtPeaks)
+        {
+            if (safeThis == nullptr || safeThis->currentFile != file || builtPeaks == nullptr)
+                return;
+
+            safeThis->peaks = builtPeaks;
+            safeThis->invalidateColumns();
+        });
+    }
+
+    repaint();
+}
+
+void ScrollingWaveformDisplay::setSecondsVisible(double seconds)
+{
+    seconds = juce::jlimit(minSecondsVisible, maxSecondsVisible, seconds);
+
+    if (seconds != secondsVisible)
+    {
+        secondsVisible = seconds;
+        invalidateColumns();
+    }
+}
+
+double ScrollingWaveformDisplay::getSecondsVisible() const
+{
+    return secondsVisible;
+}
+
+const ScrollingWaveformDisplay::FrameStats& ScrollingWaveformDisplay::getFrameStats() const
+{
+    return frameStats;
+}
+
+void ScrollingWaveformDisplay::resetFrameStats()
+{
+    frameStats = {};
+}
+
+void ScrollingWaveformDisplay::onVBlank()
+{
+    if (peaks == nullptr || getWidth() <= 0 || samplesPerColumn <= 0.0)
+        return;
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    const auto firstColumn = (juce::int64) std::floor(getSmoothedPosition() / samplesPerColumn) - getWidth() / 2;
+
+    if (firstColumn == visibleStart && ringStart != ringEnd)
+        return; // hasn't moved, so there's nothing to redraw
+
+    updateColumns(firstColumn);
+    visibleStart = firstColumn;
+
+    pendingUpdateMs = juce::Time::getMillisecondCounterHiRes() - startTime;
+    repaint();
+}
+
+double ScrollingWaveformDisplay::getSmoothedPosition()
+{
+    // the state says when its block was rendered and at what speed, so there's nothing to guess
+    return player.getPlaybackState().getPositionAt(juce::Time::getMillisecondCounterHiRes());
+}
+
+void ScrollingWaveformDisplay::updateColumns(juce::int64 firstColumn)
+{
+    const int width = ring.getWidth();
+    const auto lastColumn = firstColumn + width;
+
+    juce::Graphics g(ring);
+
+    if (ringStart == ringEnd || firstColumn >= ringEnd || lastColumn <= ringStart)
+    {
+        for (auto column = firstColumn; column < lastColumn; ++column)
+            renderColumn(g, column);
+    }
+    else
+    {
+        // only the columns that have scrolled in, from either side
+        for (auto column = firstColumn; column < ringStart; ++column)
+            renderColumn(g, column);
+
+        for (auto column = ringEnd; column < lastColumn; ++column)
+            renderColumn(g, column);
+    }
+
+    ringStart = firstColumn;
+    ringEnd = lastColumn;
+}
+
+void ScrollingWaveformDisplay::renderColumn(juce::Graphics& g, juce::int64 column)
+{
+    const int width = ring.getWidth();
+    const int height = ring.getHeight();
+    const int x = (int) (((column % width) + width) % width);
+
+    g.setColour(getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+    g.fillRect(x, 0, 1, height);
+
+    frameStats.numColumnsRendered++;
+
+    const auto startSample = column * samplesPerColumn;
+
+    if (startSample < 0 || startSample >= peaks->getLengthInSamples())
+        return;
+
+    const auto& level = peaks->getLevelFor(samplesPerColumn);
+    const int numChannels = peaks->getNumChannels();
+    const int first = (int) (startSample / level.samplesPerPeak);
+    const int last = juce::jmin(level.numPeaks, juce::jmax(first + 1, (int) ((startSample + samplesPerColumn) / level.samplesPerPeak)));
+
+    int min = 127, max = -127, rms = 0;
+
+    for (int i = first; i < last; ++i)
+    {
+        const auto& peak = level.get(i, 0, numChannels);
+        min = juce::jmin(min, (int) peak.min);
+        max = juce::jmax(max, (int) peak.max);
+        rms = juce::jmax(rms, (int) peak.rms);
+    }
+
+    if (min > max)
+        return;
+
+    const float midY = height * 0.5f;
+    const float halfHeight = height * 0.5f;
+
+    g.setColour(juce::Colours::orange);
+    g.drawVerticalLine(x, midY - max / 127.0f * halfHeight, midY - min / 127.0f * halfHeight + 1.0f);
+
+    // the body of the sound, which is what lines up when beatmatching
+    const float rmsHeight = rms / 255.0f * halfHeight;
+    g.setColour(juce::Colours::orange.brighter(0.6f));
+    g.drawVerticalLine(x, midY - rmsHeight, midY + rmsHeight + 1.0f);
+}
+
+void ScrollingWaveformDisplay::invalidateColumns()
+{
+    ringStart = ringEnd = 0;
+    samplesPerColumn = (peaks != nullptr && getWidth() > 0) ? secondsVisible * peaks->getSampleRate() / getWidth() : 0.0;
+    repaint();
+}
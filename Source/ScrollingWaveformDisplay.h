@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    ScrollingWaveformDisplay.h
+    Created: 17 Oct 2026 4:52:37pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+#include "PeakStore.h"
+
+//==============================================================================
+/*
+    A zoomed-in waveform strip that scrolls under a fixed playhead, for
+    beatmatching by eye.
+
+    It's updated from the display's vblank rather than a timer. The strip is
+    kept in an image used as a ring of pixel columns, so each frame only has
+    to draw the few columns that have scrolled into view and then blit the
+    ring in (at most) two pieces.
+
+    Between the audio thread's position updates the playhead is extrapolated
+    from the time and speed of the last block, so the strip moves smoothly
+    rather than in steps of one audio block.
+*/
+class ScrollingWaveformDisplay  : public juce::Component
+{
+public:
+    ScrollingWaveformDisplay(DJAudioPlayer& player, PeakStore& peakStore);
+    ~ScrollingWaveformDisplay() override;
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+    void mouseWheelMove(const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel) override;
+
+    /** shows the waveform of the given track, once its peaks are available */
+    void loadURL(juce::URL audioURL);
+
+    /** how many seconds of audio fit across the strip */
+    void setSecondsVisible(double seconds);
+    double getSecondsVisible() const;
+
+    static constexpr double minSecondsVisible = 2.0;
+    static constexpr double maxSecondsVisible = 60.0;
+
+    /** per-frame cost of keeping the strip up to date, in milliseconds */
+    struct FrameStats
+    {
+        int numFrames = 0;
+        int numFramesOverBudget = 0;
+        int numColumnsRendered = 0;
+        double lastFrameMs = 0.0;
+        double maxFrameMs = 0.0;
+        double totalFrameMs = 0.0;
+
+        double getAverageFrameMs() const { return numFrames > 0 ? totalFrameMs / numFrames : 0.0; }
+    };
+
+    const FrameStats& getFrameStats() const;
+    void resetFrameStats();
+
+    /** frames whose update and paint take longer than this are counted as over budget */
+    static constexpr double frameBudgetMs = 1000.0 / 60.0;
+
+private:
+    void onVBlank();
+
+    /** where the playhead is, in samples, extrapolated since the last audio block */
+    double getSmoothedPosition();
+
+    /** makes sure the ring holds columns [firstColumn, firstColumn + width) */
+    void updateColumns(juce::int64 firstColumn);
+    void renderColumn(juce::Graphics& g, juce::int64 column);
+    void invalidateColumns();
+
+    DJAudioPlayer& player;
+    PeakStore& peakStore;
+    std::shared_ptr<const PeakFile> peaks;
+    juce::File currentFile;
+
+    juce::VBlankAttachment vBlankAttachment;
+
+    double secondsVisible = 8.0;
+    double samplesPerColumn = 0.0;
+
+    // the ring of columns, column c lives at x = c mod width
+    juce::Image ring;
+    juce::int64 ringStart = 0;
+    juce::int64 ringEnd = 0;    // nothing rendered while ringStart == ringEnd
+    juce::int64 visibleStart = 0;
+
+    double pendingUpdateMs = 0.0;
+    FrameStats frameStats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ScrollingWaveformDisplay)
+};
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    SeqLock.h
+    Created: 17 Oct 2026 8:41:37pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+//==============================================================================
+/*
+    Shares a small value written by one thread with readers on others, without
+    a lock. The writer bumps a sequence number to odd, stores the value as
+    atomic words, then bumps it back to even; a reader copies the words and
+    only keeps them if the sequence was even and unchanged throughout.
+
+    tryRead never waits, so it's the one to use on the audio thread: if it
+    catches a write in progress it fails and the caller keeps its last copy.
+
+    Only one thread may write.
+*/
+template <typename Type>
+class SeqLock
+{
+public:
+    static_assert (std::is_trivially_copyable<Type>::value, "SeqLock copies values as raw words");
+
+    SeqLock(const Type& initialValue = Type())
+    {
+        write(initialValue);
+    }
+
+    void write(const Type& newValue)
+    {
+        const auto seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Words words{};
+        std::memcpy(words.data(), &newValue, sizeof(Type));
+
+        for (size_t i = 0; i < numWords; ++i)
+            data[i].store(words[i], std::memory_order_relaxed);
+
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /** returns false, leaving result alone, if a write was in progress */
+    bool tryRead(Type& result) const
+    {
+        const auto before = sequence.load(std::memory_order_acquire);
+
+        if ((before & 1) != 0)
+            return false;
+
+        Words words;
+
+        for (size_t i = 0; i < numWords; ++i)
+            words[i] = data[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (sequence.load(std::memory_order_relaxed) != before)
+            return false;
+
+        std::memcpy(&result, words.data(), sizeof(Type));
+        return true;
+    }
+
+    /** spins until it gets a consistent copy, so not for the audio thread */
+    Type read() const
+    {
+        Type result;
+
+        while (! tryRead(result))
+            std::this_thread::yield();
+
+        return result;
+    }
+
+private:
+    static constexpr size_t numWords = (sizeof(Type) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+    using Words = std::array<std::uint64_t, numWords>;
+
+    std::array<std::atomic<std::uint64_t>, numWords> data{};
+    std::atomic<std::uint32_t> sequence{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (SeqLock)
+};
@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+    ThreeBandEQ.cpp
+    Created: 17 Oct 2026 5:38:02pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "ThreeBandEQ.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <xmmintrin.h>
+#endif
+
+ThreeBandEQ::ThreeBandEQ()
+{
+    std::memset(&coefficients, 0, sizeof(coefficients));
+    prepare(sampleRate);
+}
+
+ThreeBandEQ::~ThreeBandEQ()
+{}
+
+void ThreeBandEQ::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    for (int band = high; band <= low; ++band)
+    {
+        gains[band] = targetGains[band].load();
+        smoothedGains[band].reset(sampleRate, smoothingSeconds);
+        smoothedGains[band].setCurrentAndTargetValue(gains[band]);
+        updateBand((Band) band);
+    }
+
+    reset();
+}
+
+void ThreeBandEQ::reset()
+{
+    std::memset(&state, 0, sizeof(state));
+}
+
+void ThreeBandEQ::setHighGain(float gain)
+{
+    targetGains[high].store(juce::jmax(minGain, gain));
+}
+
+void ThreeBandEQ::setMidGain(float gain)
+{
+    targetGains[mid].store(juce::jmax(minGain, gain));
+}
+
+void ThreeBandEQ::setLowGain(float gain)
+{
+    targetGains[low].store(juce::jmax(minGain, gain));
+}
+
+void ThreeBandEQ::updateBand(Band band)
+{
+    const float gain = gains[band];
+    juce::IIRCoefficients c;
+
+    switch (band)
+    {
+        case high: c = juce::IIRCoefficients::makeHighShelf(sampleRate, 7000, 0.5, gain); break;
+        case mid:  c = juce::IIRCoefficients::makePeakFilter(sampleRate, 2500, 0.555, gain); break;
+        case low:  c = juce::IIRCoefficients::makeLowShelf(sampleRate, 1000, 0.5, gain); break;
+    }
+
+    // IIRCoefficients are already normalised: b0 b1 b2 a1 a2
+    for (int lane = band * 2; lane < band * 2 + 2; ++lane)
+    {
+        coefficients.b0[lane] = c.coefficients[0];
+        coefficients.b1[lane] = c.coefficients[1];
+        coefficients.b2[lane] = c.coefficients[2];
+        coefficients.a1[lane] = c.coefficients[3];
+        coefficients.a2[lane] = c.coefficients[4];
+    }
+}
+
+void ThreeBandEQ::process(float* left, float* right, int numSamples)
+{
+    const juce::ScopedNoDenormals noDenormals;
+
+    for (int band = high; band <= low; ++band)
+    {
+        const float target = targetGains[band].load(std::memory_order_relaxed);
+
+        if (target != smoothedGains[band].getTargetValue())
+            smoothedGains[band].setTargetValue(target);
+    }
+
+    for (int start = 0; start < numSamples; start += subBlockSize)
+    {
+        const int numThisTime = juce::jmin(subBlockSize, numSamples - start);
+
+        // while a knob is moving, its band's coefficients follow it a sub-block at a time
+        for (int band = high; band <= low; ++band)
+        {
+            if (smoothedGains[band].isSmoothing())
+            {
+                gains[band] = smoothedGains[band].skip(numThisTime);
+                updateBand((Band) band);
+            }
+        }
+
+        processSubBlock(left + start, right + start, numThisTime);
+    }
+}
+
+void ThreeBandEQ::processSubBlock(float* left, float* right, int numSamples)
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    const __m128 b0A = _mm_load_ps(coefficients.b0), b0B = _mm_load_ps(coefficients.b0 + 4);
+    const __m128 b1A = _mm_load_ps(coefficients.b1), b1B = _mm_load_ps(coefficients.b1 + 4);
+    const __m128 b2A = _mm_load_ps(coefficients.b2), b2B = _mm_load_ps(coefficients.b2 + 4);
+    const __m128 a1A = _mm_load_ps(coefficients.a1), a1B = _mm_load_ps(coefficients.a1 + 4);
+    const __m128 a2A = _mm_load_ps(coefficients.a2), a2B = _mm_load_ps(coefficients.a2 + 4);
+
+    __m128 s1A = _mm_load_ps(state.s1), s1B = _mm_load_ps(state.s1 + 4);
+    __m128 s2A = _mm_load_ps(state.s2), s2B = _mm_load_ps(state.s2 + 4);
+    __m128 outA = _mm_load_ps(state.pipe);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // [L R hiL' hiR'] and [midL' midR' 0 0], where ' is last sample's output
+        const __m128 x = _mm_unpacklo_ps(_mm_load_ss(left + i), _mm_load_ss(right + i));
+        const __m128 inA = _mm_movelh_ps(x, outA);
+        const __m128 inB = _mm_movehl_ps(zero, outA);
+
+        outA = _mm_add_ps(_mm_mul_ps(b0A, inA), s1A);
+        s1A = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1A, inA), _mm_mul_ps(a1A, outA)), s2A);
+        s2A = _mm_sub_ps(_mm_mul_ps(b2A, inA), _mm_mul_ps(a2A, outA));
+
+        const __m128 outB = _mm_add_ps(_mm_mul_ps(b0B, inB), s1B);
+        s1B = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1B, inB), _mm_mul_ps(a1B, outB)), s2B);
+        s2B = _mm_sub_ps(_mm_mul_ps(b2B, inB), _mm_mul_ps(a2B, outB));
+
+        _mm_store_ss(left + i, outB);
+        _mm_store_ss(right + i, _mm_shuffle_ps(outB, outB, _MM_SHUFFLE(1, 1, 1, 1)));
+    }
+
+    _mm_store_ps(state.s1, s1A);
+    _mm_store_ps(state.s1 + 4, s1B);
+    _mm_store_ps(state.s2, s2A);
+    _mm_store_ps(state.s2 + 4, s2B);
+    _mm_store_ps(state.pipe, outA);
+   #else
+    const auto& c = coefficients;
+    auto& s = state;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float in[6] = { left[i], right[i], s.pipe[0], s.pipe[1], s.pipe[2], s.pipe[3] };
+        float out[6];
+
+        for (int lane = 0; lane < 6; ++lane)
+        {
+            out[lane] = c.b0[lane] * in[lane] + s.s1[lane];
+            s.s1[lane] = c.b1[lane] * in[lane] - c.a1[lane] * out[lane] + s.s2[lane];
+            s.s2[lane] = c.b2[lane] * in[lane] - c.a2[lane] * out[lane];
+        }
+
+        std::copy(out, out + 4, s.pipe);
+        left[i] = out[4];
+        right[i] = out[5];
+    }
+   #endif
+}
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    ThreeBandEQ.h
+    Created: 17 Oct 2026 5:38:02pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/*
+    The deck's high shelf, mid peak and low shelf, run as one fused pass over a
+    stereo buffer.
+
+    The six biquads (three bands x two channels) are packed into two 4-lane
+    vectors as transposed direct form II filters. The bands are skewed by a
+    sample each so they can all run in the same step: lanes [hiL hiR midL midR]
+    work on sample n while [loL loR] work on n - 2. The cost is 2 samples of
+    latency, in exchange for one pass and two vector biquads per sample instead
+    of six scalar passes.
+
+    Uses SSE where JUCE does, otherwise a scalar loop over the same lanes, so
+    both builds produce the same output.
+
+    The gain setters only store a target, so they never block the audio thread.
+    The audio thread glides each band towards its target and recomputes that
+    band's coefficients every sub-block while it moves, so sweeping a knob
+    doesn't zipper.
+*/
+class ThreeBandEQ
+{
+public:
+    ThreeBandEQ();
+    ~ThreeBandEQ();
+
+    static constexpr int latencySamples = 2;
+    static constexpr int subBlockSize = 32;
+    static constexpr double smoothingSeconds = 0.05;
+    static constexpr float minGain = 0.0001f;
+
+    /** call before processing starts, not while process() may be running */
+    void prepare(double sampleRate);
+    void reset();
+
+    /** band gains as linear factors, 1.0 leaves the band untouched. Safe to call from any thread */
+    void setHighGain(float gain);
+    void setMidGain(float gain);
+    void setLowGain(float gain);
+
+    /** filters a stereo pair in place, left and right may point to the same mono buffer */
+    void process(float* left, float* right, int numSamples);
+
+private:
+    enum Band { high = 0, mid, low };
+
+    void updateBand(Band band);
+    void processSubBlock(float* left, float* right, int numSamples);
+
+    // lane layout: 0/1 high L/R, 2/3 mid L/R, 4/5 low L/R, 6/7 unused
+    struct alignas(16) Coefficients
+    {
+        float b0[8], b1[8], b2[8], a1[8], a2[8];
+    };
+
+    struct alignas(16) State
+    {
+        float s1[8], s2[8];
+        float pipe[4]; // last output of the high and mid lanes, fed forward to the next band
+    };
+
+    Coefficients coefficients;
+    State state;
+
+    double sampleRate = 48000.0;
+
+    std::atomic<float> targetGains[3] = { 1.0f, 1.0f, 1.0f };   // written by the UI
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> smoothedGains[3];
+    float gains[3] = { 1.0f, 1.0f, 1.0f };                      // what the coefficients were last made from
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreeBandEQ)
+};
@@ -0,0 +1,302 @@
+/*
+  ==============================================================================
+
+    TimeStretchSource.cpp
+    Created: 17 Oct 2026 6:44:19pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "TimeStretchSource.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <xmmintrin.h>
+#endif
+
+namespace
+{
+    float dotProduct(const float* a, const float* b, int num)
+    {
+        float total = 0.0f;
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        __m128 sum = _mm_setzero_ps();
+
+        for (; i + 4 <= num; i += 4)
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, sum);
+        total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+       #endif
+
+        for (; i < num; ++i)
+            total += a[i] * b[i];
+
+        return total;
+    }
+
+    int msToSamples(double ms, double sampleRate)
+    {
+        return juce::roundToInt(ms * sampleRate / 1000.0);
+    }
+}
+
+TimeStretchSource::Settings TimeStretchSource::getSettings(Quality quality)
+{
+    switch (quality)
+    {
+        case Quality::low:    return { 20.0, 4.0, 4 };
+        case Quality::medium: return { 40.0, 8.0, 2 };
+        case Quality::high:   return { 60.0, 12.0, 1 };
+    }
+
+    return { 40.0, 8.0, 2 };
+}
+
+double TimeStretchSource::getLatencyMs(Quality quality)
+{
+    const auto settings = getSettings(quality);
+    return settings.frameMs + settings.searchMs;
+}
+
+TimeStretchSource::TimeStretchSource(juce::AudioSource* _input)
+                                     : input(_input)
+{
+    jassert(input != nullptr);
+}
+
+TimeStretchSource::~TimeStretchSource()
+{}
+
+void TimeStretchSource::prepareToPlay(int samplesPerBlockExpected, double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    // sized for the most demanding quality, so switching quality never allocates
+    const auto highest = getSettings(Quality::high);
+    const int maxFrame = (msToSamples(highest.frameMs, sampleRate) + 1) & ~1;
+    const int maxRadius = msToSamples(highest.searchMs, sampleRate);
+    const int inputCapacity = 4 * maxRadius + 3 * (int) (maxFrame * maxSpeed) + 2 * pullSize;
+
+    inputBuffer.setSize(2, inputCapacity);
+    monoInput.assign((size_t) inputCapacity, 0.0f);
+    pullBuffer.setSize(2, pullSize);
+    overlapBuffer.setSize(2, maxFrame / 2);
+    outputBuffer.setSize(2, maxFrame / 2);
+    window.assign((size_t) maxFrame, 0.0f);
+
+    input->prepareToPlay(samplesPerBlockExpected, sampleRate);
+
+    configure();
+    reset();
+}
+
+void TimeStretchSource::releaseResources()
+{
+    input->releaseResources();
+}
+
+void TimeStretchSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    if (! enabled || frameSize == 0)
+    {
+        input->getNextAudioBlock(bufferToFill);
+        return;
+    }
+
+    auto* dest = bufferToFill.buffer;
+    const int numChannels = juce::jmin(2, dest->getNumChannels());
+    int done = 0;
+
+    while (done < bufferToFill.numSamples)
+    {
+        if (outputRead == outputCount)
+            synthesiseFrame();
+
+        const int numThisTime = juce::jmin(bufferToFill.numSamples - done, outputCount - outputRead);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            dest->copyFrom(ch, bufferToFill.startSample + done, outputBuffer, ch, outputRead, numThisTime);
+
+        outputRead += numThisTime;
+        done += numThisTime;
+    }
+
+    for (int ch = numChannels; ch < dest->getNumChannels(); ++ch)
+        dest->clear(ch, bufferToFill.startSample, bufferToFill.numSamples);
+}
+
+void TimeStretchSource::setEnabled(bool shouldBeEnabled)
+{
+    if (shouldBeEnabled != enabled)
+    {
+        enabled = shouldBeEnabled;
+        reset();
+    }
+}
+
+bool TimeStretchSource::isEnabled() const
+{
+    return enabled;
+}
+
+void TimeStretchSource::setSpeed(double newSpeed)
+{
+    speed = juce::jlimit(minSpeed, maxSpeed, newSpeed);
+}
+
+void TimeStretchSource::setQuality(Quality newQuality)
+{
+    if (newQuality != quality)
+    {
+        quality = newQuality;
+        configure();
+        reset();
+    }
+}
+
+TimeStretchSource::Quality TimeStretchSource::getQuality() const
+{
+    return quality;
+}
+
+void TimeStretchSource::reset()
+{
+    inputCount = 0;
+    nominalPos = 0.0;
+    naturalPos = -1;
+    outputCount = outputRead = 0;
+    overlapBuffer.clear();
+}
+
+void TimeStretchSource::configure()
+{
+    if (window.empty())
+        return; // not prepared yet
+
+    const auto settings = getSettings(quality);
+
+    frameSize = juce::jmin((int) window.size(), (msToSamples(settings.frameMs, sampleRate) + 1) & ~1);
+    hopSize = frameSize / 2;
+    searchRadius = msToSamples(settings.searchMs, sampleRate);
+    searchStep = settings.searchStep;
+
+    // periodic Hann, so frames overlapping by half sum to exactly 1
+    for (int i = 0; i < frameSize; ++i)
+        window[(size_t) i] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float) i / (float) frameSize);
+}
+
+void TimeStretchSource::synthesiseFrame()
+{
+    pullInput(frameSize);
+
+    const int nominal = (int) std::floor(nominalPos);
+    int best = juce::jmax(0, nominal);
+
+    // find the offset where this frame best continues the last one
+    if (naturalPos >= 0)
+    {
+        const float* target = monoInput.data() + naturalPos;
+        const int first = juce::jmax(0, nominal - searchRadius);
+        const int last = juce::jmin(nominal + searchRadius, inputCount - frameSize);
+        float bestScore = std::numeric_limits<float>::lowest();
+
+        for (int candidate = first; candidate <= last; candidate += searchStep)
+        {
+            const float score = dotProduct(target, monoInput.data() + candidate, hopSize);
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                best = candidate;
+            }
+        }
+    }
+
+    best = juce::jlimit(0, juce::jmax(0, inputCount - frameSize), best);
+
+    // first half overlaps what's left of the last frame and is finished, second half waits for the next
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        const float* in = inputBuffer.getReadPointer(ch, best);
+        float* out = outputBuffer.getWritePointer(ch);
+        float* overlap = overlapBuffer.getWritePointer(ch);
+
+        juce::FloatVectorOperations::multiply(out, in, window.data(), hopSize);
+        juce::FloatVectorOperations::add(out, overlap, hopSize);
+        juce::FloatVectorOperations::multiply(overlap, in + hopSize, window.data() + hopSize, hopSize);
+    }
+
+    outputRead = 0;
+    outputCount = hopSize;
+
+    naturalPos = best + hopSize;
+    nominalPos += speed * hopSize;
+}
+
+void TimeStretchSource::pullInput(int frameLength)
+{
+    for (;;)
+    {
+        const int needed = juce::jmax((int) std::floor(nominalPos) + searchRadius + frameLength, naturalPos + frameLength);
+
+        if (inputCount >= needed)
+            return;
+
+        if (inputCount + pullSize > inputBuffer.getNumSamples())
+        {
+            compactInput();
+
+            if (inputCount + pullSize > inputBuffer.getNumSamples())
+            {
+                jassertfalse; // the input buffer should always be big enough for a frame and its search range
+                return;
+            }
+        }
+
+        pullBuffer.clear();
+        input->getNextAudioBlock(juce::AudioSourceChannelInfo(&pullBuffer, 0, pullSize));
+
+        for (int ch = 0; ch < 2; ++ch)
+            inputBuffer.copyFrom(ch, inputCount, pullBuffer, ch, 0, pullSize);
+
+        float* mono = monoInput.data() + inputCount;
+        juce::FloatVectorOperations::copy(mono, pullBuffer.getReadPointer(0), pullSize);
+        juce::FloatVectorOperations::add(mono, pullBuffer.getReadPointer(1), pullSize);
+
+        inputCount += pullSize;
+    }
+}
+
+void TimeStretchSource::compactInput()
+{
+    // nothing before the earlier of the next search range and the natural continuation will be used again
+    int discard = (int) std::floor(nominalPos) - searchRadius;
+
+    if (naturalPos >= 0)
+        discard = juce::jmin(discard, naturalPos);
+
+    discard = juce::jmin(discard, inputCount);
+
+    if (discard <= 0)
+        return;
+
+    const int remaining = inputCount - discard;
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        float* data = inputBuffer.getWritePointer(ch);
+        std::memmove(data, data + discard, (size_t) remaining * sizeof(float));
+    }
+
+    std::memmove(monoInput.data(), monoInput.data() + discard, (size_t) remaining * sizeof(float));
+
+    inputCount = remaining;
+    nominalPos -= discard;
+
+    if (naturalPos >= 0)
+        naturalPos -= discard;
+}
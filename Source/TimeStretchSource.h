@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    TimeStretchSource.h
+    Created: 17 Oct 2026 6:44:19pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/*
+    Changes the speed of its input without changing its pitch, for key-lock.
+
+    This is WSOLA: the output is built from overlapping Hann-windowed frames
+    of the input. Each frame is taken from near where the speed says it should
+    come from, nudged within a small search range to wherever it lines up
+    best with the previous frame, so the waveform carries on without phasing.
+    The search is a cross-correlation on a mono mix, done with SIMD dot
+    products.
+
+    Quality trades fidelity against cycles and latency: longer frames keep
+    low frequencies cleaner, and a wider, finer search finds better splices.
+    All buffers are sized for the highest quality in prepareToPlay, so
+    changing quality or speed never allocates.
+
+    Everything apart from prepareToPlay and releaseResources is for the audio
+    thread only.
+*/
+class TimeStretchSource : public juce::AudioSource
+{
+public:
+    enum class Quality { low = 0, medium, high };
+
+    struct Settings
+    {
+        double frameMs;    // length of each windowed frame
+        double searchMs;   // how far either side of the nominal position to search
+        int searchStep;    // search every n-th offset
+    };
+
+    static Settings getSettings(Quality quality);
+
+    /** roughly how far behind its input the output runs at a quality */
+    static double getLatencyMs(Quality quality);
+
+    TimeStretchSource(juce::AudioSource* input);
+    ~TimeStretchSource() override;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    /** when disabled, the input is passed straight through */
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const;
+
+    /** how many input samples to play per output sample, 1.0 being normal speed */
+    void setSpeed(double newSpeed);
+
+    /** resets the stretcher if the quality changes */
+    void setQuality(Quality newQuality);
+    Quality getQuality() const;
+
+    /** drops anything buffered, e.g. after a seek or a new track */
+    void reset();
+
+private:
+    void configure();
+    void synthesiseFrame();
+    void pullInput(int minSamples);
+    void compactInput();
+
+    juce::AudioSource* input;
+
+    double sampleRate = 48000.0;
+    bool enabled = false;
+    double speed = 1.0;
+    Quality quality = Quality::medium;
+
+    // current frame geometry, from the quality and sample rate
+    int frameSize = 0;
+    int hopSize = 0;       // output hop, half a frame
+    int searchRadius = 0;
+    int searchStep = 1;
+
+    static constexpr int pullSize = 256;
+    static constexpr double minSpeed = 0.5, maxSpeed = 2.0;
+
+    // input waiting to be used, starting at sample 0
+    juce::AudioBuffer<float> inputBuffer;
+    std::vector<float> monoInput;
+    int inputCount = 0;
+    juce::AudioBuffer<float> pullBuffer;
+
+    double nominalPos = 0.0;    // where the next frame should come from, if it weren't for the search
+    int naturalPos = -1;        // where the last frame would have carried on, -1 before the first frame
+
+    // second half of the last frame, waiting for the next one to overlap it
+    juce::AudioBuffer<float> overlapBuffer;
+
+    // finished output, a hop at a time
+    juce::AudioBuffer<float> outputBuffer;
+    int outputCount = 0;
+    int outputRead = 0;
+
+    std::vector<float> window;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimeStretchSource)
+};
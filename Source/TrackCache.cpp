@@ -0,0 +1,260 @@
+/*
+  ==============================================================================
+
+    TrackCache.cpp
+    Created: 17 Oct 2026 1:12:05pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "TrackCache.h"
+
+size_t TrackCache::Entry::getSizeInBytes() const
+{
+    if (format == SampleFormat::int16)
+        return int16Samples.size() * sizeof(juce::int16);
+
+    return (size_t) floatSamples.getNumChannels() * (size_t) floatSamples.getNumSamples() * sizeof(float);
+}
+
+void TrackCache::Entry::read(juce::AudioBuffer<float>& dest, int destStartSample, juce::int64 sourceStartSample, int numSamples) const
+{
+    const int numToCopy = sourceStartSample < 0 ? 0
+                        : (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, lengthInSamples - sourceStartSample);
+
+    for (int ch = 0; ch < dest.getNumChannels() && numToCopy > 0; ++ch)
+    {
+        const int srcCh = juce::jmin(ch, numChannels - 1);
+
+        if (format == SampleFormat::float32)
+        {
+            dest.copyFrom(ch, destStartSample, floatSamples, srcCh, (int) sourceStartSample, numToCopy);
+        }
+        else
+        {
+            const auto* src = int16Samples.data() + (size_t) srcCh * (size_t) lengthInSamples + (size_t) sourceStartSample;
+            auto* out = dest.getWritePointer(ch, destStartSample);
+
+            for (int i = 0; i < numToCopy; ++i)
+                out[i] = src[i] * (1.0f / 32767.0f);
+        }
+    }
+
+    if (numToCopy < numSamples) // past the end of the track (or before the start)
+        dest.clear(destStartSample + numToCopy, numSamples - numToCopy);
+}
+
+//==============================================================================
+TrackCache::TrackCache(juce::AudioFormatManager& _formatManager,
+                       size_t memoryLimitBytes,
+                       SampleFormat format)
+                       : formatManager(_formatManager),
+                         sampleFormat(format)
+{
+    stats.memoryLimit = memoryLimitBytes;
+}
+
+TrackCache::~TrackCache()
+{}
+
+std::shared_ptr<const TrackCache::Entry> TrackCache::find(const juce::File& file)
+{
+    const auto path = file.getFullPathName();
+    const auto modificationTime = file.getLastModificationTime(); // outside the lock, this touches the disk
+
+    const juce::ScopedLock sl(lock);
+    auto it = entriesByPath.find(path);
+
+    if (it == entriesByPath.end())
+    {
+        stats.misses++;
+        return nullptr;
+    }
+
+    auto entry = *it->second;
+
+    if (entry->modificationTime != modificationTime) // the file has changed since we decoded it
+    {
+        stats.bytesInUse -= entry->getSizeInBytes();
+        stats.numEntries--;
+        lruList.erase(it->second);
+        entriesByPath.erase(it);
+        stats.misses++;
+        return nullptr;
+    }
+
+    lruList.splice(lruList.begin(), lruList, it->second);
+    stats.hits++;
+    return entry;
+}
+
+bool TrackCache::containsOrIsDecoding(const juce::File& file)
+{
+    const auto path = file.getFullPathName();
+
+    const juce::ScopedLock sl(lock);
+    return entriesByPath.count(path) > 0 || pathsBeingDecoded.count(path) > 0;
+}
+
+std::shared_ptr<const TrackCache::Entry> TrackCache::decodeAndAdd(const juce::File& file)
+{
+    const auto path = file.getFullPathName();
+    SampleFormat format;
+
+    {
+        const juce::ScopedLock sl(lock);
+
+        if (pathsBeingDecoded.count(path) > 0)
+            return nullptr;
+
+        pathsBeingDecoded.insert(path);
+        format = sampleFormat;
+    }
+
+    size_t bytesReserved = 0;
+
+    auto finishedDecoding = [this, &path, &bytesReserved]
+    {
+        const juce::ScopedLock sl(lock);
+        pathsBeingDecoded.erase(path);
+        stats.bytesReserved -= bytesReserved;
+    };
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->lengthInSamples > std::numeric_limits<int>::max())
+    {
+        finishedDecoding();
+        return nullptr;
+    }
+
+    auto entry = std::make_shared<Entry>();
+    entry->path = path;
+    entry->modificationTime = file.getLastModificationTime();
+    entry->sampleRate = reader->sampleRate;
+    entry->lengthInSamples = reader->lengthInSamples;
+    entry->numChannels = (int) juce::jmin(2u, reader->numChannels); // decks are stereo
+    entry->format = format;
+
+    const int length = (int) entry->lengthInSamples;
+    const size_t bytesNeeded = (size_t) entry->numChannels * (size_t) length * (format == SampleFormat::int16 ? sizeof(juce::int16) : sizeof(float));
+
+    {
+        // room is made and set aside before the buffer is allocated, so decodes running side by
+        // side can't between them take memory past the limit. Nothing is evicted for a track that's
+        // too big for the cache, or whose room is held by the other decodes
+        const juce::ScopedLock sl(lock);
+
+        if (stats.bytesReserved + bytesNeeded > stats.memoryLimit)
+        {
+            pathsBeingDecoded.erase(path);
+            return nullptr;
+        }
+
+        evictUntilFits(bytesNeeded);
+        stats.bytesReserved += bytesNeeded;
+        bytesReserved = bytesNeeded;
+    }
+
+    const int chunkSize = 65536;
+    juce::AudioBuffer<float> chunk;
+
+    if (format == SampleFormat::float32)
+        entry->floatSamples.setSize(entry->numChannels, length);
+    else
+    {
+        entry->int16Samples.resize((size_t) entry->numChannels * (size_t) length);
+        chunk.setSize(entry->numChannels, chunkSize);
+    }
+
+    for (int pos = 0; pos < length; pos += chunkSize)
+    {
+        // give up if the pool we're running on is shutting down
+        if (auto* job = juce::ThreadPoolJob::getCurrentThreadPoolJob())
+        {
+            if (job->shouldExit())
+            {
+                finishedDecoding();
+                return nullptr;
+            }
+        }
+
+        const int numToRead = juce::jmin(chunkSize, length - pos);
+
+        if (format == SampleFormat::float32)
+        {
+            reader->read(&entry->floatSamples, pos, numToRead, pos, true, true);
+        }
+        else
+        {
+            reader->read(&chunk, 0, numToRead, pos, true, true);
+
+            for (int ch = 0; ch < entry->numChannels; ++ch)
+            {
+                const float* src = chunk.getReadPointer(ch);
+                auto* dest = entry->int16Samples.data() + (size_t) ch * (size_t) length + (size_t) pos;
+
+                for (int i = 0; i < numToRead; ++i)
+                    dest[i] = (juce::int16) juce::roundToInt(juce::jlimit(-1.0f, 1.0f, src[i]) * 32767.0f);
+            }
+        }
+    }
+
+    const juce::ScopedLock sl(lock);
+    pathsBeingDecoded.erase(path);
+    stats.bytesReserved -= bytesReserved;
+
+    if (entriesByPath.count(path) > 0) // someone else got there first
+        return *entriesByPath[path];
+
+    evictUntilFits(bytesNeeded);
+
+    lruList.push_front(entry);
+    entriesByPath[path] = lruList.begin();
+    stats.bytesInUse += bytesNeeded;
+    stats.numEntries++;
+
+    return entry;
+}
+
+void TrackCache::evictUntilFits(size_t extraBytes)
+{
+    while (! lruList.empty() && stats.bytesInUse + stats.bytesReserved + extraBytes > stats.memoryLimit)
+    {
+        const auto& oldest = lruList.back();
+        stats.bytesInUse -= oldest->getSizeInBytes();
+        stats.numEntries--;
+        stats.evictions++;
+        entriesByPath.erase(oldest->path);
+        lruList.pop_back(); // decks still playing this track keep their own reference to it
+    }
+}
+
+void TrackCache::setMemoryLimit(size_t newLimitBytes)
+{
+    const juce::ScopedLock sl(lock);
+    stats.memoryLimit = newLimitBytes;
+    evictUntilFits(0);
+}
+
+void TrackCache::setSampleFormat(SampleFormat newFormat)
+{
+    const juce::ScopedLock sl(lock);
+    sampleFormat = newFormat;
+}
+
+void TrackCache::clear()
+{
+    const juce::ScopedLock sl(lock);
+    lruList.clear();
+    entriesByPath.clear();
+    stats.bytesInUse = 0;
+    stats.numEntries = 0;
+}
+
+TrackCache::Stats TrackCache::getStats() const
+{
+    const juce::ScopedLock sl(lock);
+    return stats;
+}
@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    TrackCache.h
+    Created: 17 Oct 2026 1:12:05pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+//==============================================================================
+/*
+    Keeps fully decoded copies of recently played tracks in memory, so loading
+    the same file again (on either deck) doesn't have to open and decode it,
+    and seeking within it is just an index change.
+
+    Entries are keyed by file path and modification time, and the least recently
+    used ones are evicted once the total size goes over the memory limit. Samples
+    can be kept as 32-bit floats, or as 16-bit ints to fit twice as many tracks.
+*/
+class TrackCache
+{
+public:
+    enum class SampleFormat
+    {
+        float32,
+        int16
+    };
+
+    /** a decoded track. Never changes once it's in the cache, so it's safe to read from any thread */
+    struct Entry
+    {
+        juce::String path;
+        juce::Time modificationTime;
+        double sampleRate = 0.0;
+        juce::int64 lengthInSamples = 0;
+        int numChannels = 0;
+        SampleFormat format = SampleFormat::float32;
+
+        juce::AudioBuffer<float> floatSamples;        // used when format is float32
+        std::vector<juce::int16> int16Samples;        // used when format is int16, one channel after another
+
+        size_t getSizeInBytes() const;
+
+        /** copies samples into dest, converting from int16 if needed. Channels past the
+            track's own are filled with its last channel, and anything past the end is cleared */
+        void read(juce::AudioBuffer<float>& dest, int destStartSample, juce::int64 sourceStartSample, int numSamples) const;
+    };
+
+    struct Stats
+    {
+        juce::int64 hits = 0;
+        juce::int64 misses = 0;
+        juce::int64 evictions = 0;
+        size_t bytesInUse = 0;
+        size_t bytesReserved = 0;   // set aside for tracks being decoded, counted against the limit
+        size_t memoryLimit = 0;
+        int numEntries = 0;
+    };
+
+    TrackCache(juce::AudioFormatManager& formatManager,
+               size_t memoryLimitBytes = (size_t) 1024 * 1024 * 1024,
+               SampleFormat format = SampleFormat::float32);
+    ~TrackCache();
+
+    /** returns the decoded track if it's cached and the file hasn't changed since, or nullptr */
+    std::shared_ptr<const Entry> find(const juce::File& file);
+
+    /** decodes the whole file and adds it to the cache. This can take a while, so call it from a
+        background thread. Returns nullptr if the file can't be read or wouldn't fit in the cache,
+        including when the room left is held by other decodes */
+    std::shared_ptr<const Entry> decodeAndAdd(const juce::File& file);
+
+    /** true if the file is cached or being decoded right now */
+    bool containsOrIsDecoding(const juce::File& file);
+
+    void setMemoryLimit(size_t newLimitBytes);
+    void setSampleFormat(SampleFormat newFormat); // applies to tracks decoded from now on
+    void clear();
+
+    Stats getStats() const;
+
+private:
+    void evictUntilFits(size_t extraBytes);
+
+    juce::AudioFormatManager& formatManager;
+
+    juce::CriticalSection lock;
+    std::list<std::shared_ptr<const Entry>> lruList; // most recently used at the front
+    std::map<juce::String, std::list<std::shared_ptr<const Entry>>::iterator> entriesByPath;
+    std::set<juce::String> pathsBeingDecoded;
+
+    SampleFormat sampleFormat;
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackCache)
+};
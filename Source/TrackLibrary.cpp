@@ -0,0 +1,454 @@
+/*
+  ==============================================================================
+
+    TrackLibrary.cpp
+    Created: 18 Oct 2026 1:14:22am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "TrackLibrary.h"
+#include <cstring>
+
+namespace
+{
+    const char snapshotMagic[4] = { 'O', 'T', 'L', 'B' };
+    constexpr size_t snapshotHeaderSize = 12;
+    constexpr size_t minTrackRecordSize = 4 + 4 * 4 + 4 * 8;
+
+    enum : juce::uint8
+    {
+        opAddOrUpdate = 1,
+        opRemove = 2
+    };
+
+    void writeString(juce::MemoryOutputStream& out, const juce::String& text)
+    {
+        const auto numBytes = text.getNumBytesAsUTF8();
+        out.writeInt((int) numBytes);
+        out.write(text.toRawUTF8(), numBytes);
+    }
+
+    void writeTrack(juce::MemoryOutputStream& out, const LibraryTrack& track)
+    {
+        // the size goes in front of the fields, so it's filled in once they've been written
+        const auto sizePosition = out.getPosition();
+        out.writeInt(0);
+
+        writeString(out, track.path);
+        writeString(out, track.title);
+        writeString(out, track.artist);
+        writeString(out, track.key);
+        out.writeDouble(track.durationSeconds);
+        out.writeDouble(track.bpm);
+        out.writeInt64(track.fileSize);
+        out.writeInt64(track.modificationTime);
+
+        const auto endPosition = out.getPosition();
+        out.setPosition(sizePosition);
+        out.writeInt((int) (endPosition - sizePosition - 4));
+        out.setPosition(endPosition);
+    }
+
+    /** reads fields out of a file loaded into memory, refusing to go past the end of it */
+    struct Reader
+    {
+        const char* data;
+        size_t size;
+        size_t position = 0;
+
+        bool canRead(size_t numBytes) const { return numBytes <= size - position; }
+
+        juce::uint32 readUInt32()
+        {
+            const auto value = juce::ByteOrder::littleEndianInt(data + position);
+            position += 4;
+            return value;
+        }
+
+        juce::int64 readInt64()
+        {
+            const auto value = (juce::int64) juce::ByteOrder::littleEndianInt64(data + position);
+            position += 8;
+            return value;
+        }
+
+        double readDouble()
+        {
+            const auto bits = readInt64();
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        bool readString(juce::String& text)
+        {
+            if (! canRead(4))
+                return false;
+
+            const auto numBytes = readUInt32();
+
+            if (! canRead(numBytes))
+                return false;
+
+            text = juce::String::fromUTF8(data + position, (int) numBytes);
+            position += numBytes;
+            return true;
+        }
+
+        bool readTrack(LibraryTrack& track)
+        {
+            if (! canRead(4))
+                return false;
+
+            const auto recordSize = readUInt32();
+
+            if (! canRead(recordSize))
+                return false;
+
+            const auto end = position + recordSize;
+
+            if (! (readString(track.path) && readString(track.title) && readString(track.artist) && readString(track.key))
+                || position > end || end - position < 32)
+                return false;
+
+            track.durationSeconds = readDouble();
+            track.bpm = readDouble();
+            track.fileSize = readInt64();
+            track.modificationTime = readInt64();
+
+            position = end; // skips anything a later version has added to the record
+            return true;
+        }
+    };
+
+    /** writes a snapshot of the tracks, for the journal to call on whichever thread writes it */
+    std::function<bool(juce::OutputStream&)> makeSnapshotWriter(std::vector<LibraryTrack> snapshotTracks)
+    {
+        return [snapshotTracks = std::move(snapshotTracks)](juce::OutputStream& out)
+        {
+            juce::MemoryOutputStream snapshot;
+            snapshot.write(snapshotMagic, sizeof(snapshotMagic));
+            snapshot.writeInt((int) TrackLibrary::currentVersion);
+            snapshot.writeInt((int) snapshotTracks.size());
+
+            for (const auto& track : snapshotTracks)
+                writeTrack(snapshot, track);
+
+            return out.write(snapshot.getData(), snapshot.getDataSize());
+        };
+    }
+}
+
+//==============================================================================
+juce::String LibraryTrack::getDurationText() const
+{
+    if (durationSeconds <= 0)
+        return "-";
+
+    const int lengthInSeconds = (int) durationSeconds;
+    return juce::String(lengthInSeconds / 60) + "m " + juce::String(lengthInSeconds % 60) + "s";
+}
+
+//==============================================================================
+TrackLibrary::TrackLibrary(const juce::File& _file)
+    : file(_file),
+      journal(_file, getLogFile())
+{}
+
+TrackLibrary::~TrackLibrary()
+{}
+
+juce::Result TrackLibrary::load()
+{
+    journal.flush();
+
+    tracks.clear();
+    rowRevisions.clear();
+
+    if (file.existsAsFile())
+    {
+        juce::MemoryBlock data;
+
+        if (! file.loadFileAsData(data))
+            return failLoad("Couldn't read " + file.getFullPathName());
+
+        Reader reader{ static_cast<const char*>(data.getData()), data.getSize() };
+
+        if (! reader.canRead(snapshotHeaderSize) || std::memcmp(reader.data, snapshotMagic, sizeof(snapshotMagic)) != 0)
+            return failLoad(file.getFullPathName() + " isn't a library file");
+
+        reader.position = sizeof(snapshotMagic);
+
+        if (reader.readUInt32() > currentVersion)
+            return failLoad(file.getFullPathName() + " was saved by a newer version");
+
+        const auto numTracks = reader.readUInt32();
+        tracks.reserve(juce::jmin((size_t) numTracks, data.getSize() / minTrackRecordSize));
+
+        for (juce::uint32 i = 0; i < numTracks; ++i)
+        {
+            LibraryTrack track;
+
+            if (! reader.readTrack(track))
+                return failLoad(file.getFullPathName() + " is damaged");
+
+            tracks.push_back(std::move(track));
+        }
+    }
+
+    layoutRevision = ++revision;
+    rowRevisions.assign(tracks.size(), revision);
+    rebuildIndex(0);
+
+    const auto logContents = journal.read([this](const char* data, size_t size) { applyRecords(data, size); });
+
+    // its edits can't be replayed, and appending or starting a new log would lose them
+    if (logContents.version != 0 && logContents.version != LibraryJournal::currentVersion)
+        return failLoad(getLogFile().getFullPathName() + " was saved by a different version");
+
+    journal.open(logContents.validBytes);
+    readOnly = false;
+
+    listeners.call([](Listener& l) { l.libraryChanged(); });
+    return juce::Result::ok();
+}
+
+juce::Result TrackLibrary::failLoad(const juce::String& message)
+{
+    // the journal isn't opened, and edits are refused, so the files are left as they were
+    readOnly = true;
+    tracks.clear();
+    rowRevisions.clear();
+    layoutRevision = ++revision;
+    rebuildIndex(0);
+
+    listeners.call([](Listener& l) { l.libraryChanged(); });
+    return juce::Result::fail(message);
+}
+
+bool TrackLibrary::isReadOnly() const
+{
+    return readOnly;
+}
+
+void TrackLibrary::applyRecords(const char* data, size_t size)
+{
+    Reader reader{ data, size };
+
+    while (reader.canRead(1))
+    {
+        const auto op = (juce::uint8) reader.data[reader.position++];
+
+        LibraryTrack track;
+        juce::String path;
+
+        if (op == opAddOrUpdate && reader.readTrack(track))
+            applyAddOrUpdate(track);
+        else if (op == opRemove && reader.readString(path))
+            applyRemove(path);
+        else
+            break; // frames hold whole records, so this is one we don't know
+    }
+}
+
+//==============================================================================
+int TrackLibrary::getNumTracks() const
+{
+    return (int) tracks.size();
+}
+
+const LibraryTrack& TrackLibrary::getTrack(int row) const
+{
+    jassert(juce::isPositiveAndBelow(row, getNumTracks()));
+    return tracks[(size_t) row];
+}
+
+int TrackLibrary::indexOf(const juce::String& path) const
+{
+    const auto found = rowsByPath.find(path);
+    return found != rowsByPath.end() ? found->second : -1;
+}
+
+int TrackLibrary::addOrUpdate(const LibraryTrack& track)
+{
+    if (readOnly)
+        return -1;
+
+    const int row = applyAddOrUpdate(track);
+
+    juce::MemoryOutputStream record;
+    record.writeByte((char) opAddOrUpdate);
+    writeTrack(record, track);
+    appendToLog(record.getMemoryBlock());
+
+    listeners.call([](Listener& l) { l.libraryChanged(); });
+    return row;
+}
+
+void TrackLibrary::addOrUpdate(const std::vector<LibraryTrack>& newTracks)
+{
+    if (newTracks.empty() || readOnly)
+        return;
+
+    juce::MemoryOutputStream records;
+
+    for (const auto& track : newTracks)
+    {
+        applyAddOrUpdate(track);
+        records.writeByte((char) opAddOrUpdate);
+        writeTrack(records, track);
+    }
+
+    appendToLog(records.getMemoryBlock());
+    listeners.call([](Listener& l) { l.libraryChanged(); });
+}
+
+void TrackLibrary::remove(int row)
+{
+    if (! juce::isPositiveAndBelow(row, getNumTracks()) || readOnly)
+        return;
+
+    const auto path = tracks[(size_t) row].path;
+    applyRemove(path);
+
+    juce::MemoryOutputStream record;
+    record.writeByte((char) opRemove);
+    writeString(record, path);
+    appendToLog(record.getMemoryBlock());
+
+    listeners.call([](Listener& l) { l.libraryChanged(); });
+}
+
+juce::uint64 TrackLibrary::getRevision() const
+{
+    return revision;
+}
+
+juce::uint64 TrackLibrary::getRowRevision(int row) const
+{
+    jassert(juce::isPositiveAndBelow(row, getNumTracks()));
+    return rowRevisions[(size_t) row];
+}
+
+juce::uint64 TrackLibrary::getLayoutRevision() const
+{
+    return layoutRevision;
+}
+
+void TrackLibrary::setBpm(const juce::String& path, double bpm)
+{
+    const int row = indexOf(path);
+
+    if (row < 0 || tracks[(size_t) row].bpm == bpm)
+        return;
+
+    auto track = tracks[(size_t) row];
+    track.bpm = bpm;
+    addOrUpdate(track);
+}
+
+//==============================================================================
+int TrackLibrary::applyAddOrUpdate(const LibraryTrack& track)
+{
+    const auto found = rowsByPath.find(track.path);
+
+    ++revision;
+
+    if (found != rowsByPath.end())
+    {
+        tracks[(size_t) found->second] = track;
+        rowRevisions[(size_t) found->second] = revision;
+        return found->second;
+    }
+
+    const int row = (int) tracks.size();
+    tracks.push_back(track);
+    rowRevisions.push_back(revision);
+    rowsByPath[track.path] = row;
+    return row;
+}
+
+bool TrackLibrary::applyRemove(const juce::String& path)
+{
+    const auto found = rowsByPath.find(path);
+
+    if (found == rowsByPath.end())
+        return false;
+
+    const int row = found->second;
+    rowsByPath.erase(found);
+    tracks.erase(tracks.begin() + row);
+    rowRevisions.erase(rowRevisions.begin() + row);
+    layoutRevision = ++revision;
+    rebuildIndex(row); // everything after it has moved up a row
+    return true;
+}
+
+void TrackLibrary::rebuildIndex(int fromRow)
+{
+    if (fromRow == 0)
+    {
+        rowsByPath.clear();
+        rowsByPath.reserve(tracks.size());
+    }
+
+    for (size_t row = (size_t) fromRow; row < tracks.size(); ++row)
+        rowsByPath[tracks[row].path] = (int) row;
+}
+
+//==============================================================================
+void TrackLibrary::appendToLog(juce::MemoryBlock records)
+{
+    journal.append(std::move(records));
+    compactIfLogIsLarge();
+}
+
+void TrackLibrary::compactIfLogIsLarge()
+{
+    const juce::int64 minLogBytesToCompact = 64 * 1024;
+
+    if (! journal.isSnapshotPending()
+        && journal.getLogBytes() > juce::jmax(minLogBytesToCompact, journal.getSnapshotBytes() / 2))
+        compact();
+}
+
+void TrackLibrary::compact()
+{
+    if (readOnly)
+        return;
+
+    // only the copy is made here, the journal's thread does the writing
+    journal.writeSnapshot(makeSnapshotWriter(tracks));
+}
+
+void TrackLibrary::flush()
+{
+    journal.flush();
+}
+
+bool TrackLibrary::existsOnDisk() const
+{
+    return file.existsAsFile() || getLogFile().existsAsFile();
+}
+
+juce::File TrackLibrary::getFile() const
+{
+    return file;
+}
+
+juce::File TrackLibrary::getLogFile() const
+{
+    return file.getSiblingFile(file.getFileName() + ".log");
+}
+
+void TrackLibrary::addListener(Listener* listener)
+{
+    listeners.add(listener);
+}
+
+void TrackLibrary::removeListener(Listener* listener)
+{
+    listeners.remove(listener);
+}
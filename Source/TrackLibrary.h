@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+    TrackLibrary.h
+    Created: 18 Oct 2026 1:14:22am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "LibraryJournal.h"
+#include <unordered_map>
+#include <vector>
+
+//==============================================================================
+/** Everything the library knows about one track */
+struct LibraryTrack
+{
+    /** the bpm of a track that's been analysed without finding a beat, so it isn't queued again */
+    static constexpr double noClearBeat = -1.0;
+
+    juce::String path;
+    juce::String title;
+    juce::String artist;
+    juce::String key;                   // musical key as tagged, e.g. "Am" or "8A", empty if unknown
+    double durationSeconds = 0.0;
+    double bpm = 0.0;                   // 0 until the track has been analysed, noClearBeat if it had none
+    juce::int64 fileSize = 0;
+    juce::int64 modificationTime = 0;   // ms since 1970, so files that have changed since can be spotted
+
+    juce::File getFile() const { return juce::File(path); }
+
+    /** e.g. "6m 42s", as the playlist has always shown it */
+    juce::String getDurationText() const;
+};
+
+//==============================================================================
+/*
+    The music library, replacing the six-slot playlist.csv.
+
+    Tracks are kept in memory in one array, in the order they were added, so
+    the table can fetch any row in constant time, and a hash map from path to
+    row finds a track without a search. Tracks are keyed by their path.
+
+    On disk the library is a binary snapshot plus an append-only log of the
+    edits made since it was written, both written by a LibraryJournal on its
+    own thread. Each edit appends a single record to the log instead of
+    rewriting the library, so it costs the same however big the library is.
+    Loading reads the snapshot in one go and replays the log over it. Once
+    the log has grown to half the size of the snapshot, a copy of the tracks
+    is handed to the journal to write as a new snapshot, which is renamed
+    over the old one.
+
+    File layout (all little-endian):
+        snapshot: "OTLB", uint32 version, uint32 number of tracks, then a track record per track
+        log:      journal frames (see LibraryJournal), each holding one or more edits of
+                  a uint8 op (1 add/update, 2 remove) followed by a track record or a length-prefixed path
+        track record: uint32 byte count of the fields that follow, then
+                  path, title, artist, key as uint32 length + UTF-8,
+                  double duration, double bpm, int64 file size, int64 modification time
+
+    A batch of edits is one frame, so it's replayed whole or not at all, and
+    a frame cut short or damaged by a crash is dropped with everything after it.
+
+    Message thread only.
+*/
+class TrackLibrary
+{
+public:
+    static constexpr juce::uint32 currentVersion = 1;
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** called after tracks have been added, changed or removed */
+        virtual void libraryChanged() = 0;
+    };
+
+    explicit TrackLibrary(const juce::File& file = juce::File::getCurrentWorkingDirectory().getChildFile("library.otl"));
+    ~TrackLibrary();
+
+    /** reads the snapshot and replays the log, replacing whatever is in memory. A library
+        that hasn't been saved yet loads as empty. If the snapshot can't be read it fails and the
+        library is left empty, as it is if the log was written in a format we don't know. Either
+        way the library is then read-only, so nothing overwrites files that might still be
+        recovered */
+    juce::Result load();
+
+    /** true after a failed load, when edits are refused */
+    bool isReadOnly() const;
+
+    int getNumTracks() const;
+
+    /** the track in a row, in constant time */
+    const LibraryTrack& getTrack(int row) const;
+
+    /** the row of the track at path, or -1 */
+    int indexOf(const juce::String& path) const;
+
+    /** adds the track, or replaces the one with the same path. Returns its row, or -1 if the
+        library is read-only */
+    int addOrUpdate(const LibraryTrack& track);
+
+    /** the same for a batch of tracks, with one write to the log for all of them */
+    void addOrUpdate(const std::vector<LibraryTrack>& newTracks);
+
+    void remove(int row);
+
+    /** goes up with every edit, so views of the library can tell which rows they've missed */
+    juce::uint64 getRevision() const;
+
+    /** the revision at which a row was last added or changed */
+    juce::uint64 getRowRevision(int row) const;
+
+    /** the revision at which rows last moved, from a removal or a reload */
+    juce::uint64 getLayoutRevision() const;
+
+    /** records a track's analysed tempo, if it's in the library */
+    void setBpm(const juce::String& path, double bpm);
+
+    /** queues a new snapshot of everything in memory, after which the log is emptied */
+    void compact();
+
+    /** waits until every edit so far is on disk */
+    void flush();
+
+    /** whether a library has ever been saved here, so an old playlist.csv still needs importing */
+    bool existsOnDisk() const;
+
+    juce::File getFile() const;
+    juce::File getLogFile() const;
+
+    void addListener(Listener* listener);
+    void removeListener(Listener* listener);
+
+private:
+    int applyAddOrUpdate(const LibraryTrack& track);
+    bool applyRemove(const juce::String& path);
+    void rebuildIndex(int fromRow);
+
+    juce::Result failLoad(const juce::String& message);
+    void applyRecords(const char* data, size_t size);
+    void appendToLog(juce::MemoryBlock records);
+    void compactIfLogIsLarge();
+
+    const juce::File file;
+    LibraryJournal journal;
+    std::vector<LibraryTrack> tracks;
+    std::unordered_map<juce::String, int> rowsByPath;
+
+    std::vector<juce::uint64> rowRevisions;
+    juce::uint64 revision = 0;
+    juce::uint64 layoutRevision = 0;
+
+    bool readOnly = false;
+
+    juce::ListenerList<Listener> listeners;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackLibrary)
+};
@@ -0,0 +1,253 @@
+/*
+  ==============================================================================
+
+    TrackLoader.cpp
+    Created: 17 Oct 2026 11:05:48am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "TrackLoader.h"
+#include "CachedTrackSource.h"
+#include "MappedTrackSource.h"
+
+TrackLoader::TrackLoader(juce::AudioFormatManager& _formatManager,
+                         ReadAheadThreadPool& _readAheadPool,
+                         TrackCache* _trackCache,
+                         int numWorkerThreads)
+                         : formatManager(_formatManager),
+                           readAheadPool(_readAheadPool),
+                           trackCache(_trackCache),
+                           workers(juce::jmax(1, numWorkerThreads))
+{}
+
+TrackLoader::~TrackLoader()
+{
+    // loads can add cache decodes, so they're finished first. Neither has a time limit, as a
+    // job that outlived us would be reading our members
+    workers.removeAllJobs(true, -1);
+    cacheWorkers.removeAllJobs(true, -1);
+
+    // while readAheadPool is still there for their sources to leave
+    const juce::ScopedLock sl(finishedLock);
+    finishedLoads.clear();
+    finishedRegions.clear();
+}
+
+void TrackLoader::loadAsync(const Request& request, Callback onLoaded)
+{
+    juce::WeakReference<TrackLoader> weakThis(this);
+
+    // the worker uses formatManager, the caches and cacheWorkers, which all outlive the jobs
+    workers.addJob([this, weakThis, request, onLoaded]
+    {
+        auto track = loadNow(request);
+        juce::uint64 id;
+
+        {
+            const juce::ScopedLock sl(finishedLock);
+            id = ++lastFinishedId;
+            finishedLoads[id] = std::move(track);
+        }
+
+        // hand the result back on the message thread, unless we've been deleted in the meantime
+        juce::MessageManager::callAsync([weakThis, id, onLoaded]
+        {
+            if (weakThis == nullptr)
+                return;
+
+            std::unique_ptr<LoadedTrack> loaded;
+
+            {
+                const juce::ScopedLock sl(weakThis->finishedLock);
+                auto found = weakThis->finishedLoads.find(id);
+                loaded = std::move(found->second);
+                weakThis->finishedLoads.erase(found);
+            }
+
+            if (onLoaded)
+                onLoaded(std::move(loaded));
+        });
+    });
+}
+
+std::unique_ptr<LoadedTrack> TrackLoader::loadNow(const Request& request)
+{
+    const double startTime = juce::Time::getMillisecondCounterHiRes();
+    auto track = std::make_unique<LoadedTrack>();
+    track->url = request.url;
+
+    const bool canCache = trackCache != nullptr && request.useCache && request.url.isLocalFile();
+
+    if (canCache)
+    {
+        if (auto entry = trackCache->find(request.url.getLocalFile())) // already decoded, nothing to open or buffer
+        {
+            track->formatName = "Cached PCM";
+            track->sampleRate = entry->sampleRate;
+            track->lengthInSamples = entry->lengthInSamples;
+            track->numChannels = (unsigned int) entry->numChannels;
+            track->source = std::make_unique<CachedTrackSource>(std::move(entry));
+
+            track->timings.openMs = juce::Time::getMillisecondCounterHiRes() - startTime;
+            track->timings.totalMs = track->timings.openMs;
+            return track;
+        }
+    }
+
+    // open - uncompressed local files are memory-mapped rather than streamed
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader;
+    std::unique_ptr<juce::AudioFormatReader> streamReader;
+
+    if (request.useMemoryMapping && request.url.isLocalFile())
+        mappedReader = openMemoryMapped(request.url.getLocalFile());
+
+    if (mappedReader == nullptr)
+        streamReader.reset(formatManager.createReaderFor(request.url.createInputStream(false)));
+
+    juce::AudioFormatReader* reader = mappedReader != nullptr ? mappedReader.get() : streamReader.get();
+
+    const double openedTime = juce::Time::getMillisecondCounterHiRes();
+    track->timings.openMs = openedTime - startTime;
+
+    if (reader == nullptr)
+    {
+        DBG("TrackLoader: no reader for " << request.url.toString(false));
+        return nullptr;
+    }
+
+    // probe
+    if (reader->sampleRate <= 0.0 || reader->lengthInSamples <= 0 || reader->numChannels == 0)
+    {
+        DBG("TrackLoader: " << request.url.toString(false) << " has no playable audio");
+        return nullptr;
+    }
+
+    track->formatName = reader->getFormatName();
+    track->sampleRate = reader->sampleRate;
+    track->lengthInSamples = reader->lengthInSamples;
+    track->numChannels = reader->numChannels;
+
+    const double probedTime = juce::Time::getMillisecondCounterHiRes();
+    track->timings.probeMs = probedTime - openedTime;
+
+    // pre-buffer, so the deck has audio to play the moment it's handed over
+    auto& stats = request.stats != nullptr ? *request.stats : fallbackStats;
+    const int prebufferSamples = juce::jmin((int) (track->sampleRate / 2), request.readAheadBufferSize / 2);
+    bool prebuffered;
+
+    if (mappedReader != nullptr)
+    {
+        auto source = std::make_unique<MappedTrackSource>(std::move(mappedReader), readAheadPool.getNextThread(),
+                                                          request.readAheadBufferSize, stats);
+        prebuffered = source->waitForBufferedSamples(prebufferSamples, 2000);
+        track->source = std::move(source);
+    }
+    else
+    {
+        auto source = std::make_unique<ReadAheadSource>(std::move(streamReader), readAheadPool.getNextThread(),
+                                                        request.readAheadBufferSize, stats);
+        prebuffered = source->waitForBufferedSamples(prebufferSamples, 2000);
+        track->source = std::move(source);
+    }
+
+    if (! prebuffered)
+        DBG("TrackLoader: timed out pre-buffering " << request.url.toString(false));
+
+    const double endTime = juce::Time::getMillisecondCounterHiRes();
+    track->timings.prebufferMs = endTime - probedTime;
+    track->timings.totalMs = endTime - startTime;
+
+    // decode the whole thing in the background so it comes from memory next time,
+    // unless it's mapped, in which case it already does
+    const bool isMapped = dynamic_cast<MappedTrackSource*>(track->source.get()) != nullptr;
+
+    if (canCache && ! isMapped && ! trackCache->containsOrIsDecoding(request.url.getLocalFile()))
+    {
+        const auto file = request.url.getLocalFile();
+        cacheWorkers.addJob([this, file] { trackCache->decodeAndAdd(file); });
+    }
+
+    return track;
+}
+
+void TrackLoader::readRegionAsync(const juce::URL& url, juce::int64 startSample, int numSamples, RegionCallback onRead)
+{
+    juce::WeakReference<TrackLoader> weakThis(this);
+
+    workers.addJob([this, weakThis, url, startSample, numSamples, onRead]
+    {
+        auto samples = readRegionNow(url, startSample, numSamples);
+        juce::uint64 id;
+
+        {
+            const juce::ScopedLock sl(finishedLock);
+            id = ++lastFinishedId;
+            finishedRegions[id] = std::move(samples);
+        }
+
+        juce::MessageManager::callAsync([weakThis, id, onRead]
+        {
+            if (weakThis == nullptr)
+                return;
+
+            std::unique_ptr<juce::AudioBuffer<float>> read;
+
+            {
+                const juce::ScopedLock sl(weakThis->finishedLock);
+                auto found = weakThis->finishedRegions.find(id);
+                read = std::move(found->second);
+                weakThis->finishedRegions.erase(found);
+            }
+
+            if (onRead)
+                onRead(std::move(read));
+        });
+    });
+}
+
+std::unique_ptr<juce::AudioBuffer<float>> TrackLoader::readRegionNow(const juce::URL& url, juce::int64 startSample, int numSamples)
+{
+    if (numSamples <= 0)
+        return nullptr;
+
+    if (trackCache != nullptr && url.isLocalFile())
+    {
+        if (auto entry = trackCache->find(url.getLocalFile()))
+        {
+            auto samples = std::make_unique<juce::AudioBuffer<float>>(entry->numChannels, numSamples);
+            entry->read(*samples, 0, startSample, numSamples);
+            return samples;
+        }
+    }
+
+    // a reader of our own, as the deck's is busy on its read-ahead thread
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(url.createInputStream(false)));
+
+    if (reader == nullptr || reader->numChannels == 0)
+        return nullptr;
+
+    auto samples = std::make_unique<juce::AudioBuffer<float>>((int) reader->numChannels, numSamples);
+
+    if (! reader->read(samples.get(), 0, numSamples, startSample, true, true))
+        return nullptr;
+
+    return samples;
+}
+
+std::unique_ptr<juce::MemoryMappedAudioFormatReader> TrackLoader::openMemoryMapped(const juce::File& file)
+{
+    auto* format = formatManager.findFormatForFileExtension(file.getFileExtension());
+
+    if (format == nullptr)
+        return nullptr;
+
+    // only formats that store plain PCM (WAV and AIFF) give us a mapped reader
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader(format->createMemoryMappedReader(file));
+
+    if (reader == nullptr || ! reader->mapEntireFile())
+        return nullptr;
+
+    return reader;
+}
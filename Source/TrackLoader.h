@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    TrackLoader.h
+    Created: 17 Oct 2026 11:05:48am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <map>
+#include "ReadAheadSource.h"
+#include "ReadAheadThreadPool.h"
+#include "TrackCache.h"
+
+//==============================================================================
+/** How long each stage of a load took, in milliseconds */
+struct TrackLoadTimings
+{
+    double openMs = 0.0;       // opening the stream and finding a reader for it
+    double probeMs = 0.0;      // checking format, length and sample rate
+    double prebufferMs = 0.0;  // decoding the first part of the track
+    double totalMs = 0.0;
+};
+
+//==============================================================================
+/** A track that has been opened, probed and pre-buffered and is ready to be
+    handed to a deck's audio thread.
+*/
+struct LoadedTrack
+{
+    juce::URL url;
+    juce::String formatName;
+    double sampleRate = 0.0;
+    juce::int64 lengthInSamples = 0;
+    unsigned int numChannels = 0;
+
+    // numbered by the deck it's handed to, so what was queued for it can be told from what was
+    // queued for the track before. Numbers only go up, so a deleted track's can't come back
+    juce::uint64 deckSerial = 0;
+
+    std::unique_ptr<juce::PositionableAudioSource> source;
+
+    TrackLoadTimings timings;
+};
+
+//==============================================================================
+/*
+    Loads tracks on a pool of worker threads so the message thread never waits
+    on the disk.
+
+    Each load goes through three stages - open, probe and pre-buffer - and the
+    finished LoadedTrack is passed back on the message thread, from where the
+    deck publishes it to its audio thread.
+
+    Uncompressed local files (WAV and AIFF) are memory-mapped instead of being
+    streamed through a read-ahead buffer.
+
+    With a TrackCache, tracks that have been decoded before are played straight
+    from memory, and anything that had to be streamed is decoded into the cache
+    in the background so the next load of it is instant.
+*/
+class TrackLoader
+{
+public:
+    TrackLoader(juce::AudioFormatManager& formatManager,
+                ReadAheadThreadPool& readAheadPool,
+                TrackCache* trackCache = nullptr,
+                int numWorkerThreads = 2);
+    ~TrackLoader();
+
+    struct Request
+    {
+        juce::URL url;
+        int readAheadBufferSize = 1 << 17;
+        ReadAheadStats* stats = nullptr;
+        bool useCache = true;
+        bool useMemoryMapping = true;
+    };
+
+    /** called on the message thread with the loaded track, or nullptr if it couldn't be loaded */
+    using Callback = std::function<void(std::unique_ptr<LoadedTrack>)>;
+
+    /** loads the track on a worker thread and calls onLoaded on the message thread once it's ready */
+    void loadAsync(const Request& request, Callback onLoaded);
+
+    /** loads the track on the calling thread, for use where there's no message loop */
+    std::unique_ptr<LoadedTrack> loadNow(const Request& request);
+
+    /** called on the message thread with the decoded samples, or nullptr if they couldn't be read */
+    using RegionCallback = std::function<void(std::unique_ptr<juce::AudioBuffer<float>>)>;
+
+    /** decodes part of a track on a worker thread, separately from anything playing it */
+    void readRegionAsync(const juce::URL& url, juce::int64 startSample, int numSamples, RegionCallback onRead);
+
+    /** decodes part of a track on the calling thread. Comes from the TrackCache if the track is in it */
+    std::unique_ptr<juce::AudioBuffer<float>> readRegionNow(const juce::URL& url, juce::int64 startSample, int numSamples);
+
+private:
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> openMemoryMapped(const juce::File& file);
+
+    juce::AudioFormatManager& formatManager;
+    ReadAheadThreadPool& readAheadPool;
+    TrackCache* trackCache;
+
+    ReadAheadStats fallbackStats; // used when a request doesn't bring its own
+
+    // results waiting for their message, which only carries the number. A loaded track's
+    // read-ahead source is on one of readAheadPool's threads, so it has to be gone before
+    // the pool is - a message still queued when we're deleted finds nothing here
+    juce::CriticalSection finishedLock;
+    juce::uint64 lastFinishedId = 0;
+    std::map<juce::uint64, std::unique_ptr<LoadedTrack>> finishedLoads;
+    std::map<juce::uint64, std::unique_ptr<juce::AudioBuffer<float>>> finishedRegions;
+
+    // the pools go last so they're destroyed first, and loads queue work on cacheWorkers,
+    // so workers has to go before it
+    juce::ThreadPool cacheWorkers{ 1 }; // full decodes for the cache, kept apart so loads never queue behind them
+    juce::ThreadPool workers;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (TrackLoader)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackLoader)
+};
@@ -0,0 +1,353 @@
+/*
+  ==============================================================================
+
+    TrackSearchIndex.cpp
+    Created: 18 Oct 2026 4:26:09am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "TrackSearchIndex.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+    // trigrams are over letters and digits, with everything else - spaces, punctuation, accented
+    // letters - sharing one symbol. That keeps the table small enough to index directly
+    constexpr int numSymbols = 37;
+    constexpr int numBuckets = numSymbols * numSymbols * numSymbols;
+
+    int getSymbol(char c)
+    {
+        if (c >= 'a' && c <= 'z')
+            return 1 + (c - 'a');
+
+        if (c >= '0' && c <= '9')
+            return 27 + (c - '0');
+
+        return 0;
+    }
+
+    int getBucket(const char* trigram)
+    {
+        return (getSymbol(trigram[0]) * numSymbols + getSymbol(trigram[1])) * numSymbols + getSymbol(trigram[2]);
+    }
+
+    /** -1, 0 or 1, as std::string::compare's sign */
+    template <typename Type>
+    int compareValues(Type first, Type second)
+    {
+        return (first > second) - (first < second);
+    }
+}
+
+//==============================================================================
+TrackSearchIndex::TrackSearchIndex()
+    : postings((size_t) numBuckets),
+      bucketStamps((size_t) numBuckets, 0)
+{}
+
+void TrackSearchIndex::update(const TrackLibrary& library)
+{
+    const int numTracks = library.getNumTracks();
+    bool changed = false;
+
+    // rows have moved, so nothing in the index points at the right track any more
+    if (library.getLayoutRevision() > indexedRevision || numTracks < (int) rows.size())
+    {
+        for (auto& rowsWithTrigram : postings)
+            rowsWithTrigram.clear();
+
+        rows.clear();
+        changed = true;
+    }
+
+    const int numIndexed = (int) rows.size();
+    rows.resize((size_t) numTracks);
+
+    for (int row = 0; row < numTracks; ++row)
+    {
+        if (row >= numIndexed || library.getRowRevision(row) > indexedRevision)
+        {
+            indexRow(library.getTrack(row), row);
+            changed = true;
+        }
+    }
+
+    indexedRevision = library.getRevision();
+
+    if (! changed)
+        return;
+
+    // sized here so that searching never has to allocate
+    sortedRows.resize(rows.size());
+    matchStamps.resize(rows.size(), 0);
+    visibleRows.reserve(rows.size());
+
+    sort();
+    search(false);
+}
+
+void TrackSearchIndex::indexRow(const LibraryTrack& track, int row)
+{
+    auto& indexed = rows[(size_t) row];
+
+    // kept to take the row out of the trigrams it no longer has
+    const auto oldText = std::move(indexed.text);
+
+    const auto title = track.artist.isNotEmpty() ? track.artist + " - " + track.title : track.title;
+    indexed.sortTitle = title.toLowerCase().toStdString();
+    indexed.durationSeconds = track.durationSeconds;
+    indexed.bpm = track.bpm;
+
+    indexed.display.title = title;
+    indexed.display.duration = track.getDurationText();
+    indexed.display.bpm = track.bpm > 0 ? juce::String(track.bpm, 1) : juce::String();
+
+    indexed.titleKey = 0;
+
+    for (size_t i = 0; i < sizeof(indexed.titleKey); ++i)
+        indexed.titleKey = (indexed.titleKey << 8) | (i < indexed.sortTitle.size() ? (juce::uint8) indexed.sortTitle[i] : 0);
+
+    indexed.text = indexed.sortTitle;
+    indexed.text += '\n';
+    indexed.text += track.path.toLowerCase().toStdString();
+
+    if (track.bpm > 0)
+    {
+        indexed.text += '\n';
+        indexed.text += indexed.display.bpm.toStdString();
+    }
+
+    // each trigram once per row, however many times it appears. The old text's trigrams are stamped
+    // first, so the ones in both are left alone and only those gained or lost change their lists
+    if (bucketStamp > std::numeric_limits<juce::uint32>::max() - 2)
+    {
+        std::fill(bucketStamps.begin(), bucketStamps.end(), 0);
+        bucketStamp = 0;
+    }
+
+    const auto oldStamp = ++bucketStamp;
+    const auto newStamp = ++bucketStamp;
+
+    for (size_t i = 0; i + 3 <= oldText.size(); ++i)
+        bucketStamps[(size_t) getBucket(oldText.data() + i)] = oldStamp;
+
+    for (size_t i = 0; i + 3 <= indexed.text.size(); ++i)
+    {
+        const auto bucket = (size_t) getBucket(indexed.text.data() + i);
+
+        if (bucketStamps[bucket] == oldStamp)
+        {
+            bucketStamps[bucket] = newStamp; // already listed
+        }
+        else if (bucketStamps[bucket] != newStamp)
+        {
+            bucketStamps[bucket] = newStamp;
+            postings[bucket].push_back(row);
+        }
+    }
+
+    for (size_t i = 0; i + 3 <= oldText.size(); ++i)
+    {
+        const auto bucket = (size_t) getBucket(oldText.data() + i);
+
+        if (bucketStamps[bucket] == oldStamp)
+        {
+            bucketStamps[bucket] = newStamp;
+
+            // the order of a list doesn't matter, so the last entry fills the gap
+            auto& rowsWithTrigram = postings[bucket];
+            const auto found = std::find(rowsWithTrigram.begin(), rowsWithTrigram.end(), row);
+
+            if (found != rowsWithTrigram.end())
+            {
+                *found = rowsWithTrigram.back();
+                rowsWithTrigram.pop_back();
+            }
+        }
+    }
+}
+
+//==============================================================================
+void TrackSearchIndex::setQuery(const juce::String& newQuery)
+{
+    const auto lowerCaseQuery = newQuery.toLowerCase().toStdString();
+
+    // whatever matches the longer query matched this one, so only those need checking again
+    const bool narrowing = ! query.empty() && lowerCaseQuery.compare(0, query.size(), query) == 0;
+    query = lowerCaseQuery;
+
+    queryWords.clear();
+    size_t start = 0;
+
+    while (start < query.size())
+    {
+        const auto end = std::min(query.find(' ', start), query.size());
+
+        if (end > start)
+            queryWords.emplace_back(query, start, end - start);
+
+        start = end + 1;
+    }
+
+    search(narrowing);
+}
+
+void TrackSearchIndex::setSortOrder(SortColumn column, bool forwards)
+{
+    for (int i = sortKeys.size(); --i >= 0;)
+        if (sortKeys.getReference(i).column == column)
+            sortKeys.remove(i);
+
+    sortKeys.insert(0, { column, forwards });
+
+    if (sortKeys.size() > maxSortKeys)
+        sortKeys.removeLast();
+
+    sort();
+    search(false);
+}
+
+void TrackSearchIndex::sort()
+{
+    std::iota(sortedRows.begin(), sortedRows.end(), 0);
+
+    // with no columns chosen the rows stay in the order they were added
+    if (sortKeys.isEmpty())
+        return;
+
+    std::sort(sortedRows.begin(), sortedRows.end(), [this](int first, int second)
+    {
+        const int result = compare(first, second);
+        return result != 0 ? result < 0 : first < second;
+    });
+}
+
+int TrackSearchIndex::compare(int first, int second) const
+{
+    const auto& a = rows[(size_t) first];
+    const auto& b = rows[(size_t) second];
+
+    for (const auto& key : sortKeys)
+    {
+        int result = 0;
+
+        switch (key.column)
+        {
+            case SortColumn::title:
+                result = a.titleKey != b.titleKey ? compareValues(a.titleKey, b.titleKey)
+                                                  : compareValues(a.sortTitle.compare(b.sortTitle), 0);
+                break;
+
+            case SortColumn::duration:
+                result = compareValues(a.durationSeconds, b.durationSeconds);
+                break;
+
+            case SortColumn::bpm:
+                result = compareValues(a.bpm, b.bpm);
+                break;
+        }
+
+        if (result != 0)
+            return key.forwards ? result : -result;
+    }
+
+    return 0;
+}
+
+//==============================================================================
+void TrackSearchIndex::search(bool narrowing)
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    if (queryWords.empty())
+    {
+        visibleRows.assign(sortedRows.begin(), sortedRows.end());
+    }
+    else if (narrowing)
+    {
+        // filtered in place, which keeps the sorted order
+        visibleRows.erase(std::remove_if(visibleRows.begin(), visibleRows.end(), [this](int row) { return ! matches(row); }),
+                          visibleRows.end());
+    }
+    else
+    {
+        // the fewer rows a trigram is listed under, the fewer there are to check
+        const std::vector<int>* candidates = nullptr;
+
+        for (const auto& word : queryWords)
+        {
+            for (size_t i = 0; i + 3 <= word.size(); ++i)
+            {
+                const auto& rowsWithTrigram = postings[(size_t) getBucket(word.data() + i)];
+
+                if (candidates == nullptr || rowsWithTrigram.size() < candidates->size())
+                    candidates = &rowsWithTrigram;
+            }
+        }
+
+        visibleRows.clear();
+
+        if (candidates == nullptr) // only words of one or two letters, so every row is a candidate
+        {
+            for (const int row : sortedRows)
+                if (matches(row))
+                    visibleRows.push_back(row);
+        }
+        else
+        {
+            if (++matchStamp == 0)
+            {
+                std::fill(matchStamps.begin(), matchStamps.end(), 0);
+                matchStamp = 1;
+            }
+
+            for (const int row : *candidates)
+                if (matchStamps[(size_t) row] != matchStamp && matches(row))
+                    matchStamps[(size_t) row] = matchStamp;
+
+            // picked out of the sorted order, so the results don't need sorting
+            for (const int row : sortedRows)
+                if (matchStamps[(size_t) row] == matchStamp)
+                    visibleRows.push_back(row);
+        }
+    }
+
+    lastSearchMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+}
+
+bool TrackSearchIndex::matches(int row) const
+{
+    const auto& text = rows[(size_t) row].text;
+
+    for (const auto& word : queryWords)
+        if (text.find(word) == std::string::npos)
+            return false;
+
+    return true;
+}
+
+int TrackSearchIndex::getNumVisibleRows() const
+{
+    return (int) visibleRows.size();
+}
+
+int TrackSearchIndex::getLibraryRow(int visibleRow) const
+{
+    return juce::isPositiveAndBelow(visibleRow, (int) visibleRows.size()) ? visibleRows[(size_t) visibleRow] : -1;
+}
+
+const TrackSearchIndex::DisplayText* TrackSearchIndex::getDisplayText(int visibleRow) const
+{
+    const int row = getLibraryRow(visibleRow);
+    return row >= 0 ? &rows[(size_t) row].display : nullptr;
+}
+
+double TrackSearchIndex::getLastSearchMs() const
+{
+    return lastSearchMs;
+}
@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    TrackSearchIndex.h
+    Created: 18 Oct 2026 4:26:09am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TrackLibrary.h"
+#include <string>
+#include <vector>
+
+//==============================================================================
+/*
+    The filtered and sorted view of the library that the playlist table
+    shows, kept fast enough to refilter 50k tracks on every keystroke.
+
+    Each track's title, artist, path and tempo are lower-cased into one
+    string once, when the track is added or changed, along with the keys it
+    sorts by. A trigram index maps every three characters to the tracks
+    containing them, so a search only checks the tracks listed under the
+    rarest trigram in the query. Typing more onto a query only checks the
+    tracks that matched before.
+
+    The sorted order of the whole library is kept, and searches walk it to
+    pick out their matches, so results come out sorted without sorting them.
+    Row storage is sized when the library changes, never while searching.
+    The text the table paints is formatted here too, once per change.
+
+    Message thread only.
+*/
+class TrackSearchIndex
+{
+public:
+    enum class SortColumn
+    {
+        title,
+        duration,
+        bpm
+    };
+
+    /** a track's cells, formatted when it was indexed rather than on every paint */
+    struct DisplayText
+    {
+        juce::String title;     // "artist - title"
+        juce::String duration;
+        juce::String bpm;       // empty until the track has been analysed
+    };
+
+    TrackSearchIndex();
+
+    /** brings the index up to date with the library, only re-reading the rows that have changed */
+    void update(const TrackLibrary& library);
+
+    /** shows only tracks containing every word of the query, anywhere in their title, artist, path or tempo */
+    void setQuery(const juce::String& query);
+
+    /** sorts by a column, with whatever it was sorted by before as the tie-breaker */
+    void setSortOrder(SortColumn column, bool forwards);
+
+    /** the number of tracks that match the query */
+    int getNumVisibleRows() const;
+
+    /** the library row shown in a row of the view, or -1 */
+    int getLibraryRow(int visibleRow) const;
+
+    /** the formatted cells of a row of the view, or nullptr */
+    const DisplayText* getDisplayText(int visibleRow) const;
+
+    /** how long the last search took, for keeping an eye on it */
+    double getLastSearchMs() const;
+
+private:
+    struct Row
+    {
+        std::string text;           // lower case UTF-8 "artist - title\npath\nbpm"
+        std::string sortTitle;      // lower case "artist - title"
+        juce::uint64 titleKey = 0;  // the first eight bytes of sortTitle, so most comparisons are one integer
+        double durationSeconds = 0.0;
+        double bpm = 0.0;
+        DisplayText display;
+    };
+
+    struct SortKey
+    {
+        SortColumn column;
+        bool forwards;
+    };
+
+    static constexpr int maxSortKeys = 3;
+
+    void indexRow(const LibraryTrack& track, int row);
+    void sort();
+    void search(bool narrowing);
+    bool matches(int row) const;
+    int compare(int first, int second) const;
+
+    std::vector<Row> rows;
+    juce::uint64 indexedRevision = 0;
+
+    // one list of rows per trigram, in no particular order. A row that's re-indexed is moved
+    // between lists as its trigrams change, so no list grows with edits to the same track
+    std::vector<std::vector<int>> postings;
+    std::vector<juce::uint32> bucketStamps;
+    juce::uint32 bucketStamp = 0;
+
+    std::vector<int> sortedRows;
+    std::vector<int> visibleRows;
+    std::vector<juce::uint32> matchStamps;
+    juce::uint32 matchStamp = 0;
+
+    juce::Array<SortKey> sortKeys;
+
+    std::string query;
+    std::vector<std::string> queryWords;
+    double lastSearchMs = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackSearchIndex)
+};
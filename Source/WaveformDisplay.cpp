@@ -13,7 +13,9 @@
 
 //==============================================================================
 WaveformDisplay::WaveformDisplay(juce::AudioFormatManager& formatManagerToUse,
-                                 juce::AudioThumbnailCache& cacheToUse) : 
+                                 juce::AudioThumbnailCache& cacheToUse,
+                                 PeakStore& _peakStore) : 
+                                 peakStore(_peakStore),
                                  audioThumb(1000, formatManagerToUse, cacheToUse),
                                  fileLoaded(false),
                                  position(0)
@@ -26,10 +28,49 @@ WaveformDisplay::WaveformDisplay(juce::AudioFormatManager& formatManagerToUse,
 
 WaveformDisplay::~WaveformDisplay()
 {
+    setPreview(nullptr);
 }
 
 void WaveformDisplay::paint (juce::Graphics& g)
 {
+    if (getWidth() <= 0 || getHeight() <= 0)
+        return;
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (! imageIsValid || scale != imageScale)
+        renderWaveformImage(scale);
+
+    g.drawImage(waveformImage, getLocalBounds().toFloat());
+
+    if (fileLoaded && position >= 0)
+    {
+        g.setColour(juce::Colours::lightgreen);
+        g.drawRect(getPlayheadBounds());
+    }
+
+    const auto paintMs = juce::Time::getMillisecondCounterHiRes() - startTime;
+    paintStats.numPaints++;
+    paintStats.lastPaintMs = paintMs;
+    paintStats.totalPaintMs += paintMs;
+    paintStats.maxPaintMs = juce::jmax(paintStats.maxPaintMs, paintMs);
+}
+
+void WaveformDisplay::renderWaveformImage(float scale)
+{
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    // rendered at the display's physical resolution so it's blitted without scaling
+    const int imageWidth = juce::jmax(1, juce::roundToInt(getWidth() * scale));
+    const int imageHeight = juce::jmax(1, juce::roundToInt(getHeight() * scale));
+
+    if (waveformImage.getWidth() != imageWidth || waveformImage.getHeight() != imageHeight)
+        waveformImage = juce::Image(juce::Image::RGB, imageWidth, imageHeight, false);
+
+    juce::Graphics g(waveformImage);
+    g.addTransform(juce::AffineTransform::scale((float) imageWidth / getWidth(), (float) imageHeight / getHeight()));
+
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));   // clear the background
 
     g.setColour (juce::Colours::grey);
@@ -37,7 +78,15 @@ void WaveformDisplay::paint (juce::Graphics& g)
 
     g.setColour (juce::Colours::orange);
 
-    if (fileLoaded)
+    if (peaks != nullptr)
+    {
+        drawPeaks(g, getLocalBounds(), *peaks);
+    }
+    else if (preview != nullptr)
+    {
+        preview->drawChannel(g, getLocalBounds(), 0, preview->getTotalLength(), 0, 1.0f);
+    }
+    else if (fileLoaded)
     {
         audioThumb.drawChannel( g,
                                 getLocalBounds(),
@@ -45,12 +94,6 @@ void WaveformDisplay::paint (juce::Graphics& g)
                                 audioThumb.getTotalLength(),
                                 0,
                                 1.0f);
-        g.setColour(juce::Colours::lightgreen);
-        if (position >= 0)
-        {
-            g.drawRect(position * getWidth(), 0, getWidth() / 80, getHeight());
-        }
-
     }
     else
     {
@@ -58,20 +101,131 @@ void WaveformDisplay::paint (juce::Graphics& g)
         g.drawText("No file currently loaded...", getLocalBounds(),
         juce::Justification::centred, true);   // draw some placeholder text
     }
+
+    imageScale = scale;
+    imageIsValid = true;
+
+    paintStats.numImageRenders++;
+    paintStats.lastRenderMs = juce::Time::getMillisecondCounterHiRes() - startTime;
+}
+
+void WaveformDisplay::invalidateImage()
+{
+    imageIsValid = false;
+    repaint();
+}
+
+juce::Rectangle<float> WaveformDisplay::getPlayheadBounds() const
+{
+    return { (float) (position * getWidth()), 0.0f, (float) (getWidth() / 80), (float) getHeight() };
+}
+
+void WaveformDisplay::setPreview(std::shared_ptr<juce::AudioThumbnail> newPreview)
+{
+    if (preview != nullptr)
+        preview->removeChangeListener(this);
+
+    preview = std::move(newPreview);
+
+    if (preview != nullptr)
+        preview->addChangeListener(this);
 }
 
 void WaveformDisplay::resized()
 {
-    // This method is where you should set the bounds of any child
-    // components that your component contains..
+    invalidateImage();
+}
+
+const WaveformDisplay::PaintStats& WaveformDisplay::getPaintStats() const
+{
+    return paintStats;
 }
 
+void WaveformDisplay::resetPaintStats()
+{
+    paintStats = {};
+}
+
+void WaveformDisplay::drawPeaks(juce::Graphics& g, juce::Rectangle<int> area, const PeakFile& peaks, int channel)
+{
+    const auto length = peaks.getLengthInSamples();
+    const int width = area.getWidth();
+
+    if (length <= 0 || width <= 0 || peaks.getNumLevels() == 0)
+        return;
+
+    const double samplesPerPixel = (double) length / width;
+    const auto& level = peaks.getLevelFor(samplesPerPixel);
+    const int numChannels = peaks.getNumChannels();
+    channel = juce::jlimit(0, numChannels - 1, channel);
+    const float midY = (float) area.getCentreY();
+    const float halfHeight = area.getHeight() * 0.5f;
+
+    for (int x = 0; x < width; ++x)
+    {
+        const int first = (int) ((x * samplesPerPixel) / level.samplesPerPeak);
+        const int last = juce::jmin(level.numPeaks, juce::jmax(first + 1, (int) (((x + 1) * samplesPerPixel) / level.samplesPerPeak)));
+
+        int min = 127, max = -127;
+
+        for (int i = first; i < last; ++i)
+        {
+            const auto& peak = level.get(i, channel, numChannels);
+            min = juce::jmin(min, (int) peak.min);
+            max = juce::jmax(max, (int) peak.max);
+        }
+
+        if (min <= max)
+            g.drawVerticalLine(area.getX() + x, midY - max / 127.0f * halfHeight, midY - min / 127.0f * halfHeight + 1.0f);
+    }
+}
 
 void WaveformDisplay::loadURL(juce::URL audioURL)
 {
     DBG("Waveformdisplay loadURL");
     audioThumb.clear();
+    setPreview(nullptr);
+    peaks = nullptr;
+    currentFile = juce::File();
+
+    if (audioURL.isLocalFile())
+    {
+        currentFile = audioURL.getLocalFile();
+        juce::Component::SafePointer<WaveformDisplay> safeThis(this);
+
+        peaks = peakStore.getOrBuild(currentFile, [safeThis, file = currentFile](std::shared_ptr<const PeakFile> builtPeaks)
+        {
+            // ignore it if we've been deleted or moved on to another track since
+            if (safeThis == nullptr || safeThis->currentFile != file || builtPeaks == nullptr)
+                return;
+
+            safeThis->peaks = builtPeaks;
+            safeThis->setPreview(nullptr);
+            safeThis->invalidateImage();
+        });
+
+        if (peaks != nullptr)
+        {
+            DBG("WFD loaded peaks from disk");
+            fileLoaded = true;
+            invalidateImage();
+            return;
+        }
+
+        // the peaks are being built, so draw them from that decode in the meantime
+        setPreview(peakStore.getPreview(currentFile));
+
+        if (preview != nullptr)
+        {
+            fileLoaded = true;
+            invalidateImage();
+            return;
+        }
+    }
+
+    // no peak file for a stream, so its thumbnail is decoded here
     fileLoaded = audioThumb.setSource(new juce::URLInputSource(audioURL));
+    invalidateImage();
 
     if (fileLoaded)
     {
@@ -86,14 +240,17 @@ void WaveformDisplay::loadURL(juce::URL audioURL)
 void WaveformDisplay::changeListenerCallback(juce::ChangeBroadcaster* source)
 {
     DBG("Change received");
-    repaint();
+    invalidateImage(); // the thumbnail or preview has scanned more of the file
 }
 
 void  WaveformDisplay::setPositionRelative(double pos)
 {
     if (pos != position)
     {
+        // the waveform comes from the cached image, so only the strips under the
+        // old and new playhead need to be redrawn
+        repaint(getPlayheadBounds().getSmallestIntegerContainer().expanded(1));
         position = pos;
-        repaint();
+        repaint(getPlayheadBounds().getSmallestIntegerContainer().expanded(1));
     }
 }
\ No newline at end of file
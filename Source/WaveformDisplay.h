@@ -10,16 +10,23 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include "PeakStore.h"
 
 //==============================================================================
 /*
+    Draws a track's whole waveform with a playhead over it.
+
+    The waveform itself is rasterised into an image only when the size, the
+    track or its peaks change. Playhead updates just composite the playhead
+    on top of that image and only repaint the strips it moved between.
 */
 class WaveformDisplay  : public juce::Component,
                          public juce::ChangeListener
 {
 public:
     WaveformDisplay(juce::AudioFormatManager& formatManagerToUse,
-                    juce::AudioThumbnailCache& cacheToUse);
+                    juce::AudioThumbnailCache& cacheToUse,
+                    PeakStore& peakStore);
     ~WaveformDisplay() override;
 
     void paint (juce::Graphics&) override;
@@ -33,11 +40,56 @@ public:
     //** set the relative postion of the playhead
     void setPositionRelative(double pos);
 
+    /** how long paints and waveform renders are taking, in milliseconds */
+    struct PaintStats
+    {
+        int numPaints = 0;
+        int numImageRenders = 0;
+        double lastPaintMs = 0.0;
+        double maxPaintMs = 0.0;
+        double totalPaintMs = 0.0;
+        double lastRenderMs = 0.0;
+
+        double getAveragePaintMs() const { return numPaints > 0 ? totalPaintMs / numPaints : 0.0; }
+    };
+
+    const PaintStats& getPaintStats() const;
+    void resetPaintStats();
+
+    /** draws one channel of a peak file across area, one min/max line per pixel,
+        using the coarsest level that still has a peak for every pixel */
+    static void drawPeaks(juce::Graphics& g, juce::Rectangle<int> area, const PeakFile& peaks, int channel = 0);
+
 private:
+    /** redraws the background and waveform into waveformImage */
+    void renderWaveformImage(float scale);
+
+    /** throws away the cached image so the next paint redraws the waveform */
+    void invalidateImage();
+
+    juce::Rectangle<float> getPlayheadBounds() const;
+
+    /** swaps the thumbnail the peak store is filling in for the track, listening for it to grow */
+    void setPreview(std::shared_ptr<juce::AudioThumbnail> newPreview);
+
+    PeakStore& peakStore;
+    std::shared_ptr<const PeakFile> peaks;
+    juce::File currentFile;
+
+    // filled in by the peak store while a local track's peaks are built, from the same decode
+    std::shared_ptr<juce::AudioThumbnail> preview;
+
+    // only used for non-local URLs, which have no peak file
     juce::AudioThumbnail audioThumb;
     bool fileLoaded;
 
     double position;
 
+    juce::Image waveformImage;
+    float imageScale = 0.0f;
+    bool imageIsValid = false;
+
+    PaintStats paintStats;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformDisplay)
 };
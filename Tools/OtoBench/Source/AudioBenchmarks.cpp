@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    AudioBenchmarks.cpp
+    Created: 18 Oct 2026 12:31:08am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../../Source/DJAudioPlayer.h"
+#include "../../../Source/ReadAheadThreadPool.h"
+#include "../../../Source/ThreeBandEQ.h"
+#include "../../../Source/TrackCache.h"
+#include "../../../Source/TrackLoader.h"
+
+namespace
+{
+    constexpr double outputSampleRate = 48000.0;
+
+    /** a buffer of the fixture signal to feed the EQ and resampler */
+    juce::AudioBuffer<float> makeInput(int numSamples)
+    {
+        juce::AudioBuffer<float> buffer(2, numSamples);
+        juce::Random random(1);
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        return buffer;
+    }
+
+    //==============================================================================
+    /** a deck playing a decoded track from memory, so the disk never shows up in its timings */
+    struct PlayerRig
+    {
+        explicit PlayerRig(BenchFixtures& fixtures)
+            : trackCache(fixtures.getFormatManager()),
+              trackLoader(fixtures.getFormatManager(), readAheadPool, &trackCache, 1),
+              player(trackLoader)
+        {
+            const auto file = fixtures.getTrack("wav", 60);
+            loaded = trackCache.decodeAndAdd(file) != nullptr && player.loadURLNow(juce::URL(file));
+        }
+
+        ReadAheadThreadPool readAheadPool;
+        TrackCache trackCache;
+        TrackLoader trackLoader;
+        DJAudioPlayer player;
+        bool loaded = false;
+    };
+
+    void benchmarkPlayer(BenchmarkRunner::State& state, BenchFixtures& fixtures, int blockSize, bool keyLock)
+    {
+        PlayerRig rig(fixtures);
+
+        if (! rig.loaded)
+        {
+            state.skipWithError("Couldn't load the fixture track");
+            return;
+        }
+
+        auto& player = rig.player;
+        player.prepareToPlay(blockSize, outputSampleRate);
+        player.setKeyLock(keyLock);
+        player.setSpeed(1.04);
+        player.setHighGain(0.5);
+        player.setLowGain(1.5);
+        player.start();
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        const juce::AudioSourceChannelInfo info(&buffer, 0, blockSize);
+        const auto loopPoint = (juce::int64) (50.0 * player.getTrackSampleRate());
+
+        while (state.keepRunning())
+        {
+            player.getNextAudioBlock(info);
+
+            // go back before the track runs out, so it's never rendering silence
+            if (player.getPositionInSamples() > loopPoint)
+            {
+                state.pauseTiming();
+                player.setPosition(0.0);
+                state.resumeTiming();
+            }
+        }
+
+        state.setItemsProcessed(state.getIterations() * blockSize);
+        player.releaseResources();
+    }
+
+    //==============================================================================
+    void benchmarkThreeBandEQ(BenchmarkRunner::State& state, int blockSize, bool sweep)
+    {
+        ThreeBandEQ eq;
+        eq.prepare(outputSampleRate);
+        eq.setHighGain(0.5f);
+        eq.setMidGain(1.2f);
+        eq.setLowGain(1.5f);
+
+        auto buffer = makeInput(blockSize);
+        float gain = 0.5f;
+
+        while (state.keepRunning())
+        {
+            // moving a knob every block keeps the bands smoothing and their coefficients being recalculated
+            if (sweep)
+            {
+                gain = gain > 1.9f ? 0.5f : gain * 1.01f;
+                eq.setMidGain(gain);
+            }
+
+            eq.process(buffer.getWritePointer(0), buffer.getWritePointer(1), blockSize);
+        }
+
+        state.setItemsProcessed(state.getIterations() * blockSize);
+    }
+
+    /** the same three bands as six scalar juce::IIRFilter passes, the way the deck used to do it */
+    void benchmarkIIRFilterEQ(BenchmarkRunner::State& state, int blockSize)
+    {
+        juce::IIRFilter filters[2][3];
+
+        for (auto& channel : filters)
+        {
+            channel[0].setCoefficients(juce::IIRCoefficients::makeHighShelf(outputSampleRate, 7000, 0.5, 0.5));
+            channel[1].setCoefficients(juce::IIRCoefficients::makePeakFilter(outputSampleRate, 2500, 0.555, 1.2));
+            channel[2].setCoefficients(juce::IIRCoefficients::makeLowShelf(outputSampleRate, 1000, 0.5, 1.5));
+        }
+
+        auto buffer = makeInput(blockSize);
+
+        while (state.keepRunning())
+            for (int channel = 0; channel < 2; ++channel)
+                for (auto& filter : filters[channel])
+                    filter.processSamples(buffer.getWritePointer(channel), blockSize);
+
+        state.setItemsProcessed(state.getIterations() * blockSize);
+    }
+
+    //==============================================================================
+    void benchmarkResampler(BenchmarkRunner::State& state, double ratio)
+    {
+        const int blockSize = 512;
+        auto source = makeInput(1 << 16);
+        juce::MemoryAudioSource input(source, false, true);
+        juce::ResamplingAudioSource resampler(&input, false, 2);
+        resampler.setResamplingRatio(ratio);
+        resampler.prepareToPlay(blockSize, outputSampleRate);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        const juce::AudioSourceChannelInfo info(&buffer, 0, blockSize);
+
+        while (state.keepRunning())
+            resampler.getNextAudioBlock(info);
+
+        state.setItemsProcessed(state.getIterations() * blockSize);
+        resampler.releaseResources();
+    }
+}
+
+void registerAudioBenchmarks(BenchmarkRunner& runner, BenchFixtures& fixtures)
+{
+    for (int blockSize : { 32, 64, 128, 256, 512, 1024, 2048 })
+    {
+        runner.add("BM_PlayerBlock/" + juce::String(blockSize), [&fixtures, blockSize](BenchmarkRunner::State& state)
+        {
+            benchmarkPlayer(state, fixtures, blockSize, false);
+        });
+    }
+
+    for (int blockSize : { 128, 512 })
+    {
+        runner.add("BM_PlayerBlockKeyLock/" + juce::String(blockSize), [&fixtures, blockSize](BenchmarkRunner::State& state)
+        {
+            benchmarkPlayer(state, fixtures, blockSize, true);
+        });
+    }
+
+    for (int blockSize : { 64, 512, 2048 })
+    {
+        runner.add("BM_ThreeBandEQ/" + juce::String(blockSize), [blockSize](BenchmarkRunner::State& state)
+        {
+            benchmarkThreeBandEQ(state, blockSize, false);
+        });
+
+        runner.add("BM_ThreeBandEQSweep/" + juce::String(blockSize), [blockSize](BenchmarkRunner::State& state)
+        {
+            benchmarkThreeBandEQ(state, blockSize, true);
+        });
+
+        runner.add("BM_IIRFilterEQ/" + juce::String(blockSize), [blockSize](BenchmarkRunner::State& state)
+        {
+            benchmarkIIRFilterEQ(state, blockSize);
+        });
+    }
+
+    // slowed right down, 44.1kHz tracks on a 48kHz device and the reverse, the tempo fader's ends, double speed
+    for (double ratio : { 0.5, 0.91875, 1.0, 1.08844, 1.2, 2.0 })
+    {
+        runner.add("BM_Resample/" + juce::String(ratio), [ratio](BenchmarkRunner::State& state)
+        {
+            benchmarkResampler(state, ratio);
+        });
+    }
+}
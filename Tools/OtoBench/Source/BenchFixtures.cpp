@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    BenchFixtures.cpp
+    Created: 18 Oct 2026 12:24:31am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "BenchFixtures.h"
+
+BenchFixtures::BenchFixtures(const juce::File& _directory)
+    : directory(_directory)
+{
+    directory.createDirectory();
+    formatManager.registerBasicFormats();
+}
+
+juce::AudioFormatManager& BenchFixtures::getFormatManager()
+{
+    return formatManager;
+}
+
+juce::File BenchFixtures::getDirectory() const
+{
+    return directory;
+}
+
+juce::File BenchFixtures::getTrack(const juce::String& extension, int lengthSeconds, double sampleRate, int numChannels)
+{
+    const auto file = directory.getChildFile("track_" + juce::String(lengthSeconds) + "s_" + juce::String((int) sampleRate)
+                                             + "_" + juce::String(numChannels) + "ch." + extension);
+
+    if (file.existsAsFile())
+        return file;
+
+    auto* format = formatManager.findFormatForFileExtension(extension);
+
+    if (format == nullptr || ! writeTrack(file, *format, lengthSeconds, sampleRate, numChannels))
+    {
+        file.deleteFile();
+    }
+
+    return file;
+}
+
+bool BenchFixtures::writeTrack(const juce::File& file, juce::AudioFormat& format, int lengthSeconds,
+                               double sampleRate, int numChannels)
+{
+    auto stream = file.createOutputStream();
+
+    if (stream == nullptr)
+        return false;
+
+    // the MP3 reader has no writer to go with it, and createWriterFor says so by returning nullptr
+    std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(stream.get(), sampleRate, (unsigned int) numChannels,
+                                                                           16, {}, 0));
+    if (writer == nullptr)
+        return false;
+
+    stream.release(); // the writer owns it now
+
+    juce::Random random(1);
+    const int chunkSize = 65536;
+    const auto beatLength = (juce::int64) (sampleRate / 2);
+    const auto length = (juce::int64) (lengthSeconds * sampleRate);
+    juce::AudioBuffer<float> buffer(numChannels, chunkSize);
+
+    for (juce::int64 start = 0; start < length; start += chunkSize)
+    {
+        const int numSamples = (int) juce::jmin((juce::int64) chunkSize, length - start);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto position = start + i;
+            const auto sinceBeat = (double) (position % beatLength) / sampleRate;
+            const float kick = (float) (std::exp(-sinceBeat * 12.0) * std::sin(juce::MathConstants<double>::twoPi * 55.0 * sinceBeat));
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.setSample(channel, i, 0.5f * kick + 0.2f * (random.nextFloat() * 2.0f - 1.0f));
+        }
+
+        if (! writer->writeFromAudioSampleBuffer(buffer, 0, numSamples))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    BenchFixtures.h
+    Created: 18 Oct 2026 12:24:31am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    The audio files the benchmarks load and play, generated the first time
+    they're asked for and kept in a directory so later runs reuse them.
+
+    The signal is seeded noise under a kick-like envelope every half second,
+    so the decoders, filters and peak builder see something closer to music
+    than silence or a sine, and every run sees exactly the same samples.
+
+    MP3s can't be encoded here, so an MP3 is only there if someone has put
+    one in the directory under the name getTrack() would give it.
+*/
+class BenchFixtures
+{
+public:
+    explicit BenchFixtures(const juce::File& directory);
+
+    juce::AudioFormatManager& getFormatManager();
+    juce::File getDirectory() const;
+
+    /** a track in the format with the given file extension ("wav", "flac" or "mp3").
+        If it couldn't be written the file won't exist, but says where it should go */
+    juce::File getTrack(const juce::String& extension, int lengthSeconds,
+                        double sampleRate = 44100.0, int numChannels = 2);
+
+private:
+    bool writeTrack(const juce::File& file, juce::AudioFormat& format, int lengthSeconds,
+                    double sampleRate, int numChannels);
+
+    juce::File directory;
+    juce::AudioFormatManager formatManager;
+};
@@ -0,0 +1,267 @@
+/*
+  ==============================================================================
+
+    BenchmarkRunner.cpp
+    Created: 18 Oct 2026 12:10:54am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "BenchmarkRunner.h"
+#include <cstdio>
+#include <regex>
+
+namespace
+{
+    constexpr juce::int64 iterationLimit = 1000000000;
+
+    juce::String getFamily(const juce::String& name)
+    {
+        return name.upToFirstOccurrenceOf("/", false, false);
+    }
+}
+
+//==============================================================================
+BenchmarkRunner::State::State(juce::int64 iterations)
+    : maxIterations(iterations)
+{}
+
+bool BenchmarkRunner::State::keepRunning()
+{
+    if (! started)
+    {
+        started = true;
+        resumeTiming();
+    }
+
+    if (iterationsDone < maxIterations && errorMessage.isEmpty())
+    {
+        ++iterationsDone;
+        return true;
+    }
+
+    pauseTiming();
+    return false;
+}
+
+void BenchmarkRunner::State::pauseTiming()
+{
+    if (! running)
+        return;
+
+    realSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    cpuSeconds += (double) (std::clock() - startCpu) / CLOCKS_PER_SEC;
+    running = false;
+}
+
+void BenchmarkRunner::State::resumeTiming()
+{
+    if (running)
+        return;
+
+    startTicks = juce::Time::getHighResolutionTicks();
+    startCpu = std::clock();
+    running = true;
+}
+
+void BenchmarkRunner::State::setCounter(const juce::String& name, double value, bool perIteration)
+{
+    counters[name] = { value, perIteration };
+}
+
+void BenchmarkRunner::State::skipWithError(const juce::String& message)
+{
+    errorMessage = message;
+    skipped = false;
+}
+
+void BenchmarkRunner::State::skipWithMessage(const juce::String& message)
+{
+    errorMessage = message;
+    skipped = true;
+}
+
+//==============================================================================
+void BenchmarkRunner::add(const juce::String& name, Function function)
+{
+    benchmarks.push_back({ name, std::move(function) });
+}
+
+bool BenchmarkRunner::run(const Options& options)
+{
+    std::regex filter;
+
+    try
+    {
+        filter = std::regex(options.filter.isEmpty() ? "." : options.filter.toStdString());
+    }
+    catch (const std::regex_error&)
+    {
+        std::fprintf(stderr, "Invalid filter: %s\n", options.filter.toRawUTF8());
+        return false;
+    }
+
+    std::printf("%-48s %15s %15s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+    std::printf("%s\n", juce::String::repeatedString("-", 93).toRawUTF8());
+
+    std::vector<Result> results;
+    bool allPassed = true;
+
+    for (const auto& benchmark : benchmarks)
+    {
+        if (! std::regex_search(benchmark.name.toStdString(), filter))
+            continue;
+
+        results.push_back(runBenchmark(benchmark, options.minSeconds));
+        printResult(results.back());
+        allPassed = allPassed && (results.back().errorMessage.isEmpty() || results.back().skipped);
+    }
+
+    if (options.jsonOutput != juce::File() && ! writeJson(options.jsonOutput, results))
+    {
+        std::fprintf(stderr, "Couldn't write %s\n", options.jsonOutput.getFullPathName().toRawUTF8());
+        return false;
+    }
+
+    return allPassed;
+}
+
+BenchmarkRunner::Result BenchmarkRunner::runBenchmark(const Benchmark& benchmark, double minSeconds)
+{
+    Result result;
+    result.name = benchmark.name;
+
+    // grow the iteration count until a run is long enough to trust, as Google Benchmark does
+    for (juce::int64 iterations = 1;;)
+    {
+        State state(iterations);
+        benchmark.function(state);
+
+        if (state.errorMessage.isNotEmpty())
+        {
+            result.errorMessage = state.errorMessage;
+            result.skipped = state.skipped;
+            return result;
+        }
+
+        if (state.realSeconds >= minSeconds || iterations >= iterationLimit)
+        {
+            const auto n = (double) state.iterationsDone;
+            result.iterations = state.iterationsDone;
+            result.realNs = state.realSeconds * 1.0e9 / n;
+            result.cpuNs = state.cpuSeconds * 1.0e9 / n;
+
+            if (state.realSeconds > 0)
+            {
+                result.itemsPerSecond = state.itemsProcessed / state.realSeconds;
+                result.bytesPerSecond = state.bytesProcessed / state.realSeconds;
+            }
+
+            for (const auto& counter : state.counters)
+                result.counters[counter.first] = counter.second.second ? counter.second.first / n : counter.second.first;
+
+            return result;
+        }
+
+        const bool isSignificant = state.realSeconds / minSeconds > 0.1;
+        const double multiplier = isSignificant ? minSeconds * 1.4 / juce::jmax(state.realSeconds, 1.0e-9) : 10.0;
+        iterations = juce::jmin(iterationLimit, juce::jmax(iterations + 1, (juce::int64) (iterations * multiplier)));
+    }
+}
+
+void BenchmarkRunner::printResult(const Result& result)
+{
+    if (result.errorMessage.isNotEmpty())
+    {
+        std::printf("%-48s %s: '%s'\n", result.name.toRawUTF8(), result.skipped ? "SKIPPED" : "ERROR OCCURRED",
+                    result.errorMessage.toRawUTF8());
+        return;
+    }
+
+    juce::String extra;
+
+    if (result.itemsPerSecond > 0)
+        extra << " items_per_second=" << juce::String(result.itemsPerSecond / 1.0e6, 3) << "M/s";
+
+    if (result.bytesPerSecond > 0)
+        extra << " bytes_per_second=" << juce::String(result.bytesPerSecond / (1024.0 * 1024.0), 3) << "Mi/s";
+
+    for (const auto& counter : result.counters)
+        extra << " " << counter.first << "=" << juce::String(counter.second, 3);
+
+    std::printf("%-48s %12.0f ns %12.0f ns %12lld%s\n", result.name.toRawUTF8(), result.realNs, result.cpuNs,
+                (long long) result.iterations, extra.toRawUTF8());
+}
+
+bool BenchmarkRunner::writeJson(const juce::File& file, const std::vector<Result>& results)
+{
+    auto* context = new juce::DynamicObject();
+    context->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    context->setProperty("host_name", juce::SystemStats::getComputerName());
+    context->setProperty("executable", juce::File::getSpecialLocation(juce::File::currentExecutableFile).getFullPathName());
+    context->setProperty("num_cpus", juce::SystemStats::getNumCpus());
+    context->setProperty("mhz_per_cpu", juce::SystemStats::getCpuSpeedInMegahertz());
+    context->setProperty("cpu_scaling_enabled", false);
+    context->setProperty("json_schema_version", 1);
+   #if JUCE_DEBUG
+    context->setProperty("library_build_type", "debug");
+   #else
+    context->setProperty("library_build_type", "release");
+   #endif
+
+    juce::Array<juce::var> entries;
+    juce::StringArray families;
+    std::map<juce::String, int> instancesPerFamily;
+
+    for (const auto& result : results)
+    {
+        const auto family = getFamily(result.name);
+        families.addIfNotAlreadyThere(family);
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("name", result.name);
+        entry->setProperty("family_index", families.indexOf(family));
+        entry->setProperty("per_family_instance_index", instancesPerFamily[family]++);
+        entry->setProperty("run_name", result.name);
+        entry->setProperty("run_type", "iteration");
+        entry->setProperty("repetitions", 1);
+        entry->setProperty("repetition_index", 0);
+        entry->setProperty("threads", 1);
+
+        if (result.errorMessage.isNotEmpty() && result.skipped)
+        {
+            entry->setProperty("skipped", true);
+            entry->setProperty("skip_message", result.errorMessage);
+        }
+        else if (result.errorMessage.isNotEmpty())
+        {
+            entry->setProperty("error_occurred", true);
+            entry->setProperty("error_message", result.errorMessage);
+        }
+        else
+        {
+            entry->setProperty("iterations", result.iterations);
+            entry->setProperty("real_time", result.realNs);
+            entry->setProperty("cpu_time", result.cpuNs);
+            entry->setProperty("time_unit", "ns");
+
+            if (result.itemsPerSecond > 0)
+                entry->setProperty("items_per_second", result.itemsPerSecond);
+
+            if (result.bytesPerSecond > 0)
+                entry->setProperty("bytes_per_second", result.bytesPerSecond);
+
+            for (const auto& counter : result.counters)
+                entry->setProperty(juce::Identifier(counter.first), counter.second);
+        }
+
+        entries.add(juce::var(entry));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("context", juce::var(context));
+    root->setProperty("benchmarks", entries);
+
+    return file.replaceWithText(juce::JSON::toString(juce::var(root)));
+}
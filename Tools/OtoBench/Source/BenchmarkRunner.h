@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    BenchmarkRunner.h
+    Created: 18 Oct 2026 12:10:54am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <vector>
+
+//==============================================================================
+/*
+    A small benchmark harness along the lines of Google Benchmark, written
+    against JUCE so the tools don't need another dependency to build.
+
+    A benchmark is a function that loops while state.keepRunning() is true.
+    The runner grows the iteration count until a run lasts at least the
+    minimum time, then reports the wall and CPU time per iteration, plus
+    items and bytes per second and any counters the benchmark set.
+
+    The results are written out in Google Benchmark's JSON format, so the
+    usual compare.py and dashboards can track them from release to release.
+*/
+class BenchmarkRunner
+{
+public:
+    class State
+    {
+    public:
+        /** true while the benchmark should do another iteration */
+        bool keepRunning();
+
+        /** leave setup that has to happen inside the loop out of the timing */
+        void pauseTiming();
+        void resumeTiming();
+
+        juce::int64 getIterations() const { return maxIterations; }
+
+        void setItemsProcessed(juce::int64 items)   { itemsProcessed = items; }
+        void setBytesProcessed(juce::int64 bytes)   { bytesProcessed = bytes; }
+
+        /** reported as-is alongside the timings, averaged over the iterations if perIteration */
+        void setCounter(const juce::String& name, double value, bool perIteration = false);
+
+        /** stops the benchmark and reports the message in place of any results */
+        void skipWithError(const juce::String& message);
+
+        /** stops the benchmark without failing the run, for something it needs that isn't there */
+        void skipWithMessage(const juce::String& message);
+
+    private:
+        friend class BenchmarkRunner;
+        explicit State(juce::int64 iterations);
+
+        juce::int64 maxIterations;
+        juce::int64 iterationsDone = 0;
+        bool started = false;
+        bool running = false;
+
+        juce::int64 startTicks = 0;
+        std::clock_t startCpu = 0;
+        double realSeconds = 0.0;
+        double cpuSeconds = 0.0;
+
+        juce::int64 itemsProcessed = 0;
+        juce::int64 bytesProcessed = 0;
+        std::map<juce::String, std::pair<double, bool>> counters;
+        juce::String errorMessage;
+        bool skipped = false;           // errorMessage is why it was skipped, not an error
+    };
+
+    using Function = std::function<void(State&)>;
+
+    struct Options
+    {
+        juce::String filter;            // a regex; only benchmarks whose names match are run
+        double minSeconds = 0.5;
+        juce::File jsonOutput;          // written as well as the console table if set
+    };
+
+    /** names follow Google Benchmark's convention of family/argument, e.g. "BM_PlayerBlock/512" */
+    void add(const juce::String& name, Function function);
+
+    /** runs everything that passes the filter, returning false if any of them failed.
+        Skipped benchmarks don't count as failures */
+    bool run(const Options& options);
+
+private:
+    struct Benchmark
+    {
+        juce::String name;
+        Function function;
+    };
+
+    struct Result
+    {
+        juce::String name;
+        juce::int64 iterations = 0;
+        double realNs = 0.0;            // per iteration
+        double cpuNs = 0.0;
+        double itemsPerSecond = 0.0;
+        double bytesPerSecond = 0.0;
+        std::map<juce::String, double> counters;
+        juce::String errorMessage;
+        bool skipped = false;
+    };
+
+    Result runBenchmark(const Benchmark& benchmark, double minSeconds);
+    static void printResult(const Result& result);
+    static bool writeJson(const juce::File& file, const std::vector<Result>& results);
+
+    std::vector<Benchmark> benchmarks;
+};
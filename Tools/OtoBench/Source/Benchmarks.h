@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    Benchmarks.h
+    Created: 18 Oct 2026 12:31:08am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "BenchFixtures.h"
+#include "BenchmarkRunner.h"
+
+/** the deck's audio path: whole player blocks, the EQ and the resampler */
+void registerAudioBenchmarks(BenchmarkRunner& runner, BenchFixtures& fixtures);
+
+/** everything off the audio thread: loading tracks, playlist files and waveforms */
+void registerLoadBenchmarks(BenchmarkRunner& runner, BenchFixtures& fixtures);
+
+/** the track library: building its search index, searching it as it's typed, and sorting it */
+void registerLibraryBenchmarks(BenchmarkRunner& runner, BenchFixtures& fixtures);
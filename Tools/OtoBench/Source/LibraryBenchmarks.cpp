@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    LibraryBenchmarks.cpp
+    Created: 18 Oct 2026 4:58:40am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../../Source/TrackLibrary.h"
+#include "../../../Source/TrackSearchIndex.h"
+
+namespace
+{
+    /** a library of made-up tracks, spread over enough artists and words to look like a real collection */
+    std::unique_ptr<TrackLibrary> makeLibrary(BenchFixtures& fixtures, int numTracks)
+    {
+        static const char* const words[] = { "sunset", "deep", "house", "techno", "night", "drive", "echo", "shadow",
+                                             "river", "gold", "dub", "acid", "dawn", "signal", "circuit", "velvet" };
+        constexpr int numWords = (int) (sizeof(words) / sizeof(words[0]));
+
+        const auto file = fixtures.getDirectory().getChildFile("library_" + juce::String(numTracks) + ".otl");
+        file.deleteFile();
+        file.getSiblingFile(file.getFileName() + ".log").deleteFile();
+
+        auto library = std::make_unique<TrackLibrary>(file);
+        library->load();
+
+        juce::Random random(42);
+        std::vector<LibraryTrack> tracks((size_t) numTracks);
+
+        for (int i = 0; i < numTracks; ++i)
+        {
+            auto& track = tracks[(size_t) i];
+            track.artist = "Artist " + juce::String(random.nextInt(numTracks / 10 + 1));
+            track.title = juce::String(words[random.nextInt(numWords)]) + " " + words[random.nextInt(numWords)]
+                        + " (" + words[random.nextInt(numWords)] + " Mix)";
+            track.path = "/home/dj/Music/" + track.artist + "/" + track.title + " " + juce::String(i) + ".flac";
+            track.durationSeconds = 120.0 + random.nextInt(480);
+            track.bpm = random.nextInt(4) == 0 ? 0.0 : 90.0 + random.nextInt(80);
+        }
+
+        library->addOrUpdate(tracks);
+        library->flush();
+        return library;
+    }
+
+    void benchmarkIndexBuild(BenchmarkRunner::State& state, BenchFixtures& fixtures, int numTracks)
+    {
+        const auto library = makeLibrary(fixtures, numTracks);
+
+        while (state.keepRunning())
+        {
+            TrackSearchIndex index;
+            index.update(*library);
+        }
+
+        state.setItemsProcessed(state.getIterations() * numTracks);
+    }
+
+    /** typing a search a letter at a time, as the search box sees it */
+    void benchmarkSearch(BenchmarkRunner::State& state, BenchFixtures& fixtures, int numTracks)
+    {
+        const auto library = makeLibrary(fixtures, numTracks);
+
+        TrackSearchIndex index;
+        index.update(*library);
+        index.setSortOrder(TrackSearchIndex::SortColumn::bpm, true);
+        index.setSortOrder(TrackSearchIndex::SortColumn::title, true);
+
+        const juce::String query("sunset dub 12");
+        double maxKeystrokeMs = 0.0;
+
+        while (state.keepRunning())
+        {
+            for (int length = 1; length <= query.length(); ++length)
+            {
+                index.setQuery(query.substring(0, length));
+                maxKeystrokeMs = juce::jmax(maxKeystrokeMs, index.getLastSearchMs());
+            }
+
+            index.setQuery({});
+        }
+
+        state.setItemsProcessed(state.getIterations() * (query.length() + 1));
+        state.setCounter("max_keystroke_ms", maxKeystrokeMs);
+    }
+
+    /** what an edit costs the message thread, with the writing left to the journal */
+    void benchmarkEdit(BenchmarkRunner::State& state, BenchFixtures& fixtures, int numTracks)
+    {
+        const auto library = makeLibrary(fixtures, numTracks);
+        int row = 0;
+
+        while (state.keepRunning())
+        {
+            auto track = library->getTrack(row);
+            track.bpm = track.bpm > 0 ? 0.0 : 120.0;
+            library->addOrUpdate(track);
+            row = (row + 1) % numTracks;
+        }
+
+        library->flush();
+        state.setItemsProcessed(state.getIterations());
+    }
+
+    /** reading the snapshot and replaying the log */
+    void benchmarkLoad(BenchmarkRunner::State& state, BenchFixtures& fixtures, int numTracks)
+    {
+        const auto library = makeLibrary(fixtures, numTracks);
+
+        while (state.keepRunning())
+            library->load();
+
+        state.setItemsProcessed(state.getIterations() * numTracks);
+    }
+
+    void benchmarkSort(BenchmarkRunner::State& state, BenchFixtures& fixtures, int numTracks)
+    {
+        const auto library = makeLibrary(fixtures, numTracks);
+
+        TrackSearchIndex index;
+        index.update(*library);
+        bool forwards = true;
+
+        while (state.keepRunning())
+        {
+            index.setSortOrder(TrackSearchIndex::SortColumn::title, forwards);
+            forwards = ! forwards;
+        }
+
+        state.setItemsProcessed(state.getIterations() * numTracks);
+    }
+}
+
+void registerLibraryBenchmarks(BenchmarkRunner& runner, BenchFixtures& fixtures)
+{
+    runner.add("BM_LibraryIndexBuild/50000", [&fixtures](BenchmarkRunner::State& state) { benchmarkIndexBuild(state, fixtures, 50000); });
+    runner.add("BM_LibrarySearch/50000", [&fixtures](BenchmarkRunner::State& state) { benchmarkSearch(state, fixtures, 50000); });
+    runner.add("BM_LibraryEdit/50000", [&fixtures](BenchmarkRunner::State& state) { benchmarkEdit(state, fixtures, 50000); });
+    runner.add("BM_LibraryLoad/50000", [&fixtures](BenchmarkRunner::State& state) { benchmarkLoad(state, fixtures, 50000); });
+    runner.add("BM_LibrarySort/50000", [&fixtures](BenchmarkRunner::State& state) { benchmarkSort(state, fixtures, 50000); });
+}
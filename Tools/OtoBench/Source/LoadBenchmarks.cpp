@@ -0,0 +1,303 @@
+/*
+  ==============================================================================
+
+    LoadBenchmarks.cpp
+    Created: 18 Oct 2026 12:47:19am
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../../Source/LibraryScanner.h"
+#include "../../../Source/PeakFile.h"
+#include "../../../Source/PlaylistFile.h"
+#include "../../../Source/ReadAheadThreadPool.h"
+#include "../../../Source/TrackLoader.h"
+#include "../../../Source/WaveformDisplay.h"
+
+namespace
+{
+    /** the work DJAudioPlayer::loadURL hands to the loader thread: open, probe and pre-buffer */
+    void benchmarkLoadURL(BenchmarkRunner::State& state, BenchFixtures& fixtures,
+                          const juce::String& extension, bool memoryMapped)
+    {
+        const auto file = fixtures.getTrack(extension, 60);
+
+        // there's no MP3 writer to generate one with, so that fixture is optional
+        if (! file.existsAsFile())
+        {
+            state.skipWithMessage("No fixture at " + file.getFullPathName());
+            return;
+        }
+
+        // no cache, so every load does the real work
+        ReadAheadThreadPool readAheadPool;
+        TrackLoader trackLoader(fixtures.getFormatManager(), readAheadPool, nullptr, 1);
+
+        TrackLoader::Request request;
+        request.url = juce::URL(file);
+        request.useMemoryMapping = memoryMapped;
+
+        TrackLoadTimings totals;
+
+        while (state.keepRunning())
+        {
+            auto track = trackLoader.loadNow(request);
+
+            state.pauseTiming();
+
+            if (track == nullptr)
+            {
+                state.skipWithError("Couldn't load " + file.getFileName());
+                return;
+            }
+
+            totals.openMs += track->timings.openMs;
+            totals.probeMs += track->timings.probeMs;
+            totals.prebufferMs += track->timings.prebufferMs;
+            track.reset(); // closing the track isn't part of loading it
+
+            state.resumeTiming();
+        }
+
+        state.setCounter("open_ms", totals.openMs, true);
+        state.setCounter("probe_ms", totals.probeMs, true);
+        state.setCounter("prebuffer_ms", totals.prebufferMs, true);
+    }
+
+    /** what the library import does per file: the header and tags, with nothing decoded */
+    void benchmarkReadTrackInfo(BenchmarkRunner::State& state, BenchFixtures& fixtures, const juce::String& extension)
+    {
+        const auto file = fixtures.getTrack(extension, 60);
+
+        // there's no MP3 writer to generate one with, so that fixture is optional
+        if (! file.existsAsFile())
+        {
+            state.skipWithMessage("No fixture at " + file.getFullPathName());
+            return;
+        }
+
+        while (state.keepRunning())
+        {
+            LibraryTrack track;
+
+            if (! LibraryScanner::readTrackInfo(fixtures.getFormatManager(), file, track))
+            {
+                state.skipWithError("Couldn't read " + file.getFileName());
+                return;
+            }
+        }
+
+        state.setItemsProcessed(state.getIterations());
+    }
+
+    //==============================================================================
+    /** an exported crate of numTracks tracks, with every field filled in and some quoting to do */
+    juce::File makePlaylistFile(BenchFixtures& fixtures, const char* extension, int numTracks)
+    {
+        const auto file = fixtures.getDirectory().getChildFile("crate_" + juce::String(numTracks) + "." + extension);
+        std::vector<std::string> paths, titles;
+        std::vector<PlaylistFile::Entry> entries((size_t) numTracks);
+
+        for (int i = 0; i < numTracks; ++i)
+        {
+            titles.push_back("Track " + std::to_string(i + 1) + (i % 10 == 0 ? " (Extended Mix, Remastered)" : " (Extended Mix)"));
+            paths.push_back("/home/dj/Music/Some Artist/" + titles.back() + ".flac");
+        }
+
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            entries[i].path = paths[i];
+            entries[i].title = titles[i];
+            entries[i].artist = "Some Artist";
+            entries[i].durationSeconds = 402.0;
+            entries[i].bpm = 126.0;
+        }
+
+        PlaylistFile::write(file, entries);
+        return file;
+    }
+
+    void benchmarkPlaylistWrite(BenchmarkRunner::State& state, BenchFixtures& fixtures, const char* extension, int numTracks)
+    {
+        const auto file = fixtures.getDirectory().getChildFile("crate_written." + juce::String(extension));
+        const std::string path = "/home/dj/Music/Some Artist/Track (Extended Mix).flac";
+
+        PlaylistFile::Entry entry;
+        entry.path = path;
+        entry.title = "Track (Extended Mix)";
+        entry.artist = "Some Artist";
+        entry.durationSeconds = 402.0;
+        entry.bpm = 126.0;
+
+        const std::vector<PlaylistFile::Entry> entries((size_t) numTracks, entry);
+
+        while (state.keepRunning())
+        {
+            const auto result = PlaylistFile::write(file, entries);
+
+            if (result.failed())
+            {
+                state.skipWithError(result.getErrorMessage());
+                return;
+            }
+        }
+
+        state.setBytesProcessed(state.getIterations() * file.getSize());
+        state.setItemsProcessed(state.getIterations() * numTracks);
+    }
+
+    /** mapping and parsing a crate, without adding it to a library */
+    void benchmarkPlaylistRead(BenchmarkRunner::State& state, BenchFixtures& fixtures, const char* extension, int numTracks)
+    {
+        const auto file = makePlaylistFile(fixtures, extension, numTracks);
+        juce::int64 numEntries = 0;
+
+        while (state.keepRunning())
+        {
+            const auto result = PlaylistFile::read(file, [&numEntries](const PlaylistFile::Entry&) { ++numEntries; });
+
+            if (result.failed())
+            {
+                state.skipWithError(result.getErrorMessage());
+                return;
+            }
+        }
+
+        if (numEntries != state.getIterations() * numTracks)
+        {
+            state.skipWithError("Read the wrong number of tracks from " + file.getFileName());
+            return;
+        }
+
+        state.setBytesProcessed(state.getIterations() * file.getSize());
+        state.setItemsProcessed(state.getIterations() * numTracks);
+    }
+
+    //==============================================================================
+    void benchmarkPeakFileBuild(BenchmarkRunner::State& state, BenchFixtures& fixtures)
+    {
+        const auto file = fixtures.getTrack("wav", 60);
+        const auto peakDirectory = fixtures.getDirectory().getChildFile("peaks_build");
+        juce::int64 lengthInSamples = 0;
+
+        while (state.keepRunning())
+        {
+            if (! PeakFile::build(fixtures.getFormatManager(), file, peakDirectory))
+            {
+                state.skipWithError("Couldn't build peaks for " + file.getFileName());
+                return;
+            }
+        }
+
+        if (auto peaks = PeakFile::open(file, peakDirectory))
+            lengthInSamples = peaks->getLengthInSamples();
+
+        state.setItemsProcessed(state.getIterations() * lengthInSamples);
+    }
+
+    /** the peaks for a track, built the first time and mapped from disk after that, as PeakStore does */
+    std::unique_ptr<PeakFile> getPeaks(BenchFixtures& fixtures, const juce::File& file)
+    {
+        const auto peakDirectory = fixtures.getDirectory().getChildFile("peaks");
+
+        if (auto peaks = PeakFile::open(file, peakDirectory))
+            return peaks;
+
+        PeakFile::build(fixtures.getFormatManager(), file, peakDirectory);
+        return PeakFile::open(file, peakDirectory);
+    }
+
+    void benchmarkPeakFileOpen(BenchmarkRunner::State& state, BenchFixtures& fixtures)
+    {
+        const auto file = fixtures.getTrack("wav", 60);
+
+        if (getPeaks(fixtures, file) == nullptr)
+        {
+            state.skipWithError("Couldn't build peaks for " + file.getFileName());
+            return;
+        }
+
+        const auto peakDirectory = fixtures.getDirectory().getChildFile("peaks");
+
+        while (state.keepRunning())
+            PeakFile::open(file, peakDirectory);
+    }
+
+    void benchmarkDrawPeaks(BenchmarkRunner::State& state, BenchFixtures& fixtures, const juce::File& file)
+    {
+        const auto peaks = getPeaks(fixtures, file);
+
+        if (peaks == nullptr)
+        {
+            state.skipWithError("Couldn't build peaks for " + file.getFileName());
+            return;
+        }
+
+        // about the size of a deck's overview, with the same fill and colour as WaveformDisplay
+        juce::Image image(juce::Image::RGB, 1200, 120, false);
+        juce::Graphics g(image);
+
+        while (state.keepRunning())
+        {
+            g.fillAll(juce::Colours::black);
+            g.setColour(juce::Colours::orange);
+            WaveformDisplay::drawPeaks(g, image.getBounds(), *peaks);
+        }
+
+        state.setItemsProcessed(state.getIterations() * image.getWidth());
+    }
+}
+
+void registerLoadBenchmarks(BenchmarkRunner& runner, BenchFixtures& fixtures)
+{
+    for (auto extension : { "wav", "flac", "mp3" })
+    {
+        runner.add("BM_LoadURL/" + juce::String(extension), [&fixtures, extension](BenchmarkRunner::State& state)
+        {
+            benchmarkLoadURL(state, fixtures, extension, true);
+        });
+    }
+
+    runner.add("BM_LoadURL/wav_streamed", [&fixtures](BenchmarkRunner::State& state)
+    {
+        benchmarkLoadURL(state, fixtures, "wav", false);
+    });
+
+    for (auto extension : { "wav", "flac", "mp3" })
+    {
+        runner.add("BM_ReadTrackInfo/" + juce::String(extension), [&fixtures, extension](BenchmarkRunner::State& state)
+        {
+            benchmarkReadTrackInfo(state, fixtures, extension);
+        });
+    }
+
+    for (const auto* extension : { "csv", "m3u8", "pls" })
+    {
+        runner.add("BM_PlaylistWrite/" + juce::String(extension) + "/50000", [&fixtures, extension](BenchmarkRunner::State& state)
+        {
+            benchmarkPlaylistWrite(state, fixtures, extension, 50000);
+        });
+
+        runner.add("BM_PlaylistRead/" + juce::String(extension) + "/50000", [&fixtures, extension](BenchmarkRunner::State& state)
+        {
+            benchmarkPlaylistRead(state, fixtures, extension, 50000);
+        });
+    }
+
+    runner.add("BM_PeakFileBuild/60", [&fixtures](BenchmarkRunner::State& state) { benchmarkPeakFileBuild(state, fixtures); });
+    runner.add("BM_PeakFileOpen/60", [&fixtures](BenchmarkRunner::State& state) { benchmarkPeakFileOpen(state, fixtures); });
+
+    // drawing should cost about the same for a one minute track and an hour-long mix, since it picks a coarser level.
+    // The hour is mono at 8kHz to keep the fixture small, which at 24000 samples a pixel still draws from a coarse level
+    runner.add("BM_DrawPeaks/60", [&fixtures](BenchmarkRunner::State& state)
+    {
+        benchmarkDrawPeaks(state, fixtures, fixtures.getTrack("wav", 60));
+    });
+
+    runner.add("BM_DrawPeaks/3600", [&fixtures](BenchmarkRunner::State& state)
+    {
+        benchmarkDrawPeaks(state, fixtures, fixtures.getTrack("wav", 3600, 8000.0, 1));
+    });
+}
@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 18 Oct 2026 12:58:40am
+    Author:  Dan
+
+    Benchmarks the audio path and the loading paths.
+
+        OtoBench [--benchmark_filter=<regex>] [--benchmark_out=results.json]
+                 [--benchmark_min_time=0.5] [--fixtures=<dir>]
+
+    The options follow Google Benchmark's, and so does the JSON, so two runs
+    can be compared with its tools/compare.py. Test tracks are generated into
+    the fixtures directory on first use; put a 60 second 44.1kHz stereo MP3
+    there as track_60s_44100_2ch.mp3 to benchmark MP3 loading too. Without
+    it those benchmarks are reported as skipped, and the run still passes.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Benchmarks.h"
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser; // for the message manager the decks' timers expect
+    const juce::ArgumentList args (argc, argv);
+
+    BenchmarkRunner::Options options;
+    options.filter = args.getValueForOption ("--benchmark_filter");
+
+    if (args.containsOption ("--benchmark_min_time"))
+        options.minSeconds = args.getValueForOption ("--benchmark_min_time").getDoubleValue();
+
+    if (args.containsOption ("--benchmark_out"))
+        options.jsonOutput = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--benchmark_out"));
+
+    const auto fixturesOption = args.getValueForOption ("--fixtures");
+    BenchFixtures fixtures (fixturesOption.isNotEmpty() ? juce::File::getCurrentWorkingDirectory().getChildFile (fixturesOption)
+                                                        : juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("OtoBenchFixtures"));
+
+    BenchmarkRunner runner;
+    registerAudioBenchmarks (runner, fixtures);
+    registerLoadBenchmarks (runner, fixtures);
+    registerLibraryBenchmarks (runner, fixtures);
+
+    return runner.run (options) ? 0 : 1;
+}
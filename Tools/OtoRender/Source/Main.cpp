@@ -0,0 +1,167 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 11:40:02pm
+    Author:  Dan
+
+    Renders a timeline through the decks and mixer without an audio device.
+
+        OtoRender <timeline> <output.wav> [--rate=44100] [--block=512]
+                  [--workers=0] [--bits=32] [--stream]
+                  [--compare=golden.wav] [--tolerance=0]
+
+    --stream reads the tracks through the read-ahead buffers instead of
+    decoding them first, which isn't deterministic. --compare checks the
+    output against an earlier render, and exits with 2 if any sample is
+    further out than the tolerance.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "OfflineRenderer.h"
+#include "RenderTimeline.h"
+
+namespace
+{
+    int fail(const juce::String& message)
+    {
+        std::cerr << message << std::endl;
+        return 1;
+    }
+
+    /** the largest difference between any two samples of the files, or a failure if they don't line up */
+    juce::Result compareFiles(juce::AudioFormatManager& formatManager, const juce::File& rendered,
+                              const juce::File& golden, float& maxDifference)
+    {
+        std::unique_ptr<juce::AudioFormatReader> a(formatManager.createReaderFor(rendered));
+        std::unique_ptr<juce::AudioFormatReader> b(formatManager.createReaderFor(golden));
+
+        if (a == nullptr || b == nullptr)
+            return juce::Result::fail("Couldn't read " + (a == nullptr ? rendered : golden).getFullPathName());
+
+        if (a->lengthInSamples != b->lengthInSamples || a->numChannels != b->numChannels)
+            return juce::Result::fail("The render and " + golden.getFileName() + " are different lengths or widths");
+
+        const int chunkSize = 65536;
+        juce::AudioBuffer<float> bufferA((int) a->numChannels, chunkSize);
+        juce::AudioBuffer<float> bufferB((int) b->numChannels, chunkSize);
+        maxDifference = 0.0f;
+
+        for (juce::int64 start = 0; start < a->lengthInSamples; start += chunkSize)
+        {
+            const int numSamples = (int) juce::jmin((juce::int64) chunkSize, a->lengthInSamples - start);
+            a->read(&bufferA, 0, numSamples, start, true, true);
+            b->read(&bufferB, 0, numSamples, start, true, true);
+
+            for (int channel = 0; channel < bufferA.getNumChannels(); ++channel)
+            {
+                const auto* x = bufferA.getReadPointer(channel);
+                const auto* y = bufferB.getReadPointer(channel);
+
+                for (int i = 0; i < numSamples; ++i)
+                    maxDifference = juce::jmax(maxDifference, std::abs(x[i] - y[i]));
+            }
+        }
+
+        return juce::Result::ok();
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser; // for the message manager the decks' timers expect
+    const juce::ArgumentList args (argc, argv);
+
+    juce::StringArray paths;
+
+    for (const auto& arg : args.arguments)
+        if (! arg.isOption())
+            paths.add (arg.text);
+
+    if (paths.size() != 2)
+        return fail ("Usage: OtoRender <timeline> <output.wav> [--rate=44100] [--block=512] [--workers=0] "
+                     "[--bits=32] [--stream] [--compare=golden.wav] [--tolerance=0]");
+
+    const auto getOption = [&args] (const char* option, const juce::String& defaultValue)
+    {
+        const auto value = args.getValueForOption (option);
+        return value.isNotEmpty() ? value : defaultValue;
+    };
+
+    OfflineRenderer::Settings settings;
+    settings.sampleRate = getOption ("--rate", "44100").getDoubleValue();
+    settings.blockSize = getOption ("--block", "512").getIntValue();
+    settings.numWorkers = getOption ("--workers", "0").getIntValue();
+    settings.preDecode = ! args.containsOption ("--stream");
+    const int bitsPerSample = getOption ("--bits", "32").getIntValue();
+
+    if (settings.sampleRate < 8000 || settings.blockSize < 1)
+        return fail ("The sample rate and block size need to be positive");
+
+    RenderTimeline timeline;
+    const auto parsed = timeline.loadFromFile (juce::File::getCurrentWorkingDirectory().getChildFile (paths[0]));
+
+    if (parsed.failed())
+        return fail (parsed.getErrorMessage());
+
+    OfflineRenderer renderer (settings);
+    const auto outputFile = juce::File::getCurrentWorkingDirectory().getChildFile (paths[1]);
+    outputFile.deleteFile();
+
+    {
+        juce::WavAudioFormat wav;
+        auto stream = outputFile.createOutputStream();
+
+        if (stream == nullptr)
+            return fail ("Couldn't create " + outputFile.getFullPathName());
+
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (stream.get(), settings.sampleRate, 2,
+                                                                             bitsPerSample, {}, 0));
+        if (writer == nullptr)
+            return fail ("Can't write " + juce::String (bitsPerSample) + "-bit WAV");
+
+        stream.release(); // the writer owns it now
+
+        const auto rendered = renderer.render (timeline, *writer);
+
+        if (rendered.failed())
+            return fail (rendered.getErrorMessage());
+    }
+
+    const auto& stats = renderer.getStats();
+
+    std::cout << "Rendered " << stats.numSamples / settings.sampleRate << " s (" << stats.numSamples << " samples) to "
+              << outputFile.getFullPathName() << "\n"
+              << "  DSP time      " << stats.renderSeconds << " s\n"
+              << "  load time     " << stats.loadSeconds << " s\n"
+              << "  samples/sec   " << (juce::int64) stats.getSamplesPerSecond() << "\n"
+              << "  realtime      " << stats.getRealtimeFactor (settings.sampleRate) << "x" << std::endl;
+
+    const auto goldenPath = args.getValueForOption ("--compare");
+
+    if (goldenPath.isNotEmpty())
+    {
+        const auto golden = juce::File::getCurrentWorkingDirectory().getChildFile (goldenPath);
+        const float tolerance = getOption ("--tolerance", "0").getFloatValue();
+        float maxDifference = 0.0f;
+
+        const auto compared = compareFiles (renderer.getFormatManager(), outputFile, golden, maxDifference);
+
+        if (compared.failed())
+            return fail (compared.getErrorMessage());
+
+        std::cout << "  max difference from " << golden.getFileName() << " " << maxDifference << std::endl;
+
+        if (maxDifference > tolerance)
+        {
+            std::cerr << "Render doesn't match " << golden.getFullPathName() << std::endl;
+            return 2;
+        }
+    }
+
+    return 0;
+}
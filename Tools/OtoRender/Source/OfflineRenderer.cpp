@@ -0,0 +1,219 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 17 Oct 2026 11:31:45pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+#include <cmath>
+
+double OfflineRenderer::Stats::getSamplesPerSecond() const
+{
+    return renderSeconds > 0 ? numSamples / renderSeconds : 0.0;
+}
+
+double OfflineRenderer::Stats::getRealtimeFactor(double sampleRate) const
+{
+    return getSamplesPerSecond() / sampleRate;
+}
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer(const Settings& _settings)
+    : settings(_settings),
+      renderGroup(_settings.numWorkers)
+{
+    formatManager.registerBasicFormats();
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+    mixer.releaseResources();
+}
+
+const OfflineRenderer::Stats& OfflineRenderer::getStats() const
+{
+    return stats;
+}
+
+juce::AudioFormatManager& OfflineRenderer::getFormatManager()
+{
+    return formatManager;
+}
+
+juce::int64 OfflineRenderer::toSamples(double seconds) const
+{
+    return (juce::int64) std::llround(seconds * settings.sampleRate);
+}
+
+juce::Result OfflineRenderer::render(const RenderTimeline& timeline, juce::AudioFormatWriter& writer)
+{
+    const double endSeconds = timeline.getEndSeconds();
+
+    if (endSeconds <= 0)
+        return juce::Result::fail("The timeline needs an end event");
+
+    if (timeline.getNumDecks() > DeckMixer::maxDecks)
+        return juce::Result::fail("The timeline uses more than " + juce::String(DeckMixer::maxDecks) + " decks");
+
+    const auto prepared = prepareTracks(timeline);
+
+    if (prepared.failed())
+        return prepared;
+
+    // odd decks on the left of the crossfader, even decks on the right, as in the app
+    while (players.size() < timeline.getNumDecks())
+    {
+        auto* player = players.add(new DJAudioPlayer(trackLoader));
+        mixer.addDeck(player, players.size() % 2 == 1 ? DeckMixer::Side::a : DeckMixer::Side::b);
+        deckSync.addDeck(player);
+    }
+
+    mixer.prepareToPlay(settings.blockSize, settings.sampleRate);
+
+    juce::AudioBuffer<float> buffer(2, settings.blockSize);
+    const auto& events = timeline.getEvents();
+    size_t nextEvent = 0;
+
+    const auto endSample = toSamples(endSeconds);
+    juce::int64 position = 0;
+    stats = {};
+
+    while (position < endSample)
+    {
+        while (nextEvent < events.size() && toSamples(events[nextEvent].timeSeconds) <= position)
+        {
+            const auto applied = apply(events[nextEvent++]);
+
+            if (applied.failed())
+                return applied;
+        }
+
+        // stop short of the next event so it lands on its own sample
+        auto sectionEnd = juce::jmin(endSample, position + settings.blockSize);
+
+        if (nextEvent < events.size())
+            sectionEnd = juce::jmin(sectionEnd, toSamples(events[nextEvent].timeSeconds));
+
+        const int numSamples = (int) (sectionEnd - position);
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        deckSync.process(numSamples);
+        mixer.getNextAudioBlock(juce::AudioSourceChannelInfo(&buffer, 0, numSamples));
+
+        stats.renderSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+        if (! writer.writeFromAudioSampleBuffer(buffer, 0, numSamples))
+            return juce::Result::fail("Couldn't write the output");
+
+        position = sectionEnd;
+        stats.numSamples = position;
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::prepareTracks(const RenderTimeline& timeline)
+{
+    const bool needsBeatGrids = timeline.needsBeatGrids();
+
+    for (const auto& file : timeline.getTracks())
+    {
+        if (! file.existsAsFile())
+            return juce::Result::fail("Can't find " + file.getFullPathName());
+
+        if (settings.preDecode && trackCache.decodeAndAdd(file) == nullptr)
+            return juce::Result::fail("Couldn't decode " + file.getFullPathName());
+
+        // the app analyses in the background, here every grid is ready before the first load
+        if (needsBeatGrids)
+            beatGrids[file.getFullPathName()] = BeatAnalyser::analyseFile(formatManager, file);
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::apply(const RenderEvent& event)
+{
+    using Command = RenderEvent::Command;
+
+    if (event.command == Command::crossfader)
+    {
+        mixer.setCrossfader((float) event.value);
+        return juce::Result::ok();
+    }
+
+    if (event.command == Command::end)
+        return juce::Result::ok();
+
+    auto& player = *players[event.deckIndex];
+
+    switch (event.command)
+    {
+        case Command::load:
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+
+            if (! player.loadURLNow(juce::URL(event.file)))
+                return juce::Result::fail("Line " + juce::String(event.lineNumber) + ": couldn't load " + event.file.getFullPathName());
+
+            stats.loadSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+            const auto grid = beatGrids.find(event.file.getFullPathName());
+
+            if (grid != beatGrids.end())
+                player.setBeatGrid(grid->second);
+
+            break;
+        }
+
+        case Command::play:     player.start(); break;
+        case Command::pause:    player.pause(); break;
+        case Command::stop:     player.stop(); break;
+        case Command::seek:     player.setPosition(event.value); break;
+        case Command::gain:     player.setGain(event.value); break;
+        case Command::high:     player.setHighGain(event.value); break;
+        case Command::mid:      player.setMidGain(event.value); break;
+        case Command::low:      player.setLowGain(event.value); break;
+        case Command::tempo:    player.setSpeed(event.value); break;
+        case Command::keyLock:  player.setKeyLock(event.value > 0); break;
+        case Command::sync:     deckSync.setSyncEnabled(event.deckIndex, event.value > 0); break;
+        case Command::leader:   deckSync.setLeader(event.deckIndex); break;
+        case Command::trim:     mixer.setTrim(event.deckIndex, (float) event.value); break;
+
+        case Command::setCue:
+        case Command::cue:
+        {
+            const int index = (int) event.value - 1;
+
+            if (! juce::isPositiveAndBelow(index, DJAudioPlayer::numHotCues))
+                return juce::Result::fail("Line " + juce::String(event.lineNumber) + ": hot cues go from 1 to "
+                                          + juce::String(DJAudioPlayer::numHotCues));
+
+            if (event.command == Command::setCue)
+                player.setHotCue(index);
+            else if (! player.jumpToHotCue(index))
+                return juce::Result::fail("Line " + juce::String(event.lineNumber) + ": hot cue " + juce::String(index + 1) + " isn't set");
+
+            break;
+        }
+
+        case Command::loop:
+            if (event.value <= 0)
+                player.exitLoop();
+            else if (! player.setBeatLoop(event.value))
+                return juce::Result::fail("Line " + juce::String(event.lineNumber) + ": couldn't loop " + juce::String(event.value) + " beats here");
+
+            break;
+
+        case Command::crossfader:
+        case Command::end:
+        default:
+            break;
+    }
+
+    return juce::Result::ok();
+}
@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 17 Oct 2026 11:31:45pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+#include "../../../Source/BeatAnalyser.h"
+#include "../../../Source/DJAudioPlayer.h"
+#include "../../../Source/DeckMixer.h"
+#include "../../../Source/DeckRenderGroup.h"
+#include "../../../Source/DeckSync.h"
+#include "../../../Source/ReadAheadThreadPool.h"
+#include "../../../Source/TrackCache.h"
+#include "../../../Source/TrackLoader.h"
+#include "RenderTimeline.h"
+
+//==============================================================================
+/*
+    Runs the app's decks, sync and mixer without an audio device, as fast as
+    the CPU allows, and writes the master bus to a file.
+
+    The timeline is played by calling the same DJAudioPlayer, DeckSync and
+    DeckMixer methods the GUI does, from this thread in place of the message
+    thread. Each event lands on the first sample at or after its time, with
+    the block split there, so the output doesn't depend on when the events
+    fall relative to the block size.
+
+    Tracks are decoded into memory before the render starts and loaded from
+    there, so a render never waits on the disk and the same timeline always
+    gives the same output. Streaming them instead goes through the read-ahead
+    buffers like the app does, but faster than realtime those can run dry.
+*/
+class OfflineRenderer
+{
+public:
+    struct Settings
+    {
+        double sampleRate = 44100.0;
+        int blockSize = 512;
+        int numWorkers = 0;         // deck render threads, none renders the decks one after another
+        bool preDecode = true;
+    };
+
+    struct Stats
+    {
+        juce::int64 numSamples = 0;
+        double renderSeconds = 0.0;     // time spent in the DSP chain, not counting loads or writing the file
+        double loadSeconds = 0.0;
+
+        double getSamplesPerSecond() const;
+        double getRealtimeFactor(double sampleRate) const;
+    };
+
+    explicit OfflineRenderer(const Settings& settings);
+    ~OfflineRenderer();
+
+    /** renders the whole timeline into a stereo writer at the settings' sample rate */
+    juce::Result render(const RenderTimeline& timeline, juce::AudioFormatWriter& writer);
+
+    const Stats& getStats() const;
+    juce::AudioFormatManager& getFormatManager();
+
+private:
+    juce::Result prepareTracks(const RenderTimeline& timeline);
+    juce::Result apply(const RenderEvent& event);
+    juce::int64 toSamples(double seconds) const;
+
+    Settings settings;
+    Stats stats;
+
+    juce::AudioFormatManager formatManager;
+    ReadAheadThreadPool readAheadPool;
+    TrackCache trackCache{ formatManager, (size_t) 4 * 1024 * 1024 * 1024 };
+    TrackLoader trackLoader{ formatManager, readAheadPool, &trackCache, 1 };
+    std::map<juce::String, BeatGrid> beatGrids;
+
+    juce::OwnedArray<DJAudioPlayer> players;
+    DeckSync deckSync;
+    DeckRenderGroup renderGroup;
+    DeckMixer mixer{ &renderGroup };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
@@ -0,0 +1,210 @@
+/*
+  ==============================================================================
+
+    RenderTimeline.cpp
+    Created: 17 Oct 2026 11:24:10pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#include "RenderTimeline.h"
+#include <algorithm>
+
+namespace
+{
+    struct CommandInfo
+    {
+        const char* name;
+        RenderEvent::Command command;
+        bool isDeckCommand;
+        enum { none, number, onOff, path } argument;
+    };
+
+    const CommandInfo commands[] =
+    {
+        { "load",       RenderEvent::Command::load,       true,  CommandInfo::path },
+        { "play",       RenderEvent::Command::play,       true,  CommandInfo::none },
+        { "pause",      RenderEvent::Command::pause,      true,  CommandInfo::none },
+        { "stop",       RenderEvent::Command::stop,       true,  CommandInfo::none },
+        { "seek",       RenderEvent::Command::seek,       true,  CommandInfo::number },
+        { "gain",       RenderEvent::Command::gain,       true,  CommandInfo::number },
+        { "high",       RenderEvent::Command::high,       true,  CommandInfo::number },
+        { "mid",        RenderEvent::Command::mid,        true,  CommandInfo::number },
+        { "low",        RenderEvent::Command::low,        true,  CommandInfo::number },
+        { "tempo",      RenderEvent::Command::tempo,      true,  CommandInfo::number },
+        { "keylock",    RenderEvent::Command::keyLock,    true,  CommandInfo::onOff },
+        { "sync",       RenderEvent::Command::sync,       true,  CommandInfo::onOff },
+        { "leader",     RenderEvent::Command::leader,     true,  CommandInfo::none },
+        { "trim",       RenderEvent::Command::trim,       true,  CommandInfo::number },
+        { "setcue",     RenderEvent::Command::setCue,     true,  CommandInfo::number },
+        { "cue",        RenderEvent::Command::cue,        true,  CommandInfo::number },
+        { "loop",       RenderEvent::Command::loop,       true,  CommandInfo::number },
+        { "crossfader", RenderEvent::Command::crossfader, false, CommandInfo::number },
+        { "end",        RenderEvent::Command::end,        false, CommandInfo::none }
+    };
+
+    bool isNumber(const juce::String& text)
+    {
+        return text.isNotEmpty() && text.containsOnly("0123456789.-+eE");
+    }
+}
+
+juce::Result RenderTimeline::loadFromFile(const juce::File& file)
+{
+    if (! file.existsAsFile())
+        return juce::Result::fail("Can't find " + file.getFullPathName());
+
+    return parse(file.loadFileAsString(), file.getParentDirectory());
+}
+
+juce::Result RenderTimeline::parse(const juce::String& text, const juce::File& baseDirectory)
+{
+    events.clear();
+
+    juce::StringArray lines;
+    lines.addLines(text);
+
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        const auto result = parseLine(lines[i].upToFirstOccurrenceOf("#", false, false).trim(), baseDirectory, i + 1);
+
+        if (result.failed())
+            return result;
+    }
+
+    // stable, so events at the same time keep the order they were written in
+    std::stable_sort(events.begin(), events.end(), [](const RenderEvent& a, const RenderEvent& b)
+    {
+        return a.timeSeconds < b.timeSeconds;
+    });
+
+    return juce::Result::ok();
+}
+
+juce::Result RenderTimeline::parseLine(const juce::String& line, const juce::File& baseDirectory, int lineNumber)
+{
+    if (line.isEmpty())
+        return juce::Result::ok();
+
+    const auto fail = [lineNumber](const juce::String& message)
+    {
+        return juce::Result::fail("Line " + juce::String(lineNumber) + ": " + message);
+    };
+
+    auto tokens = juce::StringArray::fromTokens(line, " \t", "\"");
+
+    if (tokens.size() < 3)
+        return fail("expected a time, a deck and a command");
+
+    RenderEvent event;
+    event.lineNumber = lineNumber;
+
+    if (! isNumber(tokens[0]) || tokens[0].getDoubleValue() < 0)
+        return fail("'" + tokens[0] + "' isn't a time in seconds");
+
+    event.timeSeconds = tokens[0].getDoubleValue();
+
+    const auto* info = std::find_if(std::begin(commands), std::end(commands), [&](const CommandInfo& c)
+    {
+        return tokens[2].equalsIgnoreCase(c.name);
+    });
+
+    if (info == std::end(commands))
+        return fail("unknown command '" + tokens[2] + "'");
+
+    event.command = info->command;
+
+    if (info->isDeckCommand)
+    {
+        if (tokens[1].getIntValue() < 1 || ! tokens[1].containsOnly("0123456789"))
+            return fail("'" + tokens[1] + "' isn't a deck number");
+
+        event.deckIndex = tokens[1].getIntValue() - 1;
+    }
+    else if (tokens[1] != "-")
+    {
+        return fail("'" + tokens[2] + "' is a mixer command, so the deck should be '-'");
+    }
+
+    switch (info->argument)
+    {
+        case CommandInfo::none:
+            if (tokens.size() > 3)
+                return fail("'" + tokens[2] + "' doesn't take a value");
+            break;
+
+        case CommandInfo::number:
+            if (tokens.size() != 4 || ! isNumber(tokens[3]))
+                return fail("'" + tokens[2] + "' needs a number");
+
+            event.value = tokens[3].getDoubleValue();
+            break;
+
+        case CommandInfo::onOff:
+            if (tokens.size() != 4 || ! (tokens[3] == "on" || tokens[3] == "off"))
+                return fail("'" + tokens[2] + "' needs on or off");
+
+            event.value = tokens[3] == "on" ? 1.0 : 0.0;
+            break;
+
+        case CommandInfo::path:
+        {
+            // the rest of the line as written, so paths can have spaces in them
+            const auto path = line.fromFirstOccurrenceOf(tokens[2], false, false).trim().unquoted();
+
+            if (path.isEmpty())
+                return fail("'" + tokens[2] + "' needs a file");
+
+            event.file = baseDirectory.getChildFile(path);
+            break;
+        }
+    }
+
+    events.push_back(event);
+    return juce::Result::ok();
+}
+
+const std::vector<RenderEvent>& RenderTimeline::getEvents() const
+{
+    return events;
+}
+
+double RenderTimeline::getEndSeconds() const
+{
+    for (const auto& event : events)
+        if (event.command == RenderEvent::Command::end)
+            return event.timeSeconds;
+
+    return -1.0;
+}
+
+int RenderTimeline::getNumDecks() const
+{
+    int numDecks = 0;
+
+    for (const auto& event : events)
+        numDecks = juce::jmax(numDecks, event.deckIndex + 1);
+
+    return numDecks;
+}
+
+juce::Array<juce::File> RenderTimeline::getTracks() const
+{
+    juce::Array<juce::File> tracks;
+
+    for (const auto& event : events)
+        if (event.command == RenderEvent::Command::load)
+            tracks.addIfNotAlreadyThere(event.file);
+
+    return tracks;
+}
+
+bool RenderTimeline::needsBeatGrids() const
+{
+    return std::any_of(events.begin(), events.end(), [](const RenderEvent& event)
+    {
+        return event.command == RenderEvent::Command::sync || event.command == RenderEvent::Command::leader
+            || event.command == RenderEvent::Command::setCue || event.command == RenderEvent::Command::loop;
+    });
+}
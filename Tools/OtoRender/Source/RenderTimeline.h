@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    RenderTimeline.h
+    Created: 17 Oct 2026 11:24:10pm
+    Author:  Dan
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/** One scripted change to a deck or the mixer */
+struct RenderEvent
+{
+    enum class Command
+    {
+        load,       // file
+        play,
+        pause,
+        stop,
+        seek,       // seconds into the track
+        gain,       // 0 to 1
+        high,       // EQ band gains
+        mid,
+        low,
+        tempo,      // speed ratio, 0.8 to 1.2
+        keyLock,    // on or off
+        sync,       // on or off
+        leader,
+        trim,       // linear gain into the mixer
+        setCue,     // hot cue number, set where the deck is
+        cue,        // hot cue number to jump to
+        loop,       // length in beats, 0 to leave the loop
+        crossfader, // 0 to 1
+        end
+    };
+
+    double timeSeconds = 0.0;
+    int deckIndex = -1;         // -1 for the mixer
+    Command command = Command::end;
+    double value = 0.0;         // 1 or 0 for on/off commands
+    juce::File file;
+    int lineNumber = 0;
+};
+
+//==============================================================================
+/*
+    A script of deck and mixer events for an offline render, one per line:
+
+        # time  deck  command     value
+        0       1     load        tracks/first.wav
+        0       1     play
+        8.5     1     high        0.4
+        16      2     tempo       1.04
+        30      -     crossfader  0.75
+        60      -     end
+
+    Decks are numbered from 1, and mixer commands take '-' for the deck. Track
+    paths are relative to the script and may contain spaces. Everything after
+    a '#' is a comment.
+
+    Events are kept in time order. Ones at the same time apply in the order
+    they were written, so a load can be followed straight away by a seek.
+*/
+class RenderTimeline
+{
+public:
+    /** parses a script, failing with the line number of the first line that doesn't make sense */
+    juce::Result parse(const juce::String& text, const juce::File& baseDirectory);
+    juce::Result loadFromFile(const juce::File& file);
+
+    const std::vector<RenderEvent>& getEvents() const;
+
+    /** the time of the end event, or a negative number if there isn't one */
+    double getEndSeconds() const;
+
+    /** the highest deck number any event refers to */
+    int getNumDecks() const;
+
+    /** every track the script loads, without duplicates */
+    juce::Array<juce::File> getTracks() const;
+
+    /** true if any deck is synced, made the leader, looped or given a cue snapped to the beat */
+    bool needsBeatGrids() const;
+
+private:
+    juce::Result parseLine(const juce::String& line, const juce::File& baseDirectory, int lineNumber);
+
+    std::vector<RenderEvent> events;
+};